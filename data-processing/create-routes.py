@@ -98,53 +98,58 @@ for y in years:
         popular_location_lon = -93.10204982757568
       
       # To handle the fact that some routes won't work with a given profile
-      # we go through different transports
+      # the router goes through the different transports in order itself
+      # and reports the one that worked.
       transported = False;
-      for transport in transport_priority:
-        if transported == True:
-          break
-        
-        # Create that special command, check for circle path
-        if v['start'] == v['end']:
-          pp('[Circle route]    ')
-          route_this = command_circle % { 'path': r_path, 'c_path': conf_path, 'lat1': v['start_lat'], 'lon1': v['start_lon'], 'lat2': popular_location_lat, 'lon2': popular_location_lon, 'lat3': v['end_lat'], 'lon3': v['end_lon'], 'transport': transport, 'type': route_type }
-        else:
-          route_this = command % { 'path': r_path, 'c_path': conf_path, 'lat1': v['start_lat'], 'lon1': v['start_lon'], 'lat2': v['end_lat'], 'lon2': v['end_lon'], 'transport': transport, 'type': route_type }
-          
-        out = commands.getstatusoutput(route_this)
+      transport = ','.join(transport_priority)
+      
+      # Create that special command, check for circle path
+      if v['start'] == v['end']:
+        pp('[Circle route]    ')
+        route_this = command_circle % { 'path': r_path, 'c_path': conf_path, 'lat1': v['start_lat'], 'lon1': v['start_lon'], 'lat2': popular_location_lat, 'lon2': popular_location_lon, 'lat3': v['end_lat'], 'lon3': v['end_lon'], 'transport': transport, 'type': route_type }
+      else:
+        route_this = command % { 'path': r_path, 'c_path': conf_path, 'lat1': v['start_lat'], 'lon1': v['start_lon'], 'lat2': v['end_lat'], 'lon2': v['end_lon'], 'transport': transport, 'type': route_type }
         
-        # Check if route was alright, if not mark and try new one.
-        if ('Routed OK' in out[1] and check_route_output == True) or check_route_output == False:
-          pp('[Route found]    ')
-          # Read data from pgx file
-          gpx_dom = parse(out_gpx)
-          points = gpx_dom.getElementsByTagName('trkpt')
-          line_points = []
-          for p in points:
-            if p.hasAttribute('lat') and p.hasAttribute('lon'):
-              line_points.append(ppygis.Point(float(p.getAttribute('lon')), float(p.getAttribute('lat')), srid=srid))
-            else:
-              pp('[missing lat/lon] ')
+      out = commands.getstatusoutput(route_this)
       
-          if len(line_points) == 0:
-            pp('[no points]    ')
-            routes_not_committed += 1
+      # Note which transport was used (the router prints the profile that
+      # found a route).
+      for line in out[1].splitlines():
+        if line.startswith('Routed OK using profile '):
+          transport = line.split("'")[1]
+        elif line.startswith('Cannot route using profile '):
+          pp('[no route: %s] ' % line.split("'")[1])
+      
+      # Check if route was alright.
+      if ('Routed OK' in out[1] and check_route_output == True) or check_route_output == False:
+        pp('[Route found]    ')
+        # Read data from pgx file
+        gpx_dom = parse(out_gpx)
+        points = gpx_dom.getElementsByTagName('trkpt')
+        line_points = []
+        for p in points:
+          if p.hasAttribute('lat') and p.hasAttribute('lon'):
+            line_points.append(ppygis.Point(float(p.getAttribute('lon')), float(p.getAttribute('lat')), srid=srid))
           else:
-            route = ppygis.LineString(line_points, srid=srid)
-            # Put into DB
-            db.execute("INSERT INTO routes_" + y + " (terminal_id_start, terminal_id_end, start_geom, end_geom, route_geom) VALUES (%s, %s, %s, %s, %s)",
-              (v['start'], v['end'], ppygis.Point(float(v['start_lon']), float(v['start_lat']), srid=srid), ppygis.Point(float(v['end_lon']), float(v['end_lat']), srid=srid), route))
-            committed = conn.commit()
-            if committed == None:
-              pp('[route committed for %s] ' % transport)
-              routes_committed += 1
-              transported = True
-            else:
-              pp('[route not committed] ')
-              routes_not_committed += 1
+            pp('[missing lat/lon] ')
+    
+        if len(line_points) == 0:
+          pp('[no points]    ')
+          routes_not_committed += 1
         else:
-          pp('[no route: %s] ' % transport)
-          
+          route = ppygis.LineString(line_points, srid=srid)
+          # Put into DB
+          db.execute("INSERT INTO routes_" + y + " (terminal_id_start, terminal_id_end, start_geom, end_geom, route_geom) VALUES (%s, %s, %s, %s, %s)",
+            (v['start'], v['end'], ppygis.Point(float(v['start_lon']), float(v['start_lat']), srid=srid), ppygis.Point(float(v['end_lon']), float(v['end_lat']), srid=srid), route))
+          committed = conn.commit()
+          if committed == None:
+            pp('[route committed for %s] ' % transport)
+            routes_committed += 1
+            transported = True
+          else:
+            pp('[route not committed] ')
+            routes_not_committed += 1
+        
       # Did we find a valid transport
       if transported == False:
         pp('[NOT TRANSPORTED] \n')
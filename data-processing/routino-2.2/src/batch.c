@@ -0,0 +1,812 @@
+/***************************************
+ Routes between the points in each row of a batch file (all written to a single output).
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "types.h"
+#include "nodes.h"
+#include "segments.h"
+#include "ways.h"
+#include "relations.h"
+#include "routecache.h"
+#include "flows.h"
+
+#include "functions.h"
+#include "fakes.h"
+#include "profiles.h"
+#include "router.h"
+#include "batch.h"
+#include "jobs.h"
+
+
+/* Global variables */
+
+/*+ The option to calculate the quickest route insted of the shortest. +*/
+extern int option_quickest;
+
+/*+ The option to print the batch routes as rows for the PostgreSQL COPY command. +*/
+extern int option_pgcopy;
+
+/*+ The option to print the batch routes as binary records for a route store. +*/
+extern int option_store;
+
+/*+ The option to add the weight of the batch routes to the segment volumes instead of printing them. +*/
+extern int option_flow;
+
+/*+ The cache of routes that have been calculated before (or NULL). +*/
+extern RouteCache *routecache;
+
+
+/* Local types */
+
+/*+ A row from a batch file. +*/
+typedef struct _BatchRow
+{
+ char    *id;                           /*+ The identifier of the row (followed by the other identifiers). +*/
+ const char *end_id;                    /*+ The end identifier of the row for the PostgreSQL COPY command (or NULL). +*/
+ char    *error;                        /*+ The error message if the row is invalid (or NULL). +*/
+
+ int      npoints;                      /*+ The number of points (2 or 3 if there is a via point or 0 if invalid). +*/
+ double   point_lat[3];                 /*+ The latitude of each point (in route order). +*/
+ double   point_lon[3];                 /*+ The longitude of each point (in route order). +*/
+ const char *point_id[3];               /*+ The identifier of each point in the snapped points file (or NULL). +*/
+
+ double   weight;                       /*+ The weight of the row for the segment volumes (or 1 if not used). +*/
+
+ index_t  finish_node;                  /*+ The node closest to the finish point. +*/
+}
+ BatchRow;
+
+/*+ A set of rows from a batch file that are routed together and the output that they create. +*/
+typedef struct _BatchJob
+{
+ BatchRow *rows;                        /*+ The rows to route. +*/
+ int       nrows;                       /*+ The number of rows. +*/
+
+ char     *text;                        /*+ The output from routing the rows. +*/
+ size_t    length;                      /*+ The length of the output. +*/
+}
+ BatchJob;
+
+
+/* Local functions */
+
+static int BatchParseRow(BatchRow *row,char *line);
+static int BatchSameStart(BatchRow *row1,BatchRow *row2);
+static void BatchFreeRows(BatchRow *rows,int nrows);
+
+static void BatchRouteRows(FILE *output,BatchRow *rows,int nrows,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes);
+static void BatchRouteRow(FILE *output,BatchRow *row,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes);
+static void BatchRouteGroup(FILE *output,BatchRow *rows,int nrows,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes);
+static index_t BatchSnapGroup(BatchRow *rows,int nrows,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes);
+static index_t BatchSnapPoint(BatchRow *row,int point,int waypoint,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes);
+static void BatchPrintRoute(FILE *output,BatchRow *row,Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile);
+static void BatchPrintError(FILE *output,BatchRow *row,const char *error);
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+static void BatchJobFunction(JobPool *pool,int job,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations);
+#endif
+
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Route each of the rows in a batch file and write all of the results to a single output.
+
+  Each row of the file contains an identifier followed by the latitude and longitude of the
+  start and finish points and optionally the latitude and longitude of a point to pass
+  through on the way (separated by spaces, tabs or commas). Instead of the coordinates the
+  row can contain the identifiers of the points in the snapped points file. If the routes
+  are printed for the PostgreSQL COPY command then each row starts with a start and an end
+  identifier instead of a single identifier. Empty rows and
+  those starting with '#' are ignored. For each row a status line ("Routed OK" or an error message) and
+  one line of latitude and longitude for each point of the route are written, every line
+  starts with the identifier of the row.
+
+  Consecutive rows without a via point that share the same start point are routed together
+  with a single one-to-many search. If more than one thread is used then the whole file is
+  read first and the output is written in the same order as the rows.
+
+  int BatchQueries Returns 0 if the file was processed or 1 if it could not be opened.
+
+  const char *filename The name of the batch file ("-" for stdin).
+
+  FILE *output The file to write the results to.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  double heading The starting heading (or -999 if none).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+
+  int nthreads The number of threads to use.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int BatchQueries(const char *filename,FILE *output,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes,int nthreads)
+{
+ FILE     *input;
+ char     *line=NULL;
+ size_t    length=0;
+ BatchRow *rows;
+ int       nrows=0;
+#if defined(USE_PTHREADS) && USE_PTHREADS
+ BatchJob *jobs=NULL;
+ int       njobs=0;
+#endif
+
+ if(!strcmp(filename,"-"))
+    input=stdin;
+ else if(!(input=fopen(filename,"r")))
+   {
+    fprintf(stderr,"Error: Cannot open batch file '%s' for reading [%s].\n",filename,strerror(errno));
+    return(1);
+   }
+
+ rows=(BatchRow*)malloc((NWAYPOINTS-1)*sizeof(BatchRow));
+
+ while(1)
+   {
+    BatchRow row;
+    int      eof;
+
+    eof=(getline(&line,&length,input)==-1);
+
+    if(!eof && !BatchParseRow(&row,line))
+       continue;
+
+    /* Route the saved rows (or save them for later) if this row cannot be added to them */
+
+    if(nrows>0 && (eof || row.npoints!=2 || rows[0].npoints!=2 || nrows==NWAYPOINTS-1 || !BatchSameStart(&row,&rows[0])))
+      {
+#if defined(USE_PTHREADS) && USE_PTHREADS
+       if(nthreads>1)
+         {
+          if((njobs%64)==0)
+             jobs=(BatchJob*)realloc((void*)jobs,(njobs+64)*sizeof(BatchJob));
+
+          jobs[njobs].rows=rows;
+          jobs[njobs].nrows=nrows;
+          jobs[njobs].text=NULL;
+          jobs[njobs].length=0;
+
+          njobs++;
+
+          rows=(BatchRow*)malloc((NWAYPOINTS-1)*sizeof(BatchRow));
+          nrows=0;
+         }
+       else
+#endif
+         {
+          BatchRouteRows(output,rows,nrows,nodes,segments,ways,relations,profile,heading,exactnodes);
+
+          BatchFreeRows(rows,nrows);
+          nrows=0;
+         }
+      }
+
+    if(eof)
+       break;
+
+    rows[nrows++]=row;
+   }
+
+ free(rows);
+
+ if(line)
+    free(line);
+
+ if(input!=stdin)
+    fclose(input);
+
+ /* Route the saved rows in parallel and write out the results in order */
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ if(njobs>0)
+   {
+    JobPool pool;
+    int     job;
+
+    pool.nodes=nodes;
+    pool.segments=segments;
+    pool.ways=ways;
+    pool.relations=relations;
+    pool.profile=profile;
+    pool.heading=heading;
+    pool.exactnodes=exactnodes;
+
+    pool.function=BatchJobFunction;
+    pool.data=jobs;
+    pool.njobs=njobs;
+    pool.nthreads=nthreads;
+
+    StartJobs(&pool);
+
+    for(job=0;job<njobs;job++)
+      {
+       WaitForJob(&pool,job);
+
+       fwrite(jobs[job].text,1,jobs[job].length,output);
+       fflush(output);
+
+       free(jobs[job].text);
+
+       BatchFreeRows(jobs[job].rows,jobs[job].nrows);
+
+       free(jobs[job].rows);
+      }
+
+    FinishJobs(&pool);
+
+    free(jobs);
+   }
+
+#endif
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Parse one row of a batch file (the points are stored in route order with the via point
+  between the start and finish points).
+
+  int BatchParseRow Returns 1 if the row was parsed (even if it is invalid) or 0 if it is empty or a comment.
+
+  BatchRow *row Returns the parsed row.
+
+  char *line The text of the row (modified while parsing).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int BatchParseRow(BatchRow *row,char *line)
+{
+ char  *id,*end_id=NULL,*args[8],*ids;
+ char   error[128];
+ size_t size;
+ int    nargs=0,arg,point;
+
+ id=strtok(line," \t,\r\n");
+
+ if(!id || *id=='#')
+    return(0);
+
+ if(option_pgcopy)
+    end_id=strtok(NULL," \t,\r\n");
+
+ while(nargs<8 && (args[nargs]=strtok(NULL," \t,\r\n")))
+    nargs++;
+
+ row->end_id=NULL;
+ row->error=NULL;
+ row->npoints=0;
+ row->weight=1;
+ row->finish_node=NO_NODE;
+
+ for(point=0;point<3;point++)
+   {
+    row->point_lat[point]=0;
+    row->point_lon[point]=0;
+    row->point_id[point]=NULL;
+   }
+
+ /* The weight follows the points for the segment volumes */
+
+ if(option_flow && nargs>0)
+    row->weight=atof(args[--nargs]);
+
+ /* The end identifier and the snapped point identifiers are kept after the row identifier */
+
+ size=strlen(id)+1;
+
+ if(end_id)
+    size+=strlen(end_id)+1;
+
+ if(nargs==2 || nargs==3)
+    for(arg=0;arg<nargs;arg++)
+       size+=strlen(args[arg])+1;
+
+ row->id=strcpy((char*)malloc(size),id);
+
+ ids=row->id+strlen(id)+1;
+
+ if(end_id)
+   {
+    row->end_id=strcpy(ids,end_id);
+
+    ids+=strlen(end_id)+1;
+   }
+
+ if(nargs==4 || nargs==6)
+   {
+    row->npoints=nargs/2;
+
+    for(arg=0;arg<row->npoints;arg++)
+      {
+       point=(arg==0 || row->npoints==2)?arg:3-arg;
+
+       row->point_lat[point]=degrees_to_radians(atof(args[2*arg]));
+       row->point_lon[point]=degrees_to_radians(atof(args[2*arg+1]));
+      }
+   }
+ else if(nargs==2 || nargs==3)
+   {
+    for(arg=0;arg<nargs;arg++)
+      {
+       point=(arg==0 || nargs==2)?arg:3-arg;
+
+       if(!FindSnappedPoint(args[arg]))
+         {
+          sprintf(error,"Cannot find snapped point '%.64s' for point %d.",args[arg],point+1);
+          break;
+         }
+
+       row->point_id[point]=strcpy(ids,args[arg]);
+
+       ids+=strlen(args[arg])+1;
+      }
+
+    if(arg==nargs)
+       row->npoints=nargs;
+   }
+ else if(option_flow)
+    strcpy(error,"Batch rows must contain an identifier, 4 or 6 coordinates or 2 or 3 snapped point identifiers and a weight.");
+ else if(option_pgcopy)
+    strcpy(error,"Batch rows must contain a start and an end identifier and 4 or 6 coordinates or 2 or 3 snapped point identifiers.");
+ else
+    strcpy(error,"Batch rows must contain an identifier and 4 or 6 coordinates or 2 or 3 snapped point identifiers.");
+
+ if(row->npoints==0)
+    row->error=strcpy((char*)malloc(strlen(error)+1),error);
+
+ return(1);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Check if two rows of a batch file have the same start point.
+
+  int BatchSameStart Returns 1 if the start points are the same.
+
+  BatchRow *row1 The first row.
+
+  BatchRow *row2 The second row.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int BatchSameStart(BatchRow *row1,BatchRow *row2)
+{
+ if(row1->point_id[0] || row2->point_id[0])
+    return(row1->point_id[0] && row2->point_id[0] && !strcmp(row1->point_id[0],row2->point_id[0]));
+ else
+    return(row1->point_lat[0]==row2->point_lat[0] && row1->point_lon[0]==row2->point_lon[0]);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Free the memory used by a set of rows of a batch file.
+
+  BatchRow *rows The rows to free.
+
+  int nrows The number of rows.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void BatchFreeRows(BatchRow *rows,int nrows)
+{
+ int row;
+
+ for(row=0;row<nrows;row++)
+   {
+    free(rows[row].id);
+
+    if(rows[row].error)
+       free(rows[row].error);
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Route a set of rows of a batch file that were saved together (an invalid row, a row with
+  a via point or a group of rows with the same start point) and write the results.
+
+  FILE *output The file to write the results to.
+
+  BatchRow *rows The rows to route.
+
+  int nrows The number of rows.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  double heading The starting heading (or -999 if none).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void BatchRouteRows(FILE *output,BatchRow *rows,int nrows,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes)
+{
+ if(rows[0].npoints==0)
+    BatchPrintError(output,&rows[0],rows[0].error);
+ else if(rows[0].npoints==3)
+    BatchRouteRow(output,&rows[0],nodes,segments,ways,relations,profile,heading,exactnodes);
+ else if(ChooseContraction(profile))
+   {
+    int row;
+
+    /* A contraction hierarchy is faster for each row than a one-to-many search */
+
+    for(row=0;row<nrows;row++)
+       BatchRouteRow(output,&rows[row],nodes,segments,ways,relations,profile,heading,exactnodes);
+   }
+ else
+    BatchRouteGroup(output,rows,nrows,nodes,segments,ways,relations,profile,heading,exactnodes);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Route a single row of a batch file on its own and write the result.
+
+  FILE *output The file to write the results to.
+
+  BatchRow *row The row to route.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  double heading The starting heading (or -999 if none).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void BatchRouteRow(FILE *output,BatchRow *row,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes)
+{
+ Query query;
+ int   point;
+
+ InitQuery(&query);
+
+ query.heading=heading;
+
+ for(point=1;point<=row->npoints;point++)
+   {
+    query.point_lat[point]=row->point_lat[point-1];
+    query.point_lon[point]=row->point_lon[point-1];
+    query.point_id[point]=row->point_id[point-1];
+    query.point_used[point]=3;
+   }
+
+ if(RouteWaypoints(nodes,segments,ways,relations,profile,&query,exactnodes))
+    BatchPrintError(output,row,query.error);
+ else
+    BatchPrintRoute(output,row,query.results,NWAYPOINTS,nodes,segments,ways,profile);
+
+ FreeQueryResults(&query);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Route a group of rows of a batch file that have the same start point using a single
+  one-to-many search and write the results.
+
+  FILE *output The file to write the results to.
+
+  BatchRow *rows The rows to route.
+
+  int nrows The number of rows.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  double heading The starting heading (or -999 if none).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void BatchRouteGroup(FILE *output,BatchRow *rows,int nrows,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes)
+{
+ index_t  finish_nodes[NWAYPOINTS-1];
+ Results **routes=NULL;
+ Results *cached[NWAYPOINTS-1];
+ RouteCacheKey keys[NWAYPOINTS-1];
+ char     cacheable[NWAYPOINTS-1];
+ index_t  start_node,prev_segment=NO_SEGMENT;
+ uint32_t checksum=routecache?ProfileChecksum(profile):0;
+ int      row,nsearch=0;
+
+ start_node=BatchSnapGroup(rows,nrows,nodes,segments,ways,profile,exactnodes);
+
+ if(start_node!=NO_NODE)
+   {
+    if(heading!=-999)
+       prev_segment=FindClosestSegmentHeading(nodes,segments,ways,start_node,heading,profile);
+
+    for(row=0;row<nrows;row++)
+      {
+       finish_nodes[row]=rows[row].finish_node;
+
+       /* Waypoints within the same segment are only joined directly when routed as a pair */
+
+       if(IsFakeSameSegment(start_node,finish_nodes[row]))
+          finish_nodes[row]=NO_NODE;
+
+       /* Waypoints that cannot be reached are not searched for */
+
+       else if(finish_nodes[row]!=NO_NODE && !WaypointsConnected(nodes,profile,start_node,finish_nodes[row]))
+          finish_nodes[row]=NO_NODE;
+
+       /* Waypoints with a route in the cache are not searched for */
+
+       cacheable[row]=0;
+       cached[row]=NULL;
+
+       if(routecache && finish_nodes[row]!=NO_NODE && finish_nodes[row]!=start_node)
+          cacheable[row]=!MakeRouteCacheKey(&keys[row],checksum,option_quickest,start_node,finish_nodes[row],1,prev_segment);
+
+       if(cacheable[row])
+          cached[row]=FindCachedRoute(routecache,&keys[row],1,row+2);
+
+       if(cached[row])
+          finish_nodes[row]=NO_NODE;
+
+       if(finish_nodes[row]!=NO_NODE)
+          nsearch++;
+      }
+
+    if(nsearch)
+       routes=FindOneToManyRoutes(nodes,segments,ways,relations,profile,start_node,prev_segment,finish_nodes,nrows);
+    else
+       routes=(Results**)calloc(NWAYPOINTS-1,sizeof(Results*));
+
+    for(row=0;row<nrows;row++)
+       if(cached[row])
+          routes[row]=cached[row];
+       else if(cacheable[row] && routes[row])
+          AddCachedRoute(routecache,&keys[row],routes[row],1,row+2);
+   }
+
+ for(row=0;row<nrows;row++)
+   {
+    if(start_node==NO_NODE)
+       BatchPrintError(output,&rows[row],"Cannot find node close to specified point 1.");
+    else if(rows[row].finish_node==NO_NODE)
+       BatchPrintError(output,&rows[row],"Cannot find node close to specified point 2.");
+    else if(rows[row].finish_node==start_node)
+       BatchPrintRoute(output,&rows[row],NULL,0,nodes,segments,ways,profile);
+    else if(!WaypointsConnected(nodes,profile,start_node,rows[row].finish_node))
+       BatchPrintError(output,&rows[row],"Cannot find route compatible with profile (the points are not connected).");
+    else if(routes[row])
+      {
+       Results *results[2]={NULL,routes[row]};
+
+       BatchPrintRoute(output,&rows[row],results,1,nodes,segments,ways,profile);
+      }
+    else
+      {
+       /* Route the row on its own (this replaces the fake nodes for the group) */
+
+       BatchRouteRow(output,&rows[row],nodes,segments,ways,relations,profile,heading,exactnodes);
+
+       BatchSnapGroup(rows,nrows,nodes,segments,ways,profile,exactnodes);
+      }
+
+    if(routes && routes[row])
+       FreeResultsList(routes[row]);
+   }
+
+ if(routes)
+    free(routes);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the nodes closest to the start point and finish points of a group of batch rows
+  (the start point is waypoint 1 and the finish points are the following waypoints).
+
+  index_t BatchSnapGroup Returns the start node or NO_NODE if there is nothing close enough.
+
+  BatchRow *rows The rows to find the finish nodes for.
+
+  int nrows The number of rows.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t BatchSnapGroup(BatchRow *rows,int nrows,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes)
+{
+ index_t start_node;
+ int     row;
+
+ ResetFakes();
+
+ start_node=BatchSnapPoint(&rows[0],0,1,nodes,segments,ways,profile,exactnodes);
+
+ if(start_node!=NO_NODE)
+    for(row=0;row<nrows;row++)
+       rows[row].finish_node=BatchSnapPoint(&rows[row],1,row+2,nodes,segments,ways,profile,exactnodes);
+
+ return(start_node);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the node closest to one point of a batch row (or use the snapped point).
+
+  index_t BatchSnapPoint Returns the node or NO_NODE if there is nothing close enough.
+
+  BatchRow *row The row containing the point.
+
+  int point The point of the row (in route order).
+
+  int waypoint The waypoint number to use for the fake nodes.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t BatchSnapPoint(BatchRow *row,int point,int waypoint,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes)
+{
+ index_t snapped;
+
+ if(row->point_id[point])
+    return(SnappedWaypoint(nodes,segments,waypoint,FindSnappedPoint(row->point_id[point]),&snapped));
+ else
+    return(SnapWaypoint(nodes,segments,ways,profile,waypoint,row->point_lat[point],row->point_lon[point],exactnodes,NULL));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print the route for a row of a batch file (either the points of the route following a line
+  containing "Routed OK", a row for the PostgreSQL COPY command or a record for a route store)
+  or add the weight of the row to the volume of the segments that the route uses.
+
+  FILE *output The file to write the results to.
+
+  BatchRow *row The row of the batch file.
+
+  Results **results The set of results to print (some may be NULL - ignore them).
+
+  int nresults The number of items in the list of results (which may be NULL).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void BatchPrintRoute(FILE *output,BatchRow *row,Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile)
+{
+ if(option_pgcopy)
+    PrintRouteCopy(output,row->id,row->end_id,results,nresults,nodes,segments,ways,profile);
+ else if(option_store)
+    PrintRouteRecord(output,row->id,results,nresults,nodes,segments,ways,profile);
+ else if(option_flow)
+    AddRouteFlow(segments,results,nresults,row->weight);
+ else
+   {
+    fprintf(output,"%s Routed OK\n",row->id);
+
+    PrintRoutePoints(output,row->id,results,nresults,nodes);
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print the error for a row of a batch file (on stderr if the output is for the PostgreSQL COPY
+  command or a route store so that it only contains the routes or if there is no output).
+
+  FILE *output The file to write the results to.
+
+  BatchRow *row The row of the batch file.
+
+  const char *error The error message.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void BatchPrintError(FILE *output,BatchRow *row,const char *error)
+{
+ if(option_pgcopy && row->end_id)
+    fprintf(stderr,"%s %s Error: %s\n",row->id,row->end_id,error);
+ else if(option_pgcopy || option_store || option_flow)
+    fprintf(stderr,"%s Error: %s\n",row->id,error);
+ else
+    fprintf(output,"%s Error: %s\n",row->id,error);
+}
+
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+/*++++++++++++++++++++++++++++++++++++++
+  Route one saved set of batch rows in a thread and keep the output in memory.
+
+  JobPool *pool The pool of jobs (the data is the list of batch jobs).
+
+  int job The job to process.
+
+  Nodes *nodes The set of nodes to use (private to this thread).
+
+  Segments *segments The set of segments to use (private to this thread).
+
+  Ways *ways The set of ways to use (private to this thread).
+
+  Relations *relations The set of relations to use (private to this thread).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void BatchJobFunction(JobPool *pool,int job,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations)
+{
+ BatchJob *batchjob=&((BatchJob*)pool->data)[job];
+ FILE *output;
+
+ output=open_memstream(&batchjob->text,&batchjob->length);
+
+ BatchRouteRows(output,batchjob->rows,batchjob->nrows,nodes,segments,ways,relations,pool->profile,pool->heading,pool->exactnodes);
+
+ fclose(output);
+}
+
+#endif
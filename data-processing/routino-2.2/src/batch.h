@@ -0,0 +1,38 @@
+/***************************************
+ Header file for the routes between the points in the rows of a batch file.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#ifndef BATCH_H
+#define BATCH_H    /*+ To stop multiple inclusions. +*/
+
+#include <stdio.h>
+
+#include "types.h"
+
+#include "profiles.h"
+
+
+/* Functions in batch.c */
+
+int BatchQueries(const char *filename,FILE *output,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes,int nthreads);
+
+
+#endif /* BATCH_H */
@@ -0,0 +1,83 @@
+/***************************************
+ Contraction hierarchy data type functions.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdlib.h>
+
+#include "types.h"
+#include "contraction.h"
+
+#include "files.h"
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in a contraction hierarchy from a file.
+
+  Contraction *LoadContraction Returns the contraction hierarchy.
+
+  const char *filename The name of the file to load.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Contraction *LoadContraction(const char *filename)
+{
+ Contraction *contraction;
+#if SLIM
+ size_t sizeoffsets;
+#endif
+
+ contraction=(Contraction*)malloc(sizeof(Contraction));
+
+#if !SLIM
+
+ contraction->data=MapFile(filename);
+
+ /* Copy the ContractionFile header structure from the loaded data */
+
+ contraction->file=*((ContractionFile*)contraction->data);
+
+ /* Set the pointers in the Contraction structure. */
+
+ contraction->upward  =(index_t*        )(contraction->data+sizeof(ContractionFile));
+ contraction->downward=(index_t*        )(contraction->data+sizeof(ContractionFile)+(contraction->file.number+1)*sizeof(index_t));
+ contraction->edges   =(ContractionEdge*)(contraction->data+sizeof(ContractionFile)+2*(contraction->file.number+1)*sizeof(index_t));
+
+#else
+
+ contraction->fd=ReOpenFile(filename);
+
+ /* Copy the ContractionFile header structure from the loaded data */
+
+ ReadFile(contraction->fd,&contraction->file,sizeof(ContractionFile));
+
+ sizeoffsets=(contraction->file.number+1)*sizeof(index_t);
+
+ contraction->upward  =(index_t*)malloc(sizeoffsets);
+ contraction->downward=(index_t*)malloc(sizeoffsets);
+
+ ReadFile(contraction->fd,contraction->upward  ,sizeoffsets);
+ ReadFile(contraction->fd,contraction->downward,sizeoffsets);
+
+ contraction->edgesoffset=sizeof(ContractionFile)+2*sizeoffsets;
+
+#endif
+
+ return(contraction);
+}
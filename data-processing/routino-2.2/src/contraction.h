@@ -0,0 +1,142 @@
+/***************************************
+ A header file for the contraction hierarchies.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#ifndef CONTRACTION_H
+#define CONTRACTION_H    /*+ To stop multiple inclusions. +*/
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "types.h"
+
+#include "files.h"
+
+
+/* Data structures */
+
+
+/*+ A structure containing a single edge of a contraction hierarchy. +*/
+typedef struct _ContractionEdge
+{
+ index_t  node;                 /*+ The other node of the edge (always the more important one). +*/
+
+ index_t  child1;               /*+ The segment (for a real segment) or the first edge that the shortcut replaces. +*/
+ index_t  child2;               /*+ NO_SEGMENT (for a real segment) or the second edge that the shortcut replaces. +*/
+
+ score_t  score;                /*+ The score to travel along the edge. +*/
+}
+ ContractionEdge;
+
+
+/*+ A structure containing the header from the file. +*/
+typedef struct _ContractionFile
+{
+ uint64_t stamp;                /*+ The stamp of the database files that the hierarchy was created from. +*/
+
+ index_t  number;               /*+ The number of nodes in total. +*/
+ index_t  nedges;               /*+ The number of edges in total (upwards edges followed by downwards edges). +*/
+ index_t  segments;             /*+ The number of segments in the database. +*/
+
+ uint32_t checksum;             /*+ The checksum of the profile that was used to create the file. +*/
+ uint32_t quickest;             /*+ Set to 1 if the scores are for the quickest route or 0 for the shortest. +*/
+}
+ ContractionFile;
+
+
+/*+ A structure containing a contraction hierarchy. +*/
+struct _Contraction
+{
+ ContractionFile file;          /*+ The header data from the file. +*/
+
+#if !SLIM
+
+ void            *data;         /*+ The memory mapped data in the file. +*/
+
+ index_t         *upward;       /*+ A pointer to the array of offsets of the first upwards edge from each node. +*/
+ index_t         *downward;     /*+ A pointer to the array of offsets of the first downwards edge to each node. +*/
+
+ ContractionEdge *edges;        /*+ A pointer to the array of edges in the file. +*/
+
+#else
+
+ int              fd;           /*+ The file descriptor for the file. +*/
+
+ index_t         *upward;       /*+ An allocated array with a copy of the upwards edge offsets. +*/
+ index_t         *downward;     /*+ An allocated array with a copy of the downwards edge offsets. +*/
+
+ off_t            edgesoffset;  /*+ The offset of the edges within the file. +*/
+
+#endif
+};
+
+
+/* Functions in contraction.c */
+
+Contraction *LoadContraction(const char *filename);
+
+
+/* Macros and inline functions */
+
+/*+ Return the index of the first edge going upwards from a node (the last is before the first one for the next node). +*/
+#define FirstUpwardEdge(xxx,yyy)     ((xxx)->upward[yyy])
+
+/*+ Return the index of the first edge coming downwards to a node (the last is before the first one for the next node). +*/
+#define FirstDownwardEdge(xxx,yyy)   ((xxx)->downward[yyy])
+
+/*+ Return true if the edge is a real segment rather than a shortcut. +*/
+#define IsSegmentEdge(xxx)           ((xxx)->child2==NO_SEGMENT)
+
+
+#if !SLIM
+
+/*+ Return a ContractionEdge pointer given a contraction hierarchy and an index. +*/
+#define LookupContractionEdge(xxx,yyy,eee)   ((void)(eee),&(xxx)->edges[yyy])
+
+#else
+
+static ContractionEdge *LookupContractionEdge(Contraction *contraction,index_t index,ContractionEdge *edge);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the information for a particular edge (the edge is read into storage provided by
+  the caller so that the same hierarchy can be used by several threads in slim mode).
+
+  ContractionEdge *LookupContractionEdge Returns a pointer to the edge information.
+
+  Contraction *contraction The contraction hierarchy to use.
+
+  index_t index The index of the edge.
+
+  ContractionEdge *edge The storage to read the edge into.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static inline ContractionEdge *LookupContractionEdge(Contraction *contraction,index_t index,ContractionEdge *edge)
+{
+ SeekReadFile(contraction->fd,edge,sizeof(ContractionEdge),contraction->edgesoffset+(off_t)index*sizeof(ContractionEdge));
+
+ return(edge);
+}
+
+#endif
+
+
+#endif /* CONTRACTION_H */
@@ -0,0 +1,645 @@
+/***************************************
+ Contraction hierarchy creation functions.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "nodes.h"
+#include "segments.h"
+#include "ways.h"
+#include "contraction.h"
+
+#include "contractx.h"
+
+#include "files.h"
+#include "logging.h"
+#include "profiles.h"
+#include "results.h"
+
+
+/* Constants */
+
+/*+ The maximum number of nodes that are settled when searching for a witness path. +*/
+#define MAX_WITNESS_SETTLED 500
+
+
+/* Local types */
+
+/*+ A directed edge in the graph that is being contracted. +*/
+typedef struct _GraphEdge
+{
+ index_t  node1;                /*+ The node that the edge starts at. +*/
+ index_t  node2;                /*+ The node that the edge finishes at. +*/
+
+ index_t  child1;               /*+ The segment (for a real segment) or the first edge that the shortcut replaces. +*/
+ index_t  child2;               /*+ NO_SEGMENT (for a real segment) or the second edge that the shortcut replaces. +*/
+
+ score_t  score;                /*+ The score to travel along the edge. +*/
+}
+ GraphEdge;
+
+/*+ The edges that start or finish at a node in the graph that is being contracted. +*/
+typedef struct _GraphNode
+{
+ index_t *out;                  /*+ The edges starting at the node. +*/
+ index_t *in;                   /*+ The edges finishing at the node. +*/
+
+ int      nout;                 /*+ The number of edges starting at the node. +*/
+ int      nin;                  /*+ The number of edges finishing at the node. +*/
+
+ int      aout;                 /*+ The allocated space for edges starting at the node. +*/
+ int      ain;                  /*+ The allocated space for edges finishing at the node. +*/
+
+ index_t  rank;                 /*+ The position of the node in the contraction order (or NO_NODE if not yet contracted). +*/
+ int      deleted;              /*+ The number of neighbouring nodes that have already been contracted. +*/
+}
+ GraphNode;
+
+/*+ The graph that is being contracted. +*/
+typedef struct _Graph
+{
+ index_t    nnodes;             /*+ The number of nodes. +*/
+ GraphNode *nodes;              /*+ The nodes. +*/
+
+ index_t    nedges;             /*+ The number of edges. +*/
+ index_t    aedges;             /*+ The allocated space for edges. +*/
+ GraphEdge *edges;              /*+ The edges (real segments followed by shortcuts). +*/
+}
+ Graph;
+
+
+/* Local functions */
+
+static void AddGraphEdge(Graph *graph,index_t node1,index_t node2,index_t child1,index_t child2,score_t score);
+static int ContractNode(Graph *graph,index_t node,int add);
+static Results *FindWitnessRoutes(Graph *graph,index_t start,index_t avoid,score_t max_score);
+static void SaveContraction(Graph *graph,uint64_t stamp,index_t nsegments,uint32_t checksum,int quickest,const char *filename);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Create a contraction hierarchy for a profile by contracting the nodes one at a time in
+  order of increasing importance and adding shortcuts that preserve the optimum routes.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile (after it has been updated by UpdateProfile()).
+
+  int quickest Set to 1 to use the score for the quickest route or 0 for the shortest.
+
+  uint64_t stamp The stamp of the database files that the nodes, segments and ways were loaded from.
+
+  const char *filename The name of the file to write.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void ContractNodes(Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int quickest,uint64_t stamp,const char *filename)
+{
+ Graph    graph;
+ Results *order;
+ Queue   *queue;
+ Result  *result;
+ index_t  i,nsegments,ncontracted=0;
+
+ /* Print the start message */
+
+ printf_first("Contracting Nodes (%s %s): Segments=0 Edges=0",profile->name,quickest?"quickest":"shortest");
+
+ /* Create the graph from the segments that the profile can use */
+
+ graph.nnodes=nodes->file.number;
+ graph.nodes=(GraphNode*)calloc(graph.nnodes>0?graph.nnodes:1,sizeof(GraphNode));
+
+ assert(graph.nodes); /* Check calloc() worked */
+
+ for(i=0;i<graph.nnodes;i++)
+    graph.nodes[i].rank=NO_NODE;
+
+ graph.nedges=0;
+ graph.aedges=0;
+ graph.edges=NULL;
+
+ for(nsegments=0;nsegments<segments->file.number;nsegments++)
+   {
+    Segment *segment=LookupSegment(segments,nsegments,1);
+    Way *way;
+    score_t segment_pref,segment_score;
+    index_t node1,node2;
+
+    if(!((nsegments+1)%10000))
+       printf_middle("Contracting Nodes (%s %s): Segments=%"Pindex_t" Edges=%"Pindex_t,profile->name,quickest?"quickest":"shortest",nsegments+1,graph.nedges);
+
+    /* must be a normal segment (and not a loop) */
+    if(!IsNormalSegment(segment) || segment->node1==segment->node2)
+       continue;
+
+    way=LookupWay(ways,segment->way,1);
+
+    /* mode of transport must be allowed on the highway */
+    if(!(way->allow&profile->allow))
+       continue;
+
+    /* must obey weight restriction (if exists) */
+    if(way->weight && way->weight<profile->weight)
+       continue;
+
+    /* must obey height/width/length restriction (if exists) */
+    if((way->height && way->height<profile->height) ||
+       (way->width  && way->width <profile->width ) ||
+       (way->length && way->length<profile->length))
+       continue;
+
+    segment_pref=WayPreference(profile,way);
+
+    /* profile preferences must allow this highway */
+    if(segment_pref==0)
+       continue;
+
+    if(quickest==0)
+       segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+    else
+       segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+    /* Add an edge in each direction that obeys the one-way restrictions and that finishes at
+       a node that the mode of transport is allowed through */
+
+    node1=segment->node1;
+    node2=segment->node2;
+
+    if(!(profile->oneway && IsOnewayTo(segment,node1)) && (LookupNode(nodes,node2,1)->allow&profile->allow))
+       AddGraphEdge(&graph,node1,node2,nsegments,NO_SEGMENT,segment_score);
+
+    if(!(profile->oneway && IsOnewayTo(segment,node2)) && (LookupNode(nodes,node1,1)->allow&profile->allow))
+       AddGraphEdge(&graph,node2,node1,nsegments,NO_SEGMENT,segment_score);
+   }
+
+ /* Put all of the nodes into a queue sorted by their initial importance */
+
+ order=NewResultsList(1024);
+
+ queue=NewQueueList();
+
+ for(i=0;i<graph.nnodes;i++)
+   {
+    result=InsertResult(order,i,NO_SEGMENT);
+
+    result->sortby=ContractNode(&graph,i,0);
+
+    InsertInQueue(queue,result);
+   }
+
+ /* Contract the least important node each time (after checking that it has not become more important) */
+
+ while((result=PopFromQueue(queue)))
+   {
+    GraphNode *graphnode=&graph.nodes[result->node];
+    Result *next=PeekAtQueue(queue);
+    score_t importance;
+    int j;
+
+    importance=ContractNode(&graph,result->node,0);
+
+    if(next && importance>next->sortby)
+      {
+       result->sortby=importance;
+
+       InsertInQueue(queue,result);
+
+       continue;
+      }
+
+    ContractNode(&graph,result->node,1);
+
+    graphnode->rank=ncontracted++;
+
+    for(j=0;j<graphnode->nout;j++)
+       graph.nodes[graph.edges[graphnode->out[j]].node2].deleted++;
+
+    for(j=0;j<graphnode->nin;j++)
+       graph.nodes[graph.edges[graphnode->in[j]].node1].deleted++;
+
+    if(!(ncontracted%1000))
+       printf_middle("Contracting Nodes (%s %s): Nodes=%"Pindex_t" Edges=%"Pindex_t,profile->name,quickest?"quickest":"shortest",ncontracted,graph.nedges);
+   }
+
+ FreeQueueList(queue);
+ FreeResultsList(order);
+
+ /* Write out the contraction hierarchy */
+
+ SaveContraction(&graph,stamp,segments->file.number,ProfileChecksum(profile),quickest,filename);
+
+ /* Print the final message */
+
+ printf_last("Contracted Nodes (%s %s): Nodes=%"Pindex_t" Edges=%"Pindex_t,profile->name,quickest?"quickest":"shortest",graph.nnodes,graph.nedges);
+
+ /* Free the memory */
+
+ for(i=0;i<graph.nnodes;i++)
+   {
+    if(graph.nodes[i].out)
+       free(graph.nodes[i].out);
+    if(graph.nodes[i].in)
+       free(graph.nodes[i].in);
+   }
+
+ free(graph.nodes);
+
+ if(graph.edges)
+    free(graph.edges);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Add an edge to the graph.
+
+  Graph *graph The graph to add the edge to.
+
+  index_t node1 The node that the edge starts at.
+
+  index_t node2 The node that the edge finishes at.
+
+  index_t child1 The segment (for a real segment) or the first edge that the shortcut replaces.
+
+  index_t child2 NO_SEGMENT (for a real segment) or the second edge that the shortcut replaces.
+
+  score_t score The score to travel along the edge.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void AddGraphEdge(Graph *graph,index_t node1,index_t node2,index_t child1,index_t child2,score_t score)
+{
+ GraphNode *graphnode1=&graph->nodes[node1];
+ GraphNode *graphnode2=&graph->nodes[node2];
+
+ if(graph->nedges==graph->aedges)
+   {
+    graph->aedges+=1024*1024;
+    graph->edges=(GraphEdge*)realloc((void*)graph->edges,graph->aedges*sizeof(GraphEdge));
+
+    assert(graph->edges); /* Check realloc() worked */
+   }
+
+ graph->edges[graph->nedges].node1=node1;
+ graph->edges[graph->nedges].node2=node2;
+ graph->edges[graph->nedges].child1=child1;
+ graph->edges[graph->nedges].child2=child2;
+ graph->edges[graph->nedges].score=score;
+
+ if(graphnode1->nout==graphnode1->aout)
+   {
+    graphnode1->aout+=4;
+    graphnode1->out=(index_t*)realloc((void*)graphnode1->out,graphnode1->aout*sizeof(index_t));
+   }
+
+ graphnode1->out[graphnode1->nout++]=graph->nedges;
+
+ if(graphnode2->nin==graphnode2->ain)
+   {
+    graphnode2->ain+=4;
+    graphnode2->in=(index_t*)realloc((void*)graphnode2->in,graphnode2->ain*sizeof(index_t));
+   }
+
+ graphnode2->in[graphnode2->nin++]=graph->nedges;
+
+ graph->nedges++;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Contract a node (or just calculate its importance) by finding the shortcuts that are needed
+  between each pair of its neighbours that have not been contracted yet.
+
+  int ContractNode Returns the importance of the node (the number of shortcuts minus the number of
+  edges removed plus the number of neighbours already contracted).
+
+  Graph *graph The graph to use.
+
+  index_t node The node to contract.
+
+  int add Set to 1 to add the shortcuts to the graph or 0 to only count them.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int ContractNode(Graph *graph,index_t node,int add)
+{
+ GraphNode *graphnode=&graph->nodes[node];
+ index_t *in,*out;
+ int nin=0,nout=0,nshortcuts=0;
+ int i,j;
+
+ in =(index_t*)malloc((graphnode->nin +1)*sizeof(index_t));
+ out=(index_t*)malloc((graphnode->nout+1)*sizeof(index_t));
+
+ /* Find the best edge to the node from each neighbour that is not contracted */
+
+ for(i=0;i<graphnode->nin;i++)
+   {
+    GraphEdge *edge=&graph->edges[graphnode->in[i]];
+
+    if(graph->nodes[edge->node1].rank!=NO_NODE)
+       continue;
+
+    for(j=0;j<nin;j++)
+       if(graph->edges[in[j]].node1==edge->node1)
+          break;
+
+    if(j==nin)
+       in[nin++]=graphnode->in[i];
+    else if(edge->score<graph->edges[in[j]].score)
+       in[j]=graphnode->in[i];
+   }
+
+ /* Find the best edge from the node to each neighbour that is not contracted */
+
+ for(i=0;i<graphnode->nout;i++)
+   {
+    GraphEdge *edge=&graph->edges[graphnode->out[i]];
+
+    if(graph->nodes[edge->node2].rank!=NO_NODE)
+       continue;
+
+    for(j=0;j<nout;j++)
+       if(graph->edges[out[j]].node2==edge->node2)
+          break;
+
+    if(j==nout)
+       out[nout++]=graphnode->out[i];
+    else if(edge->score<graph->edges[out[j]].score)
+       out[j]=graphnode->out[i];
+   }
+
+ /* A shortcut is needed for each pair of edges unless there is another route that is no worse */
+
+ for(i=0;i<nin;i++)
+   {
+    index_t node1=graph->edges[in[i]].node1;
+    score_t score1=graph->edges[in[i]].score;
+    score_t max_score=0;
+    Results *results;
+
+    for(j=0;j<nout;j++)
+       if(graph->edges[out[j]].score>max_score)
+          max_score=graph->edges[out[j]].score;
+
+    results=FindWitnessRoutes(graph,node1,node,score1+max_score);
+
+    for(j=0;j<nout;j++)
+      {
+       index_t node2=graph->edges[out[j]].node2;
+       score_t score=score1+graph->edges[out[j]].score;
+       Result *result;
+
+       if(node2==node1)
+          continue;
+
+       result=FindResult1(results,node2);
+
+       if(result && result->score<=score)
+          continue;
+
+       nshortcuts++;
+
+       if(add)
+          AddGraphEdge(graph,node1,node2,in[i],out[j],score);
+      }
+
+    FreeResultsList(results);
+   }
+
+ free(in);
+ free(out);
+
+ return(nshortcuts-nin-nout+graphnode->deleted);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Search from a node through the nodes that have not been contracted yet to find out if there
+  are routes to the neighbouring nodes that do not pass through the node being contracted.
+
+  Results *FindWitnessRoutes Returns the results of the search (the scores are upper limits for
+  nodes that were not reached within the limits of the search).
+
+  Graph *graph The graph to use.
+
+  index_t start The node to start searching from.
+
+  index_t avoid The node that is being contracted (that must not be passed through).
+
+  score_t max_score The maximum score of any route that is of interest.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Results *FindWitnessRoutes(Graph *graph,index_t start,index_t avoid,score_t max_score)
+{
+ Results *results;
+ Queue   *queue;
+ Result  *result1,*result2;
+ int      nsettled=0;
+
+ results=NewResultsList(8);
+
+ result1=InsertResult(results,start,NO_SEGMENT);
+
+ queue=NewQueueList();
+
+ InsertInQueue(queue,result1);
+
+ while((result1=PopFromQueue(queue)))
+   {
+    GraphNode *graphnode=&graph->nodes[result1->node];
+    int i;
+
+    if(result1->score>max_score || ++nsettled>MAX_WITNESS_SETTLED)
+       break;
+
+    for(i=0;i<graphnode->nout;i++)
+      {
+       GraphEdge *edge=&graph->edges[graphnode->out[i]];
+       score_t cumulative_score;
+
+       if(edge->node2==avoid || graph->nodes[edge->node2].rank!=NO_NODE)
+          continue;
+
+       cumulative_score=result1->score+edge->score;
+
+       result2=FindResult1(results,edge->node2);
+
+       if(!result2)
+         {
+          result2=InsertResult(results,edge->node2,NO_SEGMENT);
+          result2->score=cumulative_score;
+          result2->sortby=cumulative_score;
+
+          InsertInQueue(queue,result2);
+         }
+       else if(cumulative_score<result2->score)
+         {
+          result2->score=cumulative_score;
+          result2->sortby=cumulative_score;
+
+          InsertInQueue(queue,result2);
+         }
+      }
+   }
+
+ FreeQueueList(queue);
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Save the contraction hierarchy to a file (edges that go upwards from each node followed by
+  edges that come downwards to each node, the node that is stored is the more important one).
+
+  Graph *graph The contracted graph to save.
+
+  uint64_t stamp The stamp of the database files.
+
+  index_t nsegments The number of segments in the database.
+
+  uint32_t checksum The checksum of the profile.
+
+  int quickest Set to 1 if the scores are for the quickest route or 0 for the shortest.
+
+  const char *filename The name of the file to save.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void SaveContraction(Graph *graph,uint64_t stamp,index_t nsegments,uint32_t checksum,int quickest,const char *filename)
+{
+ ContractionFile contractionfile={0};
+ ContractionEdge *edges;
+ index_t *upward,*downward,*newindex;
+ index_t i,nupward=0;
+ int fd;
+
+ upward  =(index_t*)calloc(graph->nnodes+1,sizeof(index_t));
+ downward=(index_t*)calloc(graph->nnodes+1,sizeof(index_t));
+ newindex=(index_t*)malloc((graph->nedges>0?graph->nedges:1)*sizeof(index_t));
+ edges   =(ContractionEdge*)malloc((graph->nedges>0?graph->nedges:1)*sizeof(ContractionEdge));
+
+ assert(upward);   /* Check calloc() worked */
+ assert(downward); /* Check calloc() worked */
+ assert(newindex); /* Check malloc() worked */
+ assert(edges);    /* Check malloc() worked */
+
+ /* Count the edges for each node */
+
+ for(i=0;i<graph->nedges;i++)
+   {
+    GraphEdge *edge=&graph->edges[i];
+
+    if(graph->nodes[edge->node2].rank>graph->nodes[edge->node1].rank)
+      {
+       upward[edge->node1+1]++;
+       nupward++;
+      }
+    else
+       downward[edge->node2+1]++;
+   }
+
+ /* Convert the counts into offsets */
+
+ downward[0]=nupward;
+
+ for(i=0;i<graph->nnodes;i++)
+   {
+    upward  [i+1]+=upward  [i];
+    downward[i+1]+=downward[i];
+   }
+
+ /* Find the position of each edge in the file */
+
+ for(i=0;i<graph->nedges;i++)
+   {
+    GraphEdge *edge=&graph->edges[i];
+
+    if(graph->nodes[edge->node2].rank>graph->nodes[edge->node1].rank)
+       newindex[i]=upward[edge->node1]++;
+    else
+       newindex[i]=downward[edge->node2]++;
+   }
+
+ for(i=graph->nnodes;i>0;i--)
+   {
+    upward  [i]=upward  [i-1];
+    downward[i]=downward[i-1];
+   }
+
+ upward[0]=0;
+ downward[0]=nupward;
+
+ /* Create the edges in their new positions */
+
+ for(i=0;i<graph->nedges;i++)
+   {
+    GraphEdge *edge=&graph->edges[i];
+    ContractionEdge *newedge=&edges[newindex[i]];
+
+    if(graph->nodes[edge->node2].rank>graph->nodes[edge->node1].rank)
+       newedge->node=edge->node2;
+    else
+       newedge->node=edge->node1;
+
+    if(edge->child2==NO_SEGMENT)
+      {
+       newedge->child1=edge->child1;
+       newedge->child2=NO_SEGMENT;
+      }
+    else
+      {
+       newedge->child1=newindex[edge->child1];
+       newedge->child2=newindex[edge->child2];
+      }
+
+    newedge->score=edge->score;
+   }
+
+ /* Write out the header structure and the data */
+
+ fd=OpenFileNew(filename);
+
+ contractionfile.stamp   =stamp;
+ contractionfile.number  =graph->nnodes;
+ contractionfile.nedges  =graph->nedges;
+ contractionfile.segments=nsegments;
+ contractionfile.checksum=checksum;
+ contractionfile.quickest=quickest;
+
+ WriteFile(fd,&contractionfile,sizeof(ContractionFile));
+
+ WriteFile(fd,upward  ,(graph->nnodes+1)*sizeof(index_t));
+ WriteFile(fd,downward,(graph->nnodes+1)*sizeof(index_t));
+
+ WriteFile(fd,edges,graph->nedges*sizeof(ContractionEdge));
+
+ CloseFile(fd);
+
+ /* Free the memory */
+
+ free(upward);
+ free(downward);
+ free(newindex);
+ free(edges);
+}
@@ -32,16 +32,34 @@
 
 
 /*+ A set of fake segments to allow start/finish in the middle of a segment. +*/
-static Segment fake_segments[4*NWAYPOINTS+1];
+static THREAD_LOCAL Segment fake_segments[4*NWAYPOINTS+1];
 
 /*+ A set of pointers to the real segments underlying the fake segments. +*/
-static index_t real_segments[4*NWAYPOINTS+1];
+static THREAD_LOCAL index_t real_segments[4*NWAYPOINTS+1];
 
 /*+ A set of fake node latitudes and longitudes. +*/
-static double fake_lon[NWAYPOINTS+1],fake_lat[NWAYPOINTS+1];
+static THREAD_LOCAL double fake_lon[NWAYPOINTS+1],fake_lat[NWAYPOINTS+1];
 
 /*+ The previous waypoint. +*/
-static int prevpoint=0;
+static THREAD_LOCAL int prevpoint=0;
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Forget all of the fake nodes and segments so that a new route can be calculated.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void ResetFakes(void)
+{
+ int i;
+
+ for(i=0;i<4*NWAYPOINTS;i++)
+   {
+    fake_segments[i].node1=NO_NODE;
+    fake_segments[i].node2=NO_NODE;
+   }
+
+ prevpoint=0;
+}
 
 
 /*++++++++++++++++++++++++++++++++++++++
@@ -363,3 +381,25 @@ int IsFakeUTurn(index_t fakesegment1,index_t fakesegment2)
 
  return(0);
 }
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Determine if two fake nodes are both within the same real segment.
+
+  int IsFakeSameSegment Returns true if the two fake nodes split the same real segment.
+
+  index_t fakenode1 The first fake node.
+
+  index_t fakenode2 The second fake node.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int IsFakeSameSegment(index_t fakenode1,index_t fakenode2)
+{
+ index_t whichnode1=fakenode1-NODE_FAKE;
+ index_t whichnode2=fakenode2-NODE_FAKE;
+
+ if(!IsFakeNode(fakenode1) || !IsFakeNode(fakenode2))
+    return(0);
+
+ return(real_segments[4*whichnode1-4]==real_segments[4*whichnode2-4]);
+}
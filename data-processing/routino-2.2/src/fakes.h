@@ -37,6 +37,8 @@
 
 /* Functions in fakes.c */
 
+void ResetFakes(void);
+
 index_t CreateFakes(Nodes *nodes,Segments *segments,int point,Segment *segment,index_t node1,index_t node2,distance_t dist1,distance_t dist2);
 
 void GetFakeLatLong(index_t fakenode, double *latitude,double *longitude);
@@ -51,4 +53,6 @@ index_t IndexRealSegment(index_t fakesegment);
 
 int IsFakeUTurn(index_t fakesegment1,index_t fakesegment2);
 
+int IsFakeSameSegment(index_t fakenode1,index_t fakenode2);
+
 #endif /* FAKES_H */
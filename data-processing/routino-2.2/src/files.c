@@ -351,6 +351,46 @@ int ExistsFile(const char *filename)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate a stamp that changes whenever any of the database files is replaced (from the
+  size and modification time of the files rather than their contents so that it is quick).
+
+  uint64_t DatabaseStamp Returns the stamp.
+
+  const char *dirname The directory containing the database.
+
+  const char *prefix The prefix of the database files.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+uint64_t DatabaseStamp(const char *dirname,const char *prefix)
+{
+ const char *names[4]={"nodes.mem","segments.mem","ways.mem","relations.mem"};
+ uint64_t stamp=14695981039346656037ULL;
+ int i,j;
+
+ for(i=0;i<4;i++)
+   {
+    char *filename=FileName(dirname,prefix,names[i]);
+    struct stat buf;
+    uint64_t values[3]={0,0,0};
+
+    if(!stat(filename,&buf))
+      {
+       values[0]=buf.st_size;
+       values[1]=buf.st_mtim.tv_sec;
+       values[2]=buf.st_mtim.tv_nsec;
+      }
+
+    for(j=0;j<(int)sizeof(values);j++)
+       stamp=(stamp^((unsigned char*)values)[j])*1099511628211ULL;
+
+    free(filename);
+   }
+
+ return(stamp);
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Close a file on disk.
 
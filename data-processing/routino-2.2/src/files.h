@@ -30,6 +30,7 @@
 
 
 #include <assert.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <sys/types.h>
 
@@ -56,6 +57,8 @@ static int SeekReadFile(int fd,void *address,size_t length,off_t position);
 off_t SizeFile(const char *filename);
 int ExistsFile(const char *filename);
 
+uint64_t DatabaseStamp(const char *dirname,const char *prefix);
+
 static int SeekFile(int fd,off_t position);
 
 int CloseFile(int fd);
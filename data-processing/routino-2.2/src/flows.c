@@ -0,0 +1,166 @@
+/***************************************
+ Accumulation of trip volumes on segments for flow maps.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "types.h"
+#include "nodes.h"
+#include "segments.h"
+#include "flows.h"
+
+#include "fakes.h"
+
+
+/*+ The volume on each segment accumulated by this thread (or NULL if there are none). +*/
+static THREAD_LOCAL double *flows=NULL;
+
+/*+ The volume on each segment merged from all of the threads that have finished (or NULL if there are none). +*/
+static double *total_flows=NULL;
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+/*+ The mutex that protects the merged volumes. +*/
+static pthread_mutex_t flows_mutex=PTHREAD_MUTEX_INITIALIZER;
+
+#endif
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Add the weight of a route to the volume of each of the segments that it uses.
+
+  Segments *segments The set of segments to use.
+
+  Results **results The set of results for the route (some may be NULL - ignore them).
+
+  int nresults The number of items in the list of results.
+
+  double weight The weight to add (for example the number of trips that follow the route).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void AddRouteFlow(Segments *segments,Results **results,int nresults,double weight)
+{
+ int point;
+
+ if(!flows)
+    flows=(double*)calloc(segments->file.number,sizeof(double));
+
+ for(point=1;point<=nresults;point++)
+   {
+    Result *result;
+
+    if(!results[point])
+       continue;
+
+    /* The first result of each section is the start (not reached by a segment) */
+
+    result=FindResult(results[point],results[point]->start_node,results[point]->prev_segment);
+
+    for(result=result->next;result;result=result->next)
+       if(IsFakeSegment(result->segment))
+          flows[IndexRealSegment(result->segment)]+=weight;
+       else
+          flows[result->segment]+=weight;
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Merge the volumes accumulated by this thread into the total (called by each thread when it
+  has finished routing).
+
+  Segments *segments The set of segments to use.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void MergeThreadFlows(Segments *segments)
+{
+ if(!flows)
+    return;
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+ pthread_mutex_lock(&flows_mutex);
+#endif
+
+ if(!total_flows)
+    total_flows=flows;
+ else
+   {
+    index_t i;
+
+    for(i=0;i<segments->file.number;i++)
+       total_flows[i]+=flows[i];
+
+    free(flows);
+   }
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+ pthread_mutex_unlock(&flows_mutex);
+#endif
+
+ flows=NULL;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Write out the total volume on each segment that has been used by a route along with the
+  coordinates of the nodes at each end.
+
+  FILE *file The file to write the volumes to.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void WriteFlows(FILE *file,Nodes *nodes,Segments *segments)
+{
+ index_t i;
+
+ /* Include the volumes from the main thread */
+
+ MergeThreadFlows(segments);
+
+ if(total_flows)
+    for(i=0;i<segments->file.number;i++)
+       if(total_flows[i]!=0)
+         {
+          Segment *segment=LookupSegment(segments,i,1);
+          double latitude1,longitude1,latitude2,longitude2;
+
+          GetLatLong(nodes,segment->node1,&latitude1,&longitude1);
+          GetLatLong(nodes,segment->node2,&latitude2,&longitude2);
+
+          fprintf(file,"%"Pindex_t"\t%.6f\t%.6f\t%.6f\t%.6f\t%.15g\n",i,
+                  radians_to_degrees(latitude1),radians_to_degrees(longitude1),
+                  radians_to_degrees(latitude2),radians_to_degrees(longitude2),
+                  total_flows[i]);
+         }
+
+ if(total_flows)
+    free(total_flows);
+
+ total_flows=NULL;
+}
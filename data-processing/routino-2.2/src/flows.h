@@ -0,0 +1,41 @@
+/***************************************
+ A header file for the accumulation of trip volumes on segments.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#ifndef FLOWS_H
+#define FLOWS_H    /*+ To stop multiple inclusions. +*/
+
+#include <stdio.h>
+
+#include "types.h"
+#include "results.h"
+
+
+/* Functions in flows.c */
+
+void AddRouteFlow(Segments *segments,Results **results,int nresults,double weight);
+
+void MergeThreadFlows(Segments *segments);
+
+void WriteFlows(FILE *file,Nodes *nodes,Segments *segments);
+
+
+#endif /* FLOWS_H */
@@ -0,0 +1,83 @@
+/***************************************
+ Number formatting functions.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "formatting.h"
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Format a number with a fixed number of decimal places using integer arithmetic (the same
+  result as "%.<decimals>f" in printf but much faster).
+
+  int FormatFixed Returns the length of the string.
+
+  char *string The string to write the number into (at least 24 characters long).
+
+  double value The number to format.
+
+  int decimals The number of decimal places (0 to 6).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int FormatFixed(char *string,double value,int decimals)
+{
+ static const double scale[7]={1.0E0,1.0E1,1.0E2,1.0E3,1.0E4,1.0E5,1.0E6};
+ double scaled=fabs(value)*scale[decimals];
+ uint64_t integer;
+ char digits[24];
+ int ndigits=0,length=0;
+
+ /* Use printf if the number is too big or too close to half-way between two results to be
+    sure of rounding it the same way (printf uses the exact binary value) */
+
+ if(!(scaled<1.0E15) || fabs(scaled-floor(scaled)-0.5)<1.0E-6)
+    return(sprintf(string,"%.*f",decimals,value));
+
+ integer=(uint64_t)(scaled+0.5);
+
+ if(signbit(value))
+    string[length++]='-';
+
+ do
+   {
+    digits[ndigits++]='0'+(char)(integer%10);
+    integer/=10;
+   }
+ while(integer>0 || ndigits<=decimals);
+
+ while(ndigits>decimals)
+    string[length++]=digits[--ndigits];
+
+ if(decimals>0)
+   {
+    string[length++]='.';
+
+    while(ndigits>0)
+       string[length++]=digits[--ndigits];
+   }
+
+ string[length]=0;
+
+ return(length);
+}
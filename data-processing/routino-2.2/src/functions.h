@@ -23,6 +23,8 @@
 #ifndef FUNCTIONS_H
 #define FUNCTIONS_H    /*+ To stop multiple inclusions. +*/
 
+#include <stdio.h>
+
 #include "types.h"
 
 #include "profiles.h"
@@ -33,6 +35,14 @@
 
 Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t finish_node);
 
+Results **FindOneToManyRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t *finish_nodes,int nfinish);
+
+int FindOneToManyCosts(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t *finish_nodes,int nfinish,
+                       distance_t *distances,duration_t *durations);
+
+Results *FindContractedRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Contraction *contraction,
+                             index_t start_node,index_t prev_segment,index_t finish_node);
+
 Results *FindMiddleRoute(Nodes *supernodes,Segments *supersegments,Ways *superways,Relations *relations,Profile *profile,Results *begin,Results *end);
 
 Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t finish_node,int *nsuper);
@@ -48,5 +58,10 @@ void FixForwardRoute(Results *results,Result *finish_result);
 
 void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile);
 
+void PrintRoutePoints(FILE *file,const char *key,Results **results,int nresults,Nodes *nodes);
+
+void PrintRouteCopy(FILE *file,const char *start_key,const char *end_key,Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile);
+void PrintRouteRecord(FILE *file,const char *key,Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile);
+
 
 #endif /* FUNCTIONS_H */
@@ -0,0 +1,184 @@
+/***************************************
+ Pools of jobs that are shared between a number of threads (for batch and matrix routing).
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "types.h"
+#include "nodes.h"
+#include "segments.h"
+#include "ways.h"
+#include "relations.h"
+#include "flows.h"
+
+#include "results.h"
+#include "jobs.h"
+
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+/* Local functions */
+
+static void *JobThread(void *arg);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Start the threads that process a pool of jobs.
+
+  JobPool *pool The pool of jobs (the number of jobs and threads must be set already).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void StartJobs(JobPool *pool)
+{
+ int thread;
+
+ pool->nextjob=0;
+ pool->done=(char*)calloc(pool->njobs>0?pool->njobs:1,sizeof(char));
+
+ pthread_mutex_init(&pool->mutex,NULL);
+ pthread_cond_init(&pool->cond,NULL);
+
+ if(pool->nthreads>pool->njobs)
+    pool->nthreads=pool->njobs>0?pool->njobs:1;
+
+ pool->threads=(pthread_t*)malloc(pool->nthreads*sizeof(pthread_t));
+
+ for(thread=0;thread<pool->nthreads;thread++)
+    if(pthread_create(&pool->threads[thread],NULL,JobThread,pool))
+      {
+       fprintf(stderr,"Error: Cannot create a thread [%s].\n",strerror(errno));
+       exit(EXIT_FAILURE);
+      }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Wait until a particular job in a pool has been finished.
+
+  JobPool *pool The pool of jobs.
+
+  int job The job to wait for.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void WaitForJob(JobPool *pool,int job)
+{
+ pthread_mutex_lock(&pool->mutex);
+
+ while(!pool->done[job])
+    pthread_cond_wait(&pool->cond,&pool->mutex);
+
+ pthread_mutex_unlock(&pool->mutex);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Wait for all of the threads in a pool to finish and tidy up.
+
+  JobPool *pool The pool of jobs.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void FinishJobs(JobPool *pool)
+{
+ int thread;
+
+ for(thread=0;thread<pool->nthreads;thread++)
+    pthread_join(pool->threads[thread],NULL);
+
+ pthread_cond_destroy(&pool->cond);
+ pthread_mutex_destroy(&pool->mutex);
+
+ free(pool->threads);
+ free(pool->done);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  The main function of each thread in a pool, take jobs from the pool until there are none
+  left. Each thread has its own copy of the database handles (the data is shared but the
+  slim mode caches are not), its own fake nodes and segments and its own results and queues
+  to reuse.
+
+  void *JobThread Returns NULL.
+
+  void *arg The pool of jobs.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void *JobThread(void *arg)
+{
+ JobPool   *pool=(JobPool*)arg;
+ Nodes     *nodes;
+ Segments  *segments;
+ Ways      *ways;
+ Relations *relations;
+
+ pthread_mutex_lock(&pool->mutex);
+
+ nodes=CopyNodeList(pool->nodes);
+ segments=CopySegmentList(pool->segments);
+ ways=CopyWayList(pool->ways);
+ relations=CopyRelationList(pool->relations);
+
+ pthread_mutex_unlock(&pool->mutex);
+
+ while(1)
+   {
+    int job;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    job=pool->nextjob;
+
+    if(job<pool->njobs)
+       pool->nextjob++;
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    if(job>=pool->njobs)
+       break;
+
+    pool->function(pool,job,nodes,segments,ways,relations);
+
+    pthread_mutex_lock(&pool->mutex);
+
+    pool->done[job]=1;
+
+    pthread_cond_broadcast(&pool->cond);
+
+    pthread_mutex_unlock(&pool->mutex);
+   }
+
+ MergeThreadFlows(segments);
+
+ free(nodes);
+ free(segments);
+ free(ways);
+ free(relations);
+
+ FreeResultsCache();
+ FreeQueueCache();
+
+ return(NULL);
+}
+
+#endif /* USE_PTHREADS */
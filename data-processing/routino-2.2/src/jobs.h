@@ -0,0 +1,76 @@
+/***************************************
+ Header file for the pools of jobs that are shared between a number of threads.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#ifndef JOBS_H
+#define JOBS_H    /*+ To stop multiple inclusions. +*/
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "types.h"
+
+#include "profiles.h"
+
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+/* Data structures */
+
+/*+ A set of jobs that are shared between a number of threads. +*/
+typedef struct _JobPool
+{
+ Nodes     *nodes;                      /*+ The set of nodes to copy for each thread. +*/
+ Segments  *segments;                   /*+ The set of segments to copy for each thread. +*/
+ Ways      *ways;                       /*+ The set of ways to copy for each thread. +*/
+ Relations *relations;                  /*+ The set of relations to copy for each thread. +*/
+
+ Profile   *profile;                    /*+ The profile to use (not modified by the threads). +*/
+ double     heading;                    /*+ The starting heading (or -999 if none). +*/
+ int        exactnodes;                 /*+ Only route between nodes (don't find closest segment). +*/
+
+ void     (*function)(struct _JobPool*,int,Nodes*,Segments*,Ways*,Relations*); /*+ The function to process a job. +*/
+ void      *data;                       /*+ The data that the jobs operate on. +*/
+
+ int        njobs;                      /*+ The number of jobs. +*/
+ int        nextjob;                    /*+ The next job to be started. +*/
+ char      *done;                       /*+ A flag for each job that has finished. +*/
+
+ int        nthreads;                   /*+ The number of threads. +*/
+ pthread_t *threads;                    /*+ The threads. +*/
+
+ pthread_mutex_t mutex;                 /*+ The mutex that protects the job counters and flags. +*/
+ pthread_cond_t  cond;                  /*+ The condition that is signalled when a job finishes. +*/
+}
+ JobPool;
+
+
+/* Functions in jobs.c */
+
+void StartJobs(JobPool *pool);
+void WaitForJob(JobPool *pool,int job);
+void FinishJobs(JobPool *pool);
+
+#endif
+
+
+#endif /* JOBS_H */
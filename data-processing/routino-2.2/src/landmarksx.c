@@ -0,0 +1,256 @@
+/***************************************
+ Landmark distance creation functions.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "nodes.h"
+#include "segments.h"
+
+#include "landmarksx.h"
+
+#include "files.h"
+#include "logging.h"
+#include "results.h"
+
+
+/* Local functions */
+
+static index_t FindLandmarkDistances(Nodes *nodes,Segments *segments,Result *results,index_t landmark,distance_t *distances);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Choose a set of landmarks that are spread out across the road network and save the
+  distance from each of them to every node (ignoring the profile so that the distances
+  are a lower limit for every type of transport).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  int nlandmarks The number of landmarks to choose.
+
+  uint64_t stamp The stamp of the database files that the nodes and segments were loaded from.
+
+  const char *filename The name of the file to write.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void SaveLandmarkList(Nodes *nodes,Segments *segments,int nlandmarks,uint64_t stamp,const char *filename)
+{
+ LandmarksFile landmarksfile={0};
+ Result     *results;
+ distance_t *distances,*mindistances,*table;
+ double      minlat=0,maxlat=0,minlon=0,maxlon=0,centrelat,centrelon;
+ double      bestoffset=0;
+ index_t     i,landmark=NO_NODE;
+ int         j,nfound=0;
+ int         fd;
+
+ /* Print the start message */
+
+ printf_first("Finding Landmarks: Landmarks=0");
+
+ if(nodes->file.number>0)
+   {
+    results     =(Result*)calloc(nodes->file.number,sizeof(Result));
+    distances   =(distance_t*)malloc(nodes->file.number*sizeof(distance_t));
+    mindistances=(distance_t*)malloc(nodes->file.number*sizeof(distance_t));
+    table       =(distance_t*)malloc((size_t)nodes->file.number*nlandmarks*sizeof(distance_t));
+
+    assert(results);      /* Check calloc() worked */
+    assert(distances);    /* Check malloc() worked */
+    assert(mindistances); /* Check malloc() worked */
+    assert(table);        /* Check malloc() worked */
+
+    /* Find the node closest to the centre of the data */
+
+    for(i=0;i<nodes->file.number;i++)
+      {
+       double lat,lon;
+
+       GetLatLong(nodes,i,&lat,&lon);
+
+       if(i==0 || lat<minlat) minlat=lat;
+       if(i==0 || lat>maxlat) maxlat=lat;
+       if(i==0 || lon<minlon) minlon=lon;
+       if(i==0 || lon>maxlon) maxlon=lon;
+      }
+
+    centrelat=(minlat+maxlat)/2;
+    centrelon=(minlon+maxlon)/2;
+
+    for(i=0;i<nodes->file.number;i++)
+      {
+       double lat,lon,offset;
+
+       GetLatLong(nodes,i,&lat,&lon);
+
+       offset=(lat-centrelat)*(lat-centrelat)+(lon-centrelon)*(lon-centrelon);
+
+       if(i==0 || offset<bestoffset)
+         {
+          bestoffset=offset;
+          landmark=i;
+         }
+      }
+
+    /* The first landmark is the node furthest from the centre and each of the others is the
+       node furthest from all of the landmarks already chosen (reachable nodes only). */
+
+    landmark=FindLandmarkDistances(nodes,segments,results,landmark,distances);
+
+    for(i=0;i<nodes->file.number;i++)
+       mindistances[i]=INF_DISTANCE;
+
+    while(nfound<nlandmarks)
+      {
+       distance_t furthest=0;
+
+       FindLandmarkDistances(nodes,segments,results,landmark,distances);
+
+       for(i=0;i<nodes->file.number;i++)
+         {
+          table[(size_t)i*nlandmarks+nfound]=distances[i];
+
+          if(distances[i]<mindistances[i])
+             mindistances[i]=distances[i];
+         }
+
+       nfound++;
+
+       printf_middle("Finding Landmarks: Landmarks=%d",nfound);
+
+       for(i=0;i<nodes->file.number;i++)
+          if(mindistances[i]!=INF_DISTANCE && mindistances[i]>furthest)
+            {
+             furthest=mindistances[i];
+             landmark=i;
+            }
+
+       if(furthest==0) /* Fewer reachable nodes than landmarks */
+          break;
+      }
+
+    /* Remove the unused space if fewer landmarks were found */
+
+    if(nfound<nlandmarks)
+       for(i=0;i<nodes->file.number;i++)
+          for(j=0;j<nfound;j++)
+             table[(size_t)i*nfound+j]=table[(size_t)i*nlandmarks+j];
+
+    free(results);
+    free(distances);
+    free(mindistances);
+   }
+ else
+    table=NULL;
+
+ /* Write out the header structure and the data */
+
+ fd=OpenFileNew(filename);
+
+ landmarksfile.stamp     =stamp;
+ landmarksfile.number    =nodes->file.number;
+ landmarksfile.nlandmarks=nfound;
+
+ WriteFile(fd,&landmarksfile,sizeof(LandmarksFile));
+
+ if(table)
+    WriteFile(fd,table,(size_t)nodes->file.number*nfound*sizeof(distance_t));
+
+ CloseFile(fd);
+
+ free(table);
+
+ /* Print the final message */
+
+ printf_last("Found Landmarks: Landmarks=%d",nfound);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the shortest distance from a landmark to every node using all of the segments in
+  both directions.
+
+  index_t FindLandmarkDistances Returns the node that is furthest from the landmark.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Result *results An array of unqueued results (one per node) to use for the queue.
+
+  index_t landmark The node to start from.
+
+  distance_t *distances Returns the distance to each node (INF_DISTANCE if it cannot be reached).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t FindLandmarkDistances(Nodes *nodes,Segments *segments,Result *results,index_t landmark,distance_t *distances)
+{
+ Queue  *queue;
+ Result *result1;
+ index_t i,furthest=landmark;
+
+ for(i=0;i<nodes->file.number;i++)
+    distances[i]=INF_DISTANCE;
+
+ queue=NewQueueList();
+
+ distances[landmark]=0;
+ results[landmark].sortby=0;
+
+ InsertInQueue(queue,&results[landmark]);
+
+ while((result1=PopFromQueue(queue)))
+   {
+    index_t node1=result1-results;
+    Node *node1p=LookupNode(nodes,node1,1);
+    Segment *segment=FirstSegment(segments,node1p,1);
+
+    if(distances[node1]>distances[furthest])
+       furthest=node1;
+
+    while(segment)
+      {
+       if(IsNormalSegment(segment))
+         {
+          index_t node2=OtherNode(segment,node1);
+          distance_t distance=distances[node1]+DISTANCE(segment->distance);
+
+          if(distance<distances[node2])
+            {
+             distances[node2]=distance;
+             results[node2].sortby=(score_t)distance;
+
+             InsertInQueue(queue,&results[node2]);
+            }
+         }
+
+       segment=NextSegment(segments,segment,node1);
+      }
+   }
+
+ FreeQueueList(queue);
+
+ return(furthest);
+}
@@ -0,0 +1,481 @@
+/***************************************
+ Tables of the distances and durations between every pair of a set of points.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+
+#include "types.h"
+#include "nodes.h"
+#include "segments.h"
+#include "ways.h"
+#include "relations.h"
+
+#include "functions.h"
+#include "fakes.h"
+#include "profiles.h"
+#include "router.h"
+#include "matrix.h"
+#include "jobs.h"
+
+
+/* Local types */
+
+/*+ The points that the matrix of distances and durations is calculated for. +*/
+typedef struct _Matrix
+{
+ int         npoints;                   /*+ The number of points. +*/
+ double     *lats;                      /*+ The latitude of each point. +*/
+ double     *lons;                      /*+ The longitude of each point. +*/
+ SnappedPoint **snapped;                /*+ The point in the snapped points file for each point (or NULL). +*/
+
+ distance_t *distances;                 /*+ The distance between each pair of points. +*/
+ duration_t *durations;                 /*+ The duration between each pair of points. +*/
+}
+ Matrix;
+
+
+/* Local functions */
+
+static void MatrixRow(Matrix *matrix,int i,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes);
+static index_t MatrixSnapPoint(Matrix *matrix,int i,int waypoint,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes);
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+static void MatrixJobFunction(JobPool *pool,int job,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations);
+#endif
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate the distance and duration of the routes between every pair of points in a file
+  and write them out as a table (without calculating or printing the routes themselves).
+
+  Each row of the file contains an identifier followed by the latitude and longitude of a
+  point (separated by spaces, tabs or commas) or only the identifier of a point in the snapped
+  points file. Empty rows and those starting with '#' are ignored. The output is either CSV text with one line per pair of points or a binary file
+  containing the number of points (32-bit integer) followed by the matrix of distances (km)
+  and the matrix of durations (minutes) as 32-bit floats (NaN if there is no route).
+
+  int MatrixQueries Returns 0 if the file was processed or 1 if it could not be opened.
+
+  const char *filename The name of the file of points ("-" for stdin).
+
+  int binary Set to true to write the binary format instead of CSV.
+
+  FILE *output The file to write the results to.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  double heading The starting heading (or -999 if none).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+
+  int nthreads The number of threads to use.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int MatrixQueries(const char *filename,int binary,FILE *output,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes,int nthreads)
+{
+ FILE       *input;
+ char       *line=NULL;
+ size_t      length=0;
+ char      **ids=NULL;
+ double     *lats=NULL,*lons=NULL;
+ SnappedPoint **snapped=NULL;
+ distance_t *distances;
+ duration_t *durations;
+ Matrix      matrix;
+ int         npoints=0;
+ int         i,j;
+
+ if(!strcmp(filename,"-"))
+    input=stdin;
+ else if(!(input=fopen(filename,"r")))
+   {
+    fprintf(stderr,"Error: Cannot open matrix file '%s' for reading [%s].\n",filename,strerror(errno));
+    return(1);
+   }
+
+ /* Read in the points */
+
+ while(getline(&line,&length,input)!=-1)
+   {
+    char *id,*lat,*lon;
+
+    id=strtok(line," \t,\r\n");
+
+    if(!id || *id=='#')
+       continue;
+
+    lat=strtok(NULL," \t,\r\n");
+    lon=strtok(NULL," \t,\r\n");
+
+    if((lat && !lon) || strtok(NULL," \t,\r\n"))
+      {
+       fprintf(stderr,"Error: Matrix rows must contain an identifier and 2 coordinates or a snapped point identifier (row '%s').\n",id);
+       return(1);
+      }
+
+    if((npoints%64)==0)
+      {
+       ids =(char**) realloc((void*)ids ,(npoints+64)*sizeof(char*));
+       lats=(double*)realloc((void*)lats,(npoints+64)*sizeof(double));
+       lons=(double*)realloc((void*)lons,(npoints+64)*sizeof(double));
+       snapped=(SnappedPoint**)realloc((void*)snapped,(npoints+64)*sizeof(SnappedPoint*));
+      }
+
+    /* A row without coordinates uses the snapped point with the same identifier */
+
+    if(!lat && !(snapped[npoints]=FindSnappedPoint(id)))
+      {
+       fprintf(stderr,"Error: Cannot find snapped point '%s'.\n",id);
+       return(1);
+      }
+
+    ids[npoints]=strcpy((char*)malloc(strlen(id)+1),id);
+
+    if(lat)
+      {
+       lats[npoints]=degrees_to_radians(atof(lat));
+       lons[npoints]=degrees_to_radians(atof(lon));
+       snapped[npoints]=NULL;
+      }
+
+    npoints++;
+   }
+
+ if(line)
+    free(line);
+
+ if(input!=stdin)
+    fclose(input);
+
+ distances=(distance_t*)malloc((size_t)npoints*npoints*sizeof(distance_t));
+ durations=(duration_t*)malloc((size_t)npoints*npoints*sizeof(duration_t));
+
+ matrix.npoints=npoints;
+ matrix.lats=lats;
+ matrix.lons=lons;
+ matrix.snapped=snapped;
+ matrix.distances=distances;
+ matrix.durations=durations;
+
+ /* Search from each point in turn to the others (one row of the matrix per job if using threads) */
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ if(nthreads>1)
+   {
+    JobPool pool;
+
+    pool.nodes=nodes;
+    pool.segments=segments;
+    pool.ways=ways;
+    pool.relations=relations;
+    pool.profile=profile;
+    pool.heading=heading;
+    pool.exactnodes=exactnodes;
+
+    pool.function=MatrixJobFunction;
+    pool.data=&matrix;
+    pool.njobs=npoints;
+    pool.nthreads=nthreads;
+
+    StartJobs(&pool);
+
+    FinishJobs(&pool);
+   }
+ else
+
+#endif
+
+    for(i=0;i<npoints;i++)
+       MatrixRow(&matrix,i,nodes,segments,ways,relations,profile,heading,exactnodes);
+
+ /* Print out the results */
+
+ if(binary)
+   {
+    uint32_t n=npoints;
+
+    fwrite(&n,sizeof(uint32_t),1,output);
+
+    for(i=0;i<npoints*npoints;i++)
+      {
+       float value=(distances[i]==INF_DISTANCE)?NAN:(float)distance_to_km(distances[i]);
+
+       fwrite(&value,sizeof(float),1,output);
+      }
+
+    for(i=0;i<npoints*npoints;i++)
+      {
+       float value=(distances[i]==INF_DISTANCE)?NAN:(float)duration_to_minutes(durations[i]);
+
+       fwrite(&value,sizeof(float),1,output);
+      }
+   }
+ else
+   {
+    fprintf(output,"from,to,distance,duration\n");
+
+    for(i=0;i<npoints;i++)
+       for(j=0;j<npoints;j++)
+          if(distances[i*npoints+j]==INF_DISTANCE)
+             fprintf(output,"%s,%s,,\n",ids[i],ids[j]);
+          else
+             fprintf(output,"%s,%s,%.3f,%.2f\n",ids[i],ids[j],
+                     distance_to_km(distances[i*npoints+j]),duration_to_minutes(durations[i*npoints+j]));
+   }
+
+ fflush(output);
+
+ for(i=0;i<npoints;i++)
+    free(ids[i]);
+
+ free(ids);
+ free(lats);
+ free(lons);
+ free(snapped);
+
+ free(distances);
+ free(durations);
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate one row of the matrix of distances and durations (from one point to all of the
+  others, in groups limited by the number of fake nodes).
+
+  Matrix *matrix The points and the matrix of distances and durations to fill in.
+
+  int i The point to start from.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  double heading The starting heading (or -999 if none).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void MatrixRow(Matrix *matrix,int i,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,double heading,int exactnodes)
+{
+ int         npoints=matrix->npoints;
+ distance_t *distances=&matrix->distances[i*npoints];
+ duration_t *durations=&matrix->durations[i*npoints];
+ Contraction *contraction=ChooseContraction(profile);
+ int         j,k;
+
+ for(j=0;j<npoints;j+=NWAYPOINTS-1)
+   {
+    index_t finish_nodes[NWAYPOINTS-1];
+    index_t start_node,prev_segment=NO_SEGMENT;
+    int     nfinish=npoints-j;
+    int     same[NWAYPOINTS-1],nsame;
+    int     contracted[NWAYPOINTS-1]={0};
+    distance_t contracted_distances[NWAYPOINTS-1];
+    duration_t contracted_durations[NWAYPOINTS-1];
+
+    if(nfinish>NWAYPOINTS-1)
+       nfinish=NWAYPOINTS-1;
+
+    ResetFakes();
+
+    start_node=MatrixSnapPoint(matrix,i,1,nodes,segments,ways,profile,exactnodes);
+
+    if(start_node==NO_NODE)
+      {
+       for(k=0;k<nfinish;k++)
+         {
+          distances[j+k]=INF_DISTANCE;
+          durations[j+k]=INF_DISTANCE;
+         }
+
+       continue;
+      }
+
+    for(k=0;k<nfinish;k++)
+      {
+       finish_nodes[k]=MatrixSnapPoint(matrix,j+k,k+2,nodes,segments,ways,profile,exactnodes);
+
+       /* Waypoints that cannot be reached are not searched for */
+
+       if(finish_nodes[k]!=NO_NODE && !WaypointsConnected(nodes,profile,start_node,finish_nodes[k]))
+          finish_nodes[k]=NO_NODE;
+      }
+
+    if(heading!=-999)
+       prev_segment=FindClosestSegmentHeading(nodes,segments,ways,start_node,heading,profile);
+
+    /* Route each pair using the contraction hierarchy (the others are found by a one-to-many search) */
+
+    if(contraction)
+       for(k=0;k<nfinish;k++)
+          if(finish_nodes[k]!=NO_NODE && finish_nodes[k]!=start_node && !IsFakeSameSegment(start_node,finish_nodes[k]))
+            {
+             Results *results=FindContractedRoute(nodes,segments,ways,relations,profile,contraction,start_node,prev_segment,finish_nodes[k]);
+             Result *result;
+
+             if(!results)
+                continue;
+
+             contracted[k]=1;
+             contracted_distances[k]=0;
+             contracted_durations[k]=0;
+
+             for(result=FindResult(results,results->finish_node,results->last_segment);result->prev;result=result->prev)
+               {
+                Segment *segment;
+                Way *way;
+
+                if(IsFakeSegment(result->segment))
+                   segment=LookupFakeSegment(result->segment);
+                else
+                   segment=LookupSegment(segments,result->segment,1);
+
+                way=LookupWay(ways,segment->way,1);
+
+                contracted_distances[k]+=DISTANCE(segment->distance);
+                contracted_durations[k]+=Duration(segment,way,profile);
+               }
+
+             FreeResultsList(results);
+
+             finish_nodes[k]=NO_NODE;
+            }
+
+    FindOneToManyCosts(nodes,segments,ways,relations,profile,start_node,prev_segment,finish_nodes,nfinish,
+                       &distances[j],&durations[j]);
+
+    for(k=0;k<nfinish;k++)
+       if(contracted[k])
+         {
+          distances[j+k]=contracted_distances[k];
+          durations[j+k]=contracted_durations[k];
+         }
+
+    /* Waypoints within the same segment are only joined directly when routed as a pair */
+
+    nsame=0;
+
+    for(k=0;k<nfinish;k++)
+       if(j+k==i)
+         {
+          distances[j+k]=0;
+          durations[j+k]=0;
+         }
+       else if(IsFakeSameSegment(start_node,finish_nodes[k]))
+          same[nsame++]=k;
+
+    while(nsame>0)
+      {
+       index_t finish_node;
+
+       k=same[--nsame];
+
+       ResetFakes();
+
+       start_node=MatrixSnapPoint(matrix,i,1,nodes,segments,ways,profile,exactnodes);
+       finish_node=MatrixSnapPoint(matrix,j+k,2,nodes,segments,ways,profile,exactnodes);
+
+       FindOneToManyCosts(nodes,segments,ways,relations,profile,start_node,prev_segment,&finish_node,1,
+                          &distances[j+k],&durations[j+k]);
+      }
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the node closest to one of the points of the matrix (or use the snapped point).
+
+  index_t MatrixSnapPoint Returns the node or NO_NODE if there is nothing close enough.
+
+  Matrix *matrix The points of the matrix.
+
+  int i The point to find.
+
+  int waypoint The waypoint number to use for the fake nodes.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t MatrixSnapPoint(Matrix *matrix,int i,int waypoint,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes)
+{
+ index_t snapped;
+
+ if(matrix->snapped[i])
+    return(SnappedWaypoint(nodes,segments,waypoint,matrix->snapped[i],&snapped));
+ else
+    return(SnapWaypoint(nodes,segments,ways,profile,waypoint,matrix->lats[i],matrix->lons[i],exactnodes,NULL));
+}
+
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate one row of the matrix in a thread.
+
+  JobPool *pool The pool of jobs (the data is the matrix).
+
+  int job The job to process (the row of the matrix).
+
+  Nodes *nodes The set of nodes to use (private to this thread).
+
+  Segments *segments The set of segments to use (private to this thread).
+
+  Ways *ways The set of ways to use (private to this thread).
+
+  Relations *relations The set of relations to use (private to this thread).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void MatrixJobFunction(JobPool *pool,int job,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations)
+{
+ MatrixRow((Matrix*)pool->data,job,nodes,segments,ways,relations,pool->profile,pool->heading,pool->exactnodes);
+}
+
+#endif
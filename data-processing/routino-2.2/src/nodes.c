@@ -32,9 +32,15 @@
 #include "profiles.h"
 
 
+/*+ The radius of the Earth in metres (the same as is used by Distance()). +*/
+#define EARTH_RADIUS 6378137.0
+
+
 /* Local functions */
 
-static int valid_segment_for_profile(Ways *ways,Segment *segment,Profile *profile);
+static index_t FindClosestBinnedSegment(Nodes *nodes,Segments *segments,Ways *ways,double latitude,double longitude,
+                                        distance_t distance,Profile *profile, distance_t *bestdist,
+                                        index_t *bestnode1,index_t *bestnode2,distance_t *bestdist1,distance_t *bestdist2);
 
 
 /*++++++++++++++++++++++++++++++++++++++
@@ -55,6 +61,8 @@ Nodes *LoadNodeList(const char *filename)
 
  nodes=(Nodes*)malloc(sizeof(Nodes));
 
+ nodes->nlandmarks=0;
+
 #if !SLIM
 
  nodes->data=MapFile(filename);
@@ -68,6 +76,10 @@ Nodes *LoadNodeList(const char *filename)
  nodes->offsets=(index_t*)(nodes->data+sizeof(NodesFile));
  nodes->nodes  =(Node*   )(nodes->data+sizeof(NodesFile)+(nodes->file.latbins*nodes->file.lonbins+1)*sizeof(index_t));
 
+ nodes->components=NULL;
+
+ nodes->landmarks=NULL;
+
 #else
 
  nodes->fd=ReOpenFile(filename);
@@ -84,6 +96,10 @@ Nodes *LoadNodeList(const char *filename)
 
  nodes->nodesoffset=sizeof(NodesFile)+sizeoffsets;
 
+ nodes->cfd=-1;
+
+ nodes->lfd=-1;
+
  for(i=0;i<sizeof(nodes->cached)/sizeof(nodes->cached[0]);i++)
     nodes->incache[i]=NO_NODE;
 
@@ -93,6 +109,215 @@ Nodes *LoadNodeList(const char *filename)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Create a copy of a node list that can be used by another thread at the same time
+  (the copy has its own cache in slim mode).
+
+  Nodes *CopyNodeList Returns the new node list.
+
+  Nodes *nodes The node list to copy.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Nodes *CopyNodeList(Nodes *nodes)
+{
+ Nodes *copy;
+#if SLIM
+ int i;
+#endif
+
+ copy=(Nodes*)malloc(sizeof(Nodes));
+
+ *copy=*nodes;
+
+#if SLIM
+
+ for(i=0;i<sizeof(copy->cached)/sizeof(copy->cached[0]);i++)
+    copy->incache[i]=NO_NODE;
+
+#endif
+
+ return(copy);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in the connected component labels for a node list from a file.
+
+  int LoadNodeComponents Returns 0 if the labels were loaded or 1 if they do not match the nodes.
+
+  Nodes *nodes The node list to add the labels to.
+
+  const char *filename The name of the file to load.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int LoadNodeComponents(Nodes *nodes,const char *filename)
+{
+ ComponentsFile componentsfile;
+
+#if !SLIM
+
+ void *data=MapFile(filename);
+
+ componentsfile=*((ComponentsFile*)data);
+
+ if(componentsfile.number!=nodes->file.number)
+   {
+    UnmapFile(filename);
+    return(1);
+   }
+
+ nodes->components=(index_t*)(data+sizeof(ComponentsFile));
+
+#else
+
+ nodes->cfd=ReOpenFile(filename);
+
+ ReadFile(nodes->cfd,&componentsfile,sizeof(ComponentsFile));
+
+ if(componentsfile.number!=nodes->file.number)
+   {
+    nodes->cfd=CloseFile(nodes->cfd);
+    return(1);
+   }
+
+#endif
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Check if two nodes might be connected for a type of transport (there cannot be a route
+  between them if they are in different connected components).
+
+  int NodesConnected Returns 1 if they might be connected or 0 if they cannot be.
+
+  Nodes *nodes The set of nodes to use.
+
+  Transport transport The type of transport.
+
+  index_t node1 The first node (not a fake node).
+
+  index_t node2 The second node (not a fake node).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int NodesConnected(Nodes *nodes,Transport transport,index_t node1,index_t node2)
+{
+ index_t label1,label2;
+ off_t offset=(off_t)(transport-1)*nodes->file.number;
+
+ if(transport==Transport_None || transport>=Transport_Count)
+    return(1);
+
+#if !SLIM
+
+ if(!nodes->components)
+    return(1);
+
+ label1=nodes->components[offset+node1];
+ label2=nodes->components[offset+node2];
+
+#else
+
+ if(nodes->cfd==-1)
+    return(1);
+
+ SeekReadFile(nodes->cfd,&label1,sizeof(index_t),sizeof(ComponentsFile)+(offset+node1)*sizeof(index_t));
+ SeekReadFile(nodes->cfd,&label2,sizeof(index_t),sizeof(ComponentsFile)+(offset+node2)*sizeof(index_t));
+
+#endif
+
+ return(label1==label2);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in the distances from the landmarks for a node list from a file.
+
+  int LoadNodeLandmarks Returns 0 if the distances were loaded or 1 if they do not match the database.
+
+  Nodes *nodes The node list to add the distances to.
+
+  const char *filename The name of the file to load.
+
+  uint64_t stamp The stamp of the database files (the landmarks must have been created from the same files).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int LoadNodeLandmarks(Nodes *nodes,const char *filename,uint64_t stamp)
+{
+ LandmarksFile landmarksfile;
+
+#if !SLIM
+
+ void *data=MapFile(filename);
+
+ landmarksfile=*((LandmarksFile*)data);
+
+ if(landmarksfile.stamp!=stamp || landmarksfile.number!=nodes->file.number || landmarksfile.nlandmarks>MAX_LANDMARKS)
+   {
+    UnmapFile(filename);
+    return(1);
+   }
+
+ nodes->landmarks=(distance_t*)(data+sizeof(LandmarksFile));
+
+#else
+
+ nodes->lfd=ReOpenFile(filename);
+
+ ReadFile(nodes->lfd,&landmarksfile,sizeof(LandmarksFile));
+
+ if(landmarksfile.stamp!=stamp || landmarksfile.number!=nodes->file.number || landmarksfile.nlandmarks>MAX_LANDMARKS)
+   {
+    nodes->lfd=CloseFile(nodes->lfd);
+    return(1);
+   }
+
+#endif
+
+ nodes->nlandmarks=landmarksfile.nlandmarks;
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Get the distances from each of the landmarks to a node (the difference between the
+  distances for two nodes is a lower limit for the distance of any route between them).
+
+  int GetLandmarkDistances Returns the number of distances (0 if there are no landmarks).
+
+  Nodes *nodes The set of nodes to use.
+
+  index_t node The node (not a fake node).
+
+  distance_t *distances Returns the distances (INF_DISTANCE for a landmark that cannot be reached).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int GetLandmarkDistances(Nodes *nodes,index_t node,distance_t *distances)
+{
+#if !SLIM
+ uint32_t i;
+#endif
+
+ if(nodes->nlandmarks==0)
+    return(0);
+
+#if !SLIM
+
+ for(i=0;i<nodes->nlandmarks;i++)
+    distances[i]=nodes->landmarks[(off_t)node*nodes->nlandmarks+i];
+
+#else
+
+ SeekReadFile(nodes->lfd,distances,nodes->nlandmarks*sizeof(distance_t),sizeof(LandmarksFile)+(off_t)node*nodes->nlandmarks*sizeof(distance_t));
+
+#endif
+
+ return(nodes->nlandmarks);
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Find the closest node given its latitude, longitude and the profile of the
   mode of transport that must be able to move to/from this node.
@@ -197,8 +422,14 @@ index_t FindClosestNode(Nodes *nodes,Segments *segments,Ways *ways,double latitu
              Node *node=LookupNode(nodes,i,3);
              double lat=latlong_to_radians(bin_to_latlong(nodes->file.latzero+latb)+off_to_latlong(node->latoffset));
              double lon=latlong_to_radians(bin_to_latlong(nodes->file.lonzero+lonb)+off_to_latlong(node->lonoffset));
+             distance_t dist;
+
+             /* The difference in latitude alone is a lower limit for the distance */
 
-             distance_t dist=Distance(lat,lon,latitude,longitude);
+             if(fabs(lat-latitude)*EARTH_RADIUS>(double)distance+1)
+                continue;
+
+             dist=Distance(lat,lon,latitude,longitude);
 
              if(dist<distance)
                {
@@ -210,7 +441,7 @@ index_t FindClosestNode(Nodes *nodes,Segments *segments,Ways *ways,double latitu
 
                 do
                   {
-                   if(IsNormalSegment(segment) && valid_segment_for_profile(ways,segment,profile))
+                   if(IsNormalSegment(segment) && ValidSegmentForProfile(ways,segment,profile))
                      {
                       bestn=i;
                       bestd=distance=dist;
@@ -282,6 +513,12 @@ index_t FindClosestSegment(Nodes *nodes,Segments *segments,Ways *ways,double lat
  distance_t bestd=INF_DISTANCE,bestd1=INF_DISTANCE,bestd2=INF_DISTANCE;
  index_t    bests=NO_SEGMENT;
 
+ /* Use the lists of segments in each bin if they have been loaded */
+
+ if(segments->binoffsets)
+    return(FindClosestBinnedSegment(nodes,segments,ways,latitude,longitude,distance,profile,bestdist,
+                                    bestnode1,bestnode2,bestdist1,bestdist2));
+
  /* Start with the bin containing the location, then spiral outwards. */
 
  do
@@ -355,6 +592,9 @@ index_t FindClosestSegment(Nodes *nodes,Segments *segments,Ways *ways,double lat
              double lon1=latlong_to_radians(bin_to_latlong(nodes->file.lonzero+lonb)+off_to_latlong(node->lonoffset));
              distance_t dist1;
 
+             if(fabs(lat1-latitude)*EARTH_RADIUS>(double)distance+1)
+                continue;
+
              dist1=Distance(lat1,lon1,latitude,longitude);
 
              if(dist1<distance)
@@ -367,7 +607,7 @@ index_t FindClosestSegment(Nodes *nodes,Segments *segments,Ways *ways,double lat
 
                 do
                   {
-                   if(IsNormalSegment(segment) && valid_segment_for_profile(ways,segment,profile))
+                   if(IsNormalSegment(segment) && ValidSegmentForProfile(ways,segment,profile))
                      {
                       distance_t dist2,dist3;
                       double lat2,lon2,dist3a,dist3b,distp;
@@ -451,10 +691,220 @@ index_t FindClosestSegment(Nodes *nodes,Segments *segments,Ways *ways,double lat
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Find the closest point on the closest segment using the lists of segments in each
+  lat/long bin (this finds long segments whose nodes are both far from the location).
+
+  index_t FindClosestBinnedSegment Returns the closest segment index.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to search.
+
+  Ways *ways The set of ways to use.
+
+  double latitude The latitude to look for.
+
+  double longitude The longitude to look for.
+
+  distance_t distance The maximum distance to look from the specified coordinates.
+
+  Profile *profile The profile of the mode of transport.
+
+  distance_t *bestdist Returns the distance to the closest point on the best segment.
+
+  index_t *bestnode1 Returns the index of the node at one end of the closest segment.
+
+  index_t *bestnode2 Returns the index of the node at the other end of the closest segment.
+
+  distance_t *bestdist1 Returns the distance along the segment to the node at one end.
+
+  distance_t *bestdist2 Returns the distance along the segment to the node at the other end.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t FindClosestBinnedSegment(Nodes *nodes,Segments *segments,Ways *ways,double latitude,double longitude,
+                                        distance_t distance,Profile *profile, distance_t *bestdist,
+                                        index_t *bestnode1,index_t *bestnode2,distance_t *bestdist1,distance_t *bestdist2)
+{
+ ll_bin_t   latbin=latlong_to_bin(radians_to_latlong(latitude ))-nodes->file.latzero;
+ ll_bin_t   lonbin=latlong_to_bin(radians_to_latlong(longitude))-nodes->file.lonzero;
+ int        delta=0,count;
+ index_t    i,index1,index2;
+ index_t    bestn1=NO_NODE,bestn2=NO_NODE;
+ distance_t bestd=INF_DISTANCE,bestd1=INF_DISTANCE,bestd2=INF_DISTANCE;
+ index_t    bests=NO_SEGMENT;
+ double     coslat=cos(latitude);
+
+ /* Start with the bin containing the location, then spiral outwards. */
+
+ do
+   {
+    ll_bin_t latb,lonb;
+    ll_bin2_t llbin;
+    distance_t limit=(bestd<distance)?bestd:distance;
+
+    count=0;
+
+    for(latb=latbin-delta;latb<=latbin+delta;latb++)
+      {
+       if(latb<0 || latb>=nodes->file.latbins)
+          continue;
+
+       for(lonb=lonbin-delta;lonb<=lonbin+delta;lonb++)
+         {
+          if(lonb<0 || lonb>=nodes->file.lonbins)
+             continue;
+
+          if(abs(latb-latbin)<delta && abs(lonb-lonbin)<delta)
+             continue;
+
+          llbin=lonb*nodes->file.latbins+latb;
+
+          /* Check if this grid square has any hope of being closer than the best so far */
+
+          if(delta>0)
+            {
+             double lat1=latlong_to_radians(bin_to_latlong(nodes->file.latzero+latb));
+             double lon1=latlong_to_radians(bin_to_latlong(nodes->file.lonzero+lonb));
+             double lat2=latlong_to_radians(bin_to_latlong(nodes->file.latzero+latb+1));
+             double lon2=latlong_to_radians(bin_to_latlong(nodes->file.lonzero+lonb+1));
+
+             if(latb==latbin)
+               {
+                distance_t dist1=Distance(latitude,lon1,latitude,longitude);
+                distance_t dist2=Distance(latitude,lon2,latitude,longitude);
+
+                if(dist1>limit && dist2>limit)
+                   continue;
+               }
+             else if(lonb==lonbin)
+               {
+                distance_t dist1=Distance(lat1,longitude,latitude,longitude);
+                distance_t dist2=Distance(lat2,longitude,latitude,longitude);
+
+                if(dist1>limit && dist2>limit)
+                   continue;
+               }
+             else
+               {
+                distance_t dist1=Distance(lat1,lon1,latitude,longitude);
+                distance_t dist2=Distance(lat2,lon1,latitude,longitude);
+                distance_t dist3=Distance(lat2,lon2,latitude,longitude);
+                distance_t dist4=Distance(lat1,lon2,latitude,longitude);
+
+                if(dist1>limit && dist2>limit && dist3>limit && dist4>limit)
+                   continue;
+               }
+            }
+
+          /* Check every segment in this grid square. */
+
+          index1=segments->binoffsets[llbin];
+          index2=segments->binoffsets[llbin+1];
+
+          for(i=index1;i<index2;i++)
+            {
+             BinnedSegment *binned=LookupBinnedSegment(segments,i);
+             double lat1=latlong_to_radians(binned->lat1);
+             double lon1=latlong_to_radians(binned->lon1);
+             double lat2=latlong_to_radians(binned->lat2);
+             double lon2=latlong_to_radians(binned->lon2);
+             double dlat,dlon;
+             distance_t dist1,dist2,dist3;
+             double dist3a,dist3b,distp;
+             index_t segindex=binned->segment;
+             Segment *segment;
+
+             /* Skip the segment if its bounding box is too far away (flat Earth with a margin) */
+
+             dlat=(latitude<lat1 && latitude<lat2)?((lat1<lat2?lat1:lat2)-latitude):
+                  (latitude>lat1 && latitude>lat2)?(latitude-(lat1>lat2?lat1:lat2)):0;
+             dlon=(longitude<lon1 && longitude<lon2)?((lon1<lon2?lon1:lon2)-longitude):
+                  (longitude>lon1 && longitude>lon2)?(longitude-(lon1>lon2?lon1:lon2)):0;
+
+             if((dlat*dlat+dlon*dlon*coslat*coslat)*EARTH_RADIUS*EARTH_RADIUS>((double)limit*1.1+10)*((double)limit*1.1+10))
+                continue;
+
+             dist1=Distance(lat1,lon1,latitude,longitude);
+             dist2=Distance(lat2,lon2,latitude,longitude);
+             dist3=Distance(lat1,lon1,lat2,lon2);
+
+             /* Use law of cosines (assume flat Earth) */
+
+             if(dist3==0)
+               {
+                distp=dist1;
+                dist3a=0;
+                dist3b=0;
+               }
+             else
+               {
+                dist3a=((double)dist1*(double)dist1-(double)dist2*(double)dist2+(double)dist3*(double)dist3)/(2.0*(double)dist3);
+                dist3b=(double)dist3-dist3a;
+
+                if((dist1+dist2)<dist3)
+                  {
+                   distp=0;
+                  }
+                else if(dist3a>=0 && dist3b>=0)
+                   distp=sqrt((double)dist1*(double)dist1-dist3a*dist3a);
+                else if(dist3a>0)
+                  {
+                   distp=dist2;
+                   dist3a=dist3;
+                   dist3b=0;
+                  }
+                else /* if(dist3b>0) */
+                  {
+                   distp=dist1;
+                   dist3a=0;
+                   dist3b=dist3;
+                  }
+               }
+
+             if(distp>=(double)bestd || distp>=(double)distance)
+                continue;
+
+             segment=LookupSegment(segments,segindex,1);
+
+             if(!ValidSegmentForProfile(ways,segment,profile))
+                continue;
+
+             bests=segindex;
+
+             bestn1=segment->node1;
+             bestn2=segment->node2;
+             bestd1=(distance_t)dist3a;
+             bestd2=(distance_t)dist3b;
+
+             bestd=(distance_t)distp;
+
+             limit=bestd;
+            }
+
+          count++;
+         }
+      }
+
+    delta++;
+   }
+ while(count);
+
+ *bestdist=bestd;
+
+ *bestnode1=bestn1;
+ *bestnode2=bestn2;
+ *bestdist1=bestd1;
+ *bestdist2=bestd2;
+
+ return(bests);
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Check if the transport defined by the profile is allowed on the segment.
 
-  int valid_segment_for_profile Return 1 if it is or 0 if not.
+  int ValidSegmentForProfile Return 1 if it is or 0 if not.
 
   Ways *ways The set of ways to use.
 
@@ -463,11 +913,10 @@ index_t FindClosestSegment(Nodes *nodes,Segments *segments,Ways *ways,double lat
   Profile *profile The profile to check.
   ++++++++++++++++++++++++++++++++++++++*/
 
-static int valid_segment_for_profile(Ways *ways,Segment *segment,Profile *profile)
+int ValidSegmentForProfile(Ways *ways,Segment *segment,Profile *profile)
 {
  Way *way=LookupWay(ways,segment->way,1);
  score_t segment_pref;
- int i;
 
  /* mode of transport must be allowed on the highway */
  if(!(way->allow&profile->allow))
@@ -483,16 +932,7 @@ static int valid_segment_for_profile(Ways *ways,Segment *segment,Profile *profil
     (way->length && way->length<profile->length))
     return(0);
 
- segment_pref=profile->highway[HIGHWAY(way->type)];
-
- for(i=1;i<Property_Count;i++)
-    if(ways->file.props & PROPERTIES(i))
-      {
-       if(way->props & PROPERTIES(i))
-          segment_pref*=profile->props_yes[i];
-       else
-          segment_pref*=profile->props_no[i];
-      }
+ segment_pref=WayPreference(profile,way);
 
  /* profile preferences must allow this highway */
  if(segment_pref==0)
@@ -32,6 +32,12 @@
 #include "profiles.h"
 
 
+/* Constants */
+
+/*+ The maximum number of landmarks that can be used to estimate the distance between nodes. +*/
+#define MAX_LANDMARKS 32
+
+
 /* Data structures */
 
 
@@ -63,11 +69,32 @@ typedef struct _NodesFile
  NodesFile;
 
 
+/*+ A structure containing the header from the connected components file. +*/
+typedef struct _ComponentsFile
+{
+ index_t  number;               /*+ The number of nodes in total (followed by one label per node for each transport). +*/
+}
+ ComponentsFile;
+
+
+/*+ A structure containing the header from the landmarks file. +*/
+typedef struct _LandmarksFile
+{
+ uint64_t stamp;                /*+ The stamp of the database files that the landmarks were created from. +*/
+
+ index_t  number;               /*+ The number of nodes in total. +*/
+ uint32_t nlandmarks;           /*+ The number of landmarks (followed by the distance from each landmark to each node). +*/
+}
+ LandmarksFile;
+
+
 /*+ A structure containing a set of nodes. +*/
 struct _Nodes
 {
  NodesFile file;                /*+ The header data from the file. +*/
 
+ uint32_t  nlandmarks;          /*+ The number of landmark distances for each node (or 0 if none are loaded). +*/
+
 #if !SLIM
 
  void     *data;                /*+ The memory mapped data in the file. +*/
@@ -76,6 +103,10 @@ struct _Nodes
 
  Node     *nodes;               /*+ A pointer to the array of nodes in the file. +*/
 
+ index_t  *components;          /*+ A pointer to the array of connected component labels (or NULL). +*/
+
+ distance_t *landmarks;         /*+ A pointer to the array of distances from the landmarks (or NULL). +*/
+
 #else
 
  int       fd;                  /*+ The file descriptor for the file. +*/
@@ -84,6 +115,10 @@ struct _Nodes
 
  off_t     nodesoffset;         /*+ The offset of the nodes within the file. +*/
 
+ int       cfd;                 /*+ The file descriptor for the connected components file (or -1). +*/
+
+ int       lfd;                 /*+ The file descriptor for the landmarks file (or -1). +*/
+
  Node      cached[6];           /*+ Some cached nodes read from the file in slim mode. +*/
  index_t   incache[6];          /*+ The indexes of the cached nodes. +*/
 
@@ -95,6 +130,8 @@ struct _Nodes
 
 Nodes *LoadNodeList(const char *filename);
 
+Nodes *CopyNodeList(Nodes *nodes);
+
 index_t FindClosestNode(Nodes *nodes,Segments *segments,Ways *ways,double latitude,double longitude,
                         distance_t distance,Profile *profile,distance_t *bestdist);
 
@@ -104,6 +141,16 @@ index_t FindClosestSegment(Nodes *nodes,Segments *segments,Ways *ways,double lat
 
 void GetLatLong(Nodes *nodes,index_t index,double *latitude,double *longitude);
 
+int LoadNodeComponents(Nodes *nodes,const char *filename);
+
+int NodesConnected(Nodes *nodes,Transport transport,index_t node1,index_t node2);
+
+int LoadNodeLandmarks(Nodes *nodes,const char *filename,uint64_t stamp);
+
+int GetLandmarkDistances(Nodes *nodes,index_t node,distance_t *distances);
+
+int ValidSegmentForProfile(Ways *ways,Segment *segment,Profile *profile);
+
 
 /* Macros and inline functions */
 
@@ -53,6 +53,8 @@ static int deduplicate_and_index_by_id(NodeX *nodex,index_t index);
 static int sort_by_lat_long(NodeX *a,NodeX *b);
 static int delete_pruned_and_index_by_lat_long(NodeX *nodex,index_t index);
 
+static index_t find_component(index_t *labels,index_t node);
+
 
 /*++++++++++++++++++++++++++++++++++++++
   Allocate a new node list (create a new file or open an existing one).
@@ -720,3 +722,141 @@ void SaveNodeList(NodesX *nodesx,const char *filename)
 
  printf_last("Wrote Nodes: Nodes=%"Pindex_t,nodesx->number);
 }
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate the connected components of the nodes for each type of transport and save
+  them to a file (two nodes have the same label if they are joined by highways that allow
+  the transport). One-way restrictions, barriers at nodes and profile preferences are
+  ignored so nodes with different labels can never be joined by a route but nodes with
+  the same label might not be.
+
+  NodesX *nodesx The set of nodes to use.
+
+  SegmentsX *segmentsx The set of segments to use.
+
+  WaysX *waysx The set of ways to use.
+
+  const char *filename The name of the file to save.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void SaveComponentList(NodesX *nodesx,SegmentsX *segmentsx,WaysX *waysx,const char *filename)
+{
+ index_t i;
+ int fd;
+ ComponentsFile componentsfile={0};
+ transports_t *allow;
+ index_t *labels;
+ Transport transport;
+
+ /* Print the start message */
+
+ printf_first("Writing Components: Transports=0");
+
+ /* Find the allowed transports for each of the compacted ways */
+
+ allow=(transports_t*)calloc(waysx->cnumber>0?waysx->cnumber:1,sizeof(transports_t));
+ labels=(index_t*)malloc((nodesx->number>0?nodesx->number:1)*sizeof(index_t));
+
+ assert(allow);  /* Check calloc() worked */
+ assert(labels); /* Check malloc() worked */
+
+ waysx->fd=ReOpenFile(waysx->filename);
+
+ for(i=0;i<waysx->number;i++)
+   {
+    WayX wayx;
+
+    ReadFile(waysx->fd,&wayx,sizeof(WayX));
+
+    allow[wayx.prop]=wayx.way.allow;
+   }
+
+ waysx->fd=CloseFile(waysx->fd);
+
+ /* Write out the header structure */
+
+ fd=OpenFileNew(filename);
+
+ componentsfile.number=nodesx->number;
+
+ WriteFile(fd,&componentsfile,sizeof(ComponentsFile));
+
+ /* Join the nodes at the ends of each segment for each transport in turn */
+
+ for(transport=Transport_None+1;transport<Transport_Count;transport++)
+   {
+    for(i=0;i<nodesx->number;i++)
+       labels[i]=i;
+
+    segmentsx->fd=ReOpenFile(segmentsx->filename);
+
+    for(i=0;i<segmentsx->number;i++)
+      {
+       SegmentX segmentx;
+       index_t label1,label2;
+
+       ReadFile(segmentsx->fd,&segmentx,sizeof(SegmentX));
+
+       if(!(segmentx.distance&SEGMENT_NORMAL))
+          continue;
+
+       if(!(allow[segmentx.way]&TRANSPORTS(transport)))
+          continue;
+
+       label1=find_component(labels,segmentx.node1);
+       label2=find_component(labels,segmentx.node2);
+
+       if(label1<label2)
+          labels[label2]=label1;
+       else if(label2<label1)
+          labels[label1]=label2;
+      }
+
+    segmentsx->fd=CloseFile(segmentsx->fd);
+
+    /* The label of each component is the lowest node index in it */
+
+    for(i=0;i<nodesx->number;i++)
+       labels[i]=labels[labels[i]];
+
+    WriteFile(fd,labels,nodesx->number*sizeof(index_t));
+
+    printf_middle("Writing Components: Transports=%d",transport);
+   }
+
+ /* Close the file */
+
+ CloseFile(fd);
+
+ /* Free the memory */
+
+ free(allow);
+ free(labels);
+
+ /* Print the final message */
+
+ printf_last("Wrote Components: Nodes=%"Pindex_t" Transports=%d",nodesx->number,Transport_Count-1);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the label of the connected component containing a node (shortening the path to it).
+
+  index_t find_component Returns the label of the component.
+
+  index_t *labels The current labels of the nodes.
+
+  index_t node The node to find the component of.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t find_component(index_t *labels,index_t node)
+{
+ while(labels[node]!=node)
+   {
+    labels[node]=labels[labels[node]];
+    node=labels[node];
+   }
+
+ return(node);
+}
@@ -89,6 +89,8 @@ void FreeNodeList(NodesX *nodesx,int keep);
 
 void SaveNodeList(NodesX *nodesx,const char *filename);
 
+void SaveComponentList(NodesX *nodesx,SegmentsX *segmentsx,WaysX *waysx,const char *filename);
+
 index_t IndexNodeX(NodesX *nodesx,node_t id);
 
 void AppendNode(NodesX *nodesx,node_t id,double latitude,double longitude,transports_t allow,uint16_t flags);
@@ -20,6 +20,7 @@
  ***************************************/
 
 
+#include <stdlib.h>
 #include <assert.h>
 
 #include "types.h"
@@ -27,6 +28,7 @@
 #include "segments.h"
 #include "ways.h"
 #include "relations.h"
+#include "contraction.h"
 
 #include "logging.h"
 #include "functions.h"
@@ -42,10 +44,49 @@ extern int option_quiet;
 /*+ The option to calculate the quickest route insted of the shortest. +*/
 extern int option_quickest;
 
+/*+ The option to search forwards and backwards at the same time. +*/
+extern int option_bidirectional;
+
+/*+ The option to direct the search towards the finish node. +*/
+extern int option_astar;
+
+
+/* Local types */
+
+/*+ The information needed to estimate the lowest possible score from any node to the finish node. +*/
+typedef struct _Estimate
+{
+ double     finish_lat;                 /*+ The latitude of the finish node. +*/
+ double     finish_lon;                 /*+ The longitude of the finish node. +*/
+
+ int        nlandmarks;                 /*+ The number of landmark distances (or 0 if there are none). +*/
+ distance_t landmarks[MAX_LANDMARKS];   /*+ The distance from each landmark to the finish node. +*/
+}
+ Estimate;
+
 
 /* Local functions */
 
+static Results *FindNormalRouteBidirectional(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t finish_node);
+static Results *FindMiddleRouteBidirectional(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Results *begin,Results *end);
+static Result *JoinBidirectionalRoute(Results *results,Result *forward,Result *backward,score_t score);
+
 static index_t FindSuperSegment(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t endnode,index_t endsegment);
+static Results *UnpackSuperSegment(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t supersegment);
+
+static Results *FindOneToManySearch(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t *finish_nodes,int nfinish,
+                                    Result **finish_results);
+
+static void InsertContractedEnd(Results *results,Queue *queue,Nodes *nodes,Ways *ways,Profile *profile,index_t node,int finish);
+static void UnpackContractedEdge(Contraction *contraction,index_t edge,index_t segment,score_t score,
+                                 index_t **route,score_t **scores,int *nroute,int *aroute);
+
+static void InitEstimate(Estimate *estimate,Nodes *nodes,index_t finish_node);
+static score_t EstimateScore(Estimate *estimate,Nodes *nodes,Profile *profile,index_t node);
+static int FindNodeLandmarks(Nodes *nodes,index_t node,distance_t *distances);
+
+static int sort_by_index(index_t *a,index_t *b);
+static int find_target(index_t *targets,int ntargets,index_t node);
 
 
 /*++++++++++++++++++++++++++++++++++++++
@@ -78,6 +119,10 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
  double  finish_lat,finish_lon;
  Result  *finish_result;
  Result  *result1,*result2;
+ Estimate estimate;
+
+ if(option_bidirectional && !IsFakeNode(start_node)) /* the fake segments between waypoints are only searched forwards */
+    return(FindNormalRouteBidirectional(nodes,segments,ways,relations,profile,start_node,prev_segment,finish_node));
 
  /* Set up the finish conditions */
 
@@ -89,6 +134,9 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
  else
     GetLatLong(nodes,finish_node,&finish_lat,&finish_lon);
 
+ if(option_astar)
+    InitEstimate(&estimate,nodes,finish_node);
+
  /* Create the list of results and insert the first node into the queue */
 
  results=NewResultsList(64);
@@ -111,6 +159,10 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
     index_t node1,seg1,seg1r;
     index_t turnrelation=NO_RELATION;
 
+    /* estimated score must be better than current best score (and so must all the rest in the queue) */
+    if(option_astar && result1->sortby>=finish_score)
+       break;
+
     /* score must be better than current best score */
     if(result1->score>finish_score)
        continue;
@@ -143,7 +195,6 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
        Way *way;
        index_t node2,seg2,seg2r;
        score_t segment_pref,segment_score,cumulative_score;
-       int i;
 
        node2=OtherNode(segment,node1); /* need this here because we use node2 at the end of the loop */
 
@@ -197,16 +248,7 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
           (way->length && way->length<profile->length))
           goto endloop;
 
-       segment_pref=profile->highway[HIGHWAY(way->type)];
-
-       for(i=1;i<Property_Count;i++)
-          if(ways->file.props & PROPERTIES(i))
-            {
-             if(way->props & PROPERTIES(i))
-                segment_pref*=profile->props_yes[i];
-             else
-                segment_pref*=profile->props_no[i];
-            }
+       segment_pref=WayPreference(profile,way);
 
        /* profile preferences must allow this highway */
        if(segment_pref==0)
@@ -219,7 +261,7 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
        if(option_quickest==0)
           segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
        else
-          segment_score=(score_t)Duration(segment,way,profile)/segment_pref;
+          segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
 
        cumulative_score=result1->score+segment_score;
 
@@ -245,9 +287,12 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
             }
           else
             {
-             result2->sortby=result2->score;
+             if(option_astar)
+                result2->sortby=result2->score+EstimateScore(&estimate,nodes,profile,node2);
+             else
+                result2->sortby=result2->score;
 
-             if(result2->score<finish_score)
+             if(result2->sortby<finish_score)
                 InsertInQueue(queue,result2);
             }
          }
@@ -267,9 +312,12 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
             }
           else
             {
-             result2->sortby=result2->score;
+             if(option_astar)
+                result2->sortby=result2->score+EstimateScore(&estimate,nodes,profile,node2);
+             else
+                result2->sortby=result2->score;
 
-             if(result2->score<finish_score)
+             if(result2->sortby<finish_score)
                 InsertInQueue(queue,result2);
             }
          }
@@ -307,9 +355,10 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Find the optimum route between two nodes where the start and end are a set of pre/post-routed super-nodes.
+  Find the optimum route between two nodes not passing through a super-node by
+  searching forwards from the start and backwards from the finish at the same time.
 
-  Results *FindMiddleRoute Returns a set of results.
+  Results *FindNormalRouteBidirectional Returns a set of results.
 
   Nodes *nodes The set of nodes to use.
 
@@ -321,315 +370,552 @@ Results *FindNormalRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
 
   Profile *profile The profile containing the transport type, speeds and allowed highways.
 
-  Results *begin The initial portion of the route.
+  index_t start_node The start node (must be a real node).
 
-  Results *end The final portion of the route.
+  index_t prev_segment The previous segment before the start node.
+
+  index_t finish_node The finish node.
   ++++++++++++++++++++++++++++++++++++++*/
 
-Results *FindMiddleRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Results *begin,Results *end)
+static Results *FindNormalRouteBidirectional(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t finish_node)
 {
- Results *results;
- Queue   *queue;
- Result  *finish_result;
+ Results *results,*backward;
+ Queue   *queue,*bqueue;
  score_t finish_score;
- double  finish_lat,finish_lon;
- Result  *result1,*result2,*result3,*result4;
-
- if(!option_quiet)
-    printf_first("Routing: Super-Nodes checked = 0");
+ Result  *finish_result,*finish_backward;
+ Result  *result1,*result2,*result3;
+ Segment *segment;
 
  /* Set up the finish conditions */
 
- finish_score=INF_DISTANCE;
+ finish_score=INF_SCORE;
  finish_result=NULL;
+ finish_backward=NULL;
 
- if(IsFakeNode(end->finish_node))
-    GetFakeLatLong(end->finish_node,&finish_lat,&finish_lon);
- else
-    GetLatLong(nodes,end->finish_node,&finish_lat,&finish_lon);
+ /* Create the list of forward results and insert the first node into the queue */
 
- /* Create the list of results and insert the first node into the queue */
+ results=NewResultsList(64);
 
- results=NewResultsList(65536);
+ results->start_node=start_node;
+ results->prev_segment=prev_segment;
 
- results->start_node=begin->start_node;
- results->prev_segment=begin->prev_segment;
+ result1=InsertResult(results,results->start_node,results->prev_segment);
 
- if(begin->number==1)
+ queue=NewQueueList();
+
+ InsertInQueue(queue,result1);
+
+ /* Create the list of backward results (the node and the segment used to arrive
+    at it with the score to the finish) and insert the finish node segments into the queue */
+
+ backward=NewResultsList(64);
+
+ backward->finish_node=finish_node;
+
+ bqueue=NewQueueList();
+
+ if(IsFakeNode(finish_node))
+    segment=FirstFakeSegment(finish_node);
+ else
+    segment=FirstSegment(segments,LookupNode(nodes,finish_node,1),1);
+
+ while(segment)
    {
-    if(begin->prev_segment==NO_SEGMENT)
-       results->prev_segment=NO_SEGMENT;
+    index_t seg;
+
+    if(IsFakeNode(finish_node))
+      {
+       if(!IsFakeNode(OtherNode(segment,finish_node))) /* the forward search can only arrive from a real node */
+         {
+          seg=IndexFakeSegment(segment);
+
+          if(!FindResult(backward,finish_node,seg))
+            {
+             result1=InsertResult(backward,finish_node,seg);
+
+             InsertInQueue(bqueue,result1);
+            }
+         }
+
+       segment=NextFakeSegment(segment,finish_node);
+      }
     else
       {
-       index_t superseg=FindSuperSegment(nodes,segments,ways,relations,profile,begin->start_node,begin->prev_segment);
+       seg=IndexSegment(segments,segment);
 
-       results->prev_segment=superseg;
+       result1=InsertResult(backward,finish_node,seg);
+
+       InsertInQueue(bqueue,result1);
+
+       segment=NextSegment(segments,segment,finish_node);
       }
    }
 
- result1=InsertResult(results,results->start_node,results->prev_segment);
+ /* Loop across the nodes in the queue that is the least advanced until the two searches can't find a better route */
 
- queue=NewQueueList();
+ while(1)
+   {
+    Result *top1=PeekAtQueue(queue);
+    Result *top2=PeekAtQueue(bqueue);
 
- /* Insert the finish points of the beginning part of the path into the queue,
-    translating the segments into super-segments. */
+    if(!top1 || !top2)
+       break;
 
- result3=FirstResult(begin);
+    if((top1->sortby+top2->sortby)>=finish_score)
+       break;
 
- while(result3)
-   {
-    if((results->start_node!=result3->node || results->prev_segment!=result3->segment) &&
-       !IsFakeNode(result3->node) && IsSuperNode(LookupNode(nodes,result3->node,5)))
+    if(top1->sortby<=top2->sortby) /* Forwards from the start node */
       {
-       Result *result5=result1;
-       index_t superseg=FindSuperSegment(nodes,segments,ways,relations,profile,result3->node,result3->segment);
+       Node *node1p=NULL;
+       index_t node1,seg1,seg1r;
+       index_t turnrelation=NO_RELATION;
 
-       if(superseg!=result3->segment)
-         {
-          result5=InsertResult(results,result3->node,result3->segment);
+       result1=PopFromQueue(queue);
 
-          result5->prev=result1;
-         }
+       /* score must be better than current best score */
+       if(result1->score>finish_score)
+          continue;
 
-       if(!FindResult(results,result3->node,superseg))
+       node1=result1->node;
+       seg1=result1->segment;
+
+       if(IsFakeSegment(seg1))
+          seg1r=IndexRealSegment(seg1);
+       else
+          seg1r=seg1;
+
+       if(!IsFakeNode(node1))
+          node1p=LookupNode(nodes,node1,1);
+
+       /* lookup if a turn restriction applies */
+       if(profile->turns && node1p && IsTurnRestrictedNode(node1p))
+          turnrelation=FindFirstTurnRelation2(relations,node1,seg1r);
+
+       /* Loop across all segments */
+
+       if(IsFakeNode(node1))
+          segment=FirstFakeSegment(node1);
+       else
+          segment=FirstSegment(segments,node1p,1);
+
+       while(segment)
          {
-          result2=InsertResult(results,result3->node,superseg);
-          result2->prev=result5;
+          Node *node2p=NULL;
+          Way *way;
+          index_t node2,seg2,seg2r;
+          score_t segment_pref,segment_score,cumulative_score;
 
-          result2->score=result3->score;
-          result2->sortby=result3->score;
+          node2=OtherNode(segment,node1); /* need this here because we use node2 at the end of the loop */
 
-          InsertInQueue(queue,result2);
+          /* must be a normal segment */
+          if(!IsNormalSegment(segment))
+             goto endloop;
 
-          if((result4=FindResult(end,result2->node,result2->segment)))
+          /* must obey one-way restrictions (unless profile allows) */
+          if(profile->oneway && IsOnewayTo(segment,node1))
+             goto endloop;
+
+          if(IsFakeNode(node1) || IsFakeNode(node2))
             {
-             if((result2->score+result4->score)<finish_score)
-               {
-                finish_score=result2->score+result4->score;
-                finish_result=result2;
-               }
+             seg2 =IndexFakeSegment(segment);
+             seg2r=IndexRealSegment(seg2);
+            }
+          else
+            {
+             seg2 =IndexSegment(segments,segment);
+             seg2r=seg2;
             }
-         }
-      }
 
-    result3=NextResult(begin,result3);
-   }
+          /* must not perform U-turn (unless profile allows) */
+          if(profile->turns && (seg1==seg2 || seg1==seg2r || seg1r==seg2 || (seg1r==seg2r && IsFakeUTurn(seg1,seg2))))
+             goto endloop;
 
- if(begin->number==1)
-    InsertInQueue(queue,result1);
+          /* must obey turn relations */
+          if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1r,seg2r,profile->allow))
+             goto endloop;
 
- /* Loop across all nodes in the queue */
+          if(!IsFakeNode(node2))
+             node2p=LookupNode(nodes,node2,2);
 
- while((result1=PopFromQueue(queue)))
-   {
-    Node *node1p;
-    Segment *segment;
-    index_t node1,seg1;
-    index_t turnrelation=NO_RELATION;
+          /* must not pass over super-node */
+          if(node2!=finish_node && node2p && IsSuperNode(node2p))
+             goto endloop;
 
-    /* score must be better than current best score */
-    if(result1->score>finish_score)
-       continue;
+          way=LookupWay(ways,segment->way,1);
 
-    node1=result1->node;
-    seg1=result1->segment;
+          /* mode of transport must be allowed on the highway */
+          if(!(way->allow&profile->allow))
+             goto endloop;
 
-    node1p=LookupNode(nodes,node1,1); /* node1 cannot be a fake node (must be a super-node) */
+          /* must obey weight restriction (if exists) */
+          if(way->weight && way->weight<profile->weight)
+             goto endloop;
 
-    /* lookup if a turn restriction applies */
-    if(profile->turns && IsTurnRestrictedNode(node1p)) /* node1 cannot be a fake node (must be a super-node) */
-       turnrelation=FindFirstTurnRelation2(relations,node1,seg1);
+          /* must obey height/width/length restriction (if exists) */
+          if((way->height && way->height<profile->height) ||
+             (way->width  && way->width <profile->width ) ||
+             (way->length && way->length<profile->length))
+             goto endloop;
 
-    /* Loop across all segments */
+          segment_pref=WayPreference(profile,way);
 
-    segment=FirstSegment(segments,node1p,1); /* node1 cannot be a fake node (must be a super-node) */
+          /* profile preferences must allow this highway */
+          if(segment_pref==0)
+             goto endloop;
 
-    while(segment)
+          /* mode of transport must be allowed through node2 */
+          if(node2p && !(node2p->allow&profile->allow))
+             goto endloop;
+
+          if(option_quickest==0)
+             segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+          else
+             segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+          cumulative_score=result1->score+segment_score;
+
+          /* score must be better than current best score */
+          if(cumulative_score>finish_score)
+             goto endloop;
+
+          result2=FindResult(results,node2,seg2);
+
+          if(!result2) /* New end node/segment combination */
+            {
+             result2=InsertResult(results,node2,seg2);
+             result2->prev=result1;
+             result2->score=cumulative_score;
+            }
+          else if(cumulative_score<result2->score) /* New score for end node/segment combination is better */
+            {
+             result2->prev=result1;
+             result2->score=cumulative_score;
+            }
+          else
+             goto endloop;
+
+          if(node2==finish_node)
+            {
+             if(cumulative_score<finish_score)
+               {
+                finish_score=cumulative_score;
+                finish_result=result2;
+                finish_backward=NULL;
+               }
+            }
+          else
+            {
+             /* check if the backward search has already been here */
+             if((result3=FindResult(backward,node2,seg2)) && (result2->score+result3->score)<finish_score)
+               {
+                finish_score=result2->score+result3->score;
+                finish_result=result2;
+                finish_backward=result3->next;
+               }
+
+             result2->sortby=result2->score;
+
+             if(result2->score<finish_score)
+                InsertInQueue(queue,result2);
+            }
+
+         endloop:
+
+          if(IsFakeNode(node1))
+             segment=NextFakeSegment(segment,node1);
+          else if(IsFakeNode(node2))
+             segment=NULL; /* cannot call NextSegment() with a fake segment */
+          else
+            {
+             segment=NextSegment(segments,segment,node1);
+
+             if(!segment && IsFakeNode(finish_node))
+                segment=ExtraFakeSegment(node1,finish_node);
+            }
+         }
+      }
+    else /* Backwards from the finish node */
       {
-       Node *node2p;
+       Node *node1p=NULL,*node2p;
        Way *way;
-       index_t node2,seg2;
+       index_t node1,node2,seg1,seg1r;
        score_t segment_pref,segment_score,cumulative_score;
-       int i;
+       int turns,extra;
 
-       /* must be a super segment */
-       if(!IsSuperSegment(segment))
-          goto endloop;
+       result1=PopFromQueue(bqueue);
 
-       /* must obey one-way restrictions (unless profile allows) */
-       if(profile->oneway && IsOnewayTo(segment,node1))
-          goto endloop;
+       /* score must be better than current best score */
+       if(result1->score>finish_score)
+          continue;
+
+       node1=result1->node;
+       seg1=result1->segment;
+
+       if(IsFakeSegment(seg1))
+         {
+          segment=LookupFakeSegment(seg1);
+          seg1r=IndexRealSegment(seg1);
+         }
+       else
+         {
+          segment=LookupSegment(segments,seg1,2);
+          seg1r=seg1;
+         }
 
        node2=OtherNode(segment,node1);
 
-       seg2=IndexSegment(segments,segment); /* node2 cannot be a fake node (must be a super-node) */
+       /* The segment from node2 to node1 is checked in the same way as the forward search */
 
-       /* must not perform U-turn */
-       if(seg1==seg2) /* No fake segments, applies to all profiles */
-          goto endloop;
+       /* must be a normal segment */
+       if(!IsNormalSegment(segment))
+          continue;
 
-       /* must obey turn relations */
-       if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1,seg2,profile->allow))
-          goto endloop;
+       /* must obey one-way restrictions (unless profile allows) */
+       if(profile->oneway && IsOnewayFrom(segment,node1)) /* Disallow oneway from node2 *to* node1 */
+          continue;
+
+       if(!IsFakeNode(node1))
+          node1p=LookupNode(nodes,node1,1);
+
+       /* must not pass over super-node */
+       if(node1!=finish_node && node1p && IsSuperNode(node1p))
+          continue;
 
        way=LookupWay(ways,segment->way,1);
 
-       /* transport must be allowed on the highway */
+       /* mode of transport must be allowed on the highway */
        if(!(way->allow&profile->allow))
-          goto endloop;
+          continue;
 
        /* must obey weight restriction (if exists) */
        if(way->weight && way->weight<profile->weight)
-          goto endloop;
+          continue;
 
        /* must obey height/width/length restriction (if exists) */
        if((way->height && way->height<profile->height) ||
           (way->width  && way->width <profile->width ) ||
           (way->length && way->length<profile->length))
-          goto endloop;
+          continue;
 
-       segment_pref=profile->highway[HIGHWAY(way->type)];
-
-       for(i=1;i<Property_Count;i++)
-          if(ways->file.props & PROPERTIES(i))
-            {
-             if(way->props & PROPERTIES(i))
-                segment_pref*=profile->props_yes[i];
-             else
-                segment_pref*=profile->props_no[i];
-            }
+       segment_pref=WayPreference(profile,way);
 
        /* profile preferences must allow this highway */
        if(segment_pref==0)
-          goto endloop;
-
-       node2p=LookupNode(nodes,node2,2); /* node2 cannot be a fake node (must be a super-node) */
+          continue;
 
-       /* mode of transport must be allowed through node2 */
-       if(!(node2p->allow&profile->allow))
-          goto endloop;
+       /* mode of transport must be allowed through node1 */
+       if(node1p && !(node1p->allow&profile->allow))
+          continue;
 
        if(option_quickest==0)
           segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
        else
-          segment_score=(score_t)Duration(segment,way,profile)/segment_pref;
+          segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
 
        cumulative_score=result1->score+segment_score;
 
        /* score must be better than current best score */
        if(cumulative_score>finish_score)
-          goto endloop;
+          continue;
 
-       result2=FindResult(results,node2,seg2);
+       /* The forward search can only reach node2 if it is a real node, not the
+          finish node and not a super-node (unless it is the start node) */
 
-       if(!result2) /* New end node/segment pair */
-         {
-          result2=InsertResult(results,node2,seg2);
-          result2->prev=result1;
-          result2->score=cumulative_score;
+       if(IsFakeNode(node2) || node2==finish_node)
+          continue;
 
-          if((result3=FindResult(end,node2,seg2)))
-            {
-             if((result2->score+result3->score)<finish_score)
-               {
-                finish_score=result2->score+result3->score;
-                finish_result=result2;
-               }
-            }
-          else
-            {
-             double lat,lon;
-             distance_t direct;
+       node2p=LookupNode(nodes,node2,2);
 
-             GetLatLong(nodes,node2,&lat,&lon); /* node2 cannot be a fake node (must be a super-node) */
+       if(node2!=start_node && IsSuperNode(node2p))
+          continue;
 
-             direct=Distance(lat,lon,finish_lat,finish_lon);
+       turns=(profile->turns && IsTurnRestrictedNode(node2p));
 
-             if(option_quickest==0)
-                result2->sortby=result2->score+(score_t)direct/profile->max_pref;
-             else
-                result2->sortby=result2->score+(score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref;
+       /* Loop across all segments that the forward search could have used to arrive at node2
+          (and the previous segment at the start node if it is not one of them) */
 
-             if(result2->sortby<finish_score)
-                InsertInQueue(queue,result2);
-            }
-         }
-       else if(cumulative_score<result2->score) /* New end node/segment pair is better */
+       if(IsSuperNode(node2p))
+          segment=NULL;
+       else
+          segment=FirstSegment(segments,node2p,1);
+
+       extra=(node2==start_node && (!segment || prev_segment==NO_SEGMENT || IsFakeSegment(prev_segment)));
+
+       while(segment || extra)
          {
-          result2->prev=result1;
-          result2->score=cumulative_score;
+          index_t seg2,seg2r;
 
-          if((result3=FindResult(end,node2,seg2)))
+          /* must be a normal segment (or the previous segment at the start node) */
+          if(segment && !IsNormalSegment(segment) && !(node2==start_node && IndexSegment(segments,segment)==prev_segment))
+             goto endloop2;
+
+          if(segment)
+             seg2=IndexSegment(segments,segment);
+          else
             {
-             if((result2->score+result3->score)<finish_score)
-               {
-                finish_score=result2->score+result3->score;
-                finish_result=result2;
-               }
+             seg2=prev_segment;
+             extra=0;
             }
-          else if(result2->score<finish_score)
+
+          if(IsFakeSegment(seg2))
+             seg2r=IndexRealSegment(seg2);
+          else
+             seg2r=seg2;
+
+          /* must not perform U-turn (unless profile allows) */
+          if(profile->turns && (seg1==seg2 || seg1==seg2r || seg1r==seg2 || (seg1r==seg2r && IsFakeUTurn(seg1,seg2))))
+             goto endloop2;
+
+          /* must obey turn relations */
+          if(turns)
             {
-             double lat,lon;
-             distance_t direct;
+             index_t turnrelation=FindFirstTurnRelation2(relations,node2,seg2r); /* seg2 -> node2 -> seg1 */
 
-             GetLatLong(nodes,node2,&lat,&lon); /* node2 cannot be a fake node (must be a super-node) */
+             if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node2,seg2r,seg1r,profile->allow))
+                goto endloop2;
+            }
 
-             direct=Distance(lat,lon,finish_lat,finish_lon);
+          result2=FindResult(backward,node2,seg2);
 
-             if(option_quickest==0)
-                result2->sortby=result2->score+(score_t)direct/profile->max_pref;
-             else
-                result2->sortby=result2->score+(score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref;
+          if(!result2) /* New end node/segment combination */
+            {
+             result2=InsertResult(backward,node2,seg2);
+             result2->next=result1;   /* working backwards */
+             result2->score=cumulative_score;
+            }
+          else if(cumulative_score<result2->score) /* New score for end node/segment combination is better */
+            {
+             result2->next=result1;   /* working backwards */
+             result2->score=cumulative_score;
+            }
+          else
+             goto endloop2;
 
-             if(result2->sortby<finish_score)
-                InsertInQueue(queue,result2);
+          /* check if the forward search has already been here */
+          if((result3=FindResult(results,node2,seg2)) && (result3->score+result2->score)<finish_score)
+            {
+             finish_score=result3->score+result2->score;
+             finish_result=result3;
+             finish_backward=result1;
             }
-         }
 
-       if(!option_quiet && !(results->number%1000))
-          printf_middle("Routing: Super-Nodes checked = %d",results->number);
+          result2->sortby=result2->score;
 
-      endloop:
+          if(result2->score<finish_score)
+             InsertInQueue(bqueue,result2);
 
-       segment=NextSegment(segments,segment,node1); /* node1 cannot be a fake node (must be a super-node) */
+         endloop2:
+
+          if(segment)
+             segment=NextSegment(segments,segment,node2);
+         }
       }
    }
 
- if(!option_quiet)
-    printf_last("Routing: Super-Nodes checked = %d",results->number);
-
  FreeQueueList(queue);
+ FreeQueueList(bqueue);
 
  /* Check it worked */
 
  if(!finish_result)
    {
     FreeResultsList(results);
+    FreeResultsList(backward);
     return(NULL);
    }
 
- /* Finish off the end part of the route */
+ finish_result=JoinBidirectionalRoute(results,finish_result,finish_backward,finish_score);
 
- if(finish_result->node!=end->finish_node)
+ FreeResultsList(backward);
+
+ FixForwardRoute(results,finish_result);
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the optimum routes from one node to each of a set of nodes using a single search
+  (which is allowed to pass through super-nodes) that stops when all of them have been reached.
+
+  Results **FindOneToManyRoutes Returns an array of results (one for each finish node, NULL if no route was found).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  index_t start_node The start node.
+
+  index_t prev_segment The previous segment before the start node.
+
+  index_t *finish_nodes The finish nodes (NO_NODE entries are ignored).
+
+  int nfinish The number of finish nodes.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Results **FindOneToManyRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t *finish_nodes,int nfinish)
+{
+ Results **routes;
+ Results *results;
+ Result **finish_results;
+ int      i;
+
+ routes=(Results**)calloc(nfinish,sizeof(Results*));
+ finish_results=(Result**)calloc(nfinish,sizeof(Result*));
+
+ results=FindOneToManySearch(nodes,segments,ways,relations,profile,start_node,prev_segment,finish_nodes,nfinish,finish_results);
+
+ /* Copy the route to each of the finish nodes into its own set of results */
+
+ for(i=0;i<nfinish;i++)
    {
-    result3=InsertResult(results,end->finish_node,NO_SEGMENT);
+    Result *finish_result=NULL,*result1,*result2=NULL;
 
-    result3->prev=finish_result;
-    result3->score=finish_score;
+    if(!finish_results[i])
+       continue;
 
-    finish_result=result3;
+    routes[i]=NewResultsList(8);
+
+    routes[i]->start_node=start_node;
+    routes[i]->prev_segment=prev_segment;
+
+    for(result1=finish_results[i];result1;result1=result1->prev)
+      {
+       Result *copy=InsertResult(routes[i],result1->node,result1->segment);
+
+       copy->score=result1->score;
+       copy->sortby=result1->sortby;
+
+       if(result2)
+          result2->prev=copy;
+       else
+          finish_result=copy;
+
+       result2=copy;
+      }
+
+    FixForwardRoute(routes[i],finish_result);
    }
 
- FixForwardRoute(results,finish_result);
+ FreeResultsList(results);
 
- return(results);
+ free(finish_results);
+
+ return(routes);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Find the super-segment that represents the route that contains a particular segment.
+  Find the distance and duration of the optimum routes from one node to each of a set of nodes
+  using a single search without creating the routes themselves.
 
-  index_t FindSuperSegment Returns the index of the super-segment.
+  int FindOneToManyCosts Returns the number of finish nodes for which a route was found.
 
   Nodes *nodes The set of nodes to use.
 
@@ -641,60 +927,85 @@ Results *FindMiddleRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
 
   Profile *profile The profile containing the transport type, speeds and allowed highways.
 
-  index_t endnode The super-node that the route ends at.
+  index_t start_node The start node.
 
-  index_t endsegment The segment that the route ends with.
+  index_t prev_segment The previous segment before the start node.
+
+  index_t *finish_nodes The finish nodes (NO_NODE entries are ignored).
+
+  int nfinish The number of finish nodes.
+
+  distance_t *distances Returns the distance to each finish node (or INF_DISTANCE if no route was found).
+
+  duration_t *durations Returns the duration to each finish node (or INF_DISTANCE if no route was found).
   ++++++++++++++++++++++++++++++++++++++*/
 
-static index_t FindSuperSegment(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t endnode,index_t endsegment)
+int FindOneToManyCosts(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t *finish_nodes,int nfinish,
+                       distance_t *distances,duration_t *durations)
 {
- Node *node=LookupNode(nodes,endnode,5); /* endnode cannot be a fake node (must be a super-node) */
- Segment *segment;
+ Results *results;
+ Result **finish_results;
+ int      i,nfound=0;
 
- if(IsFakeSegment(endsegment))
-    endsegment=IndexRealSegment(endsegment);
+ finish_results=(Result**)calloc(nfinish,sizeof(Result*));
 
- segment=LookupSegment(segments,endsegment,2);
+ results=FindOneToManySearch(nodes,segments,ways,relations,profile,start_node,prev_segment,finish_nodes,nfinish,finish_results);
 
- if(IsSuperSegment(segment))
-    return(endsegment);
+ /* Add up the segments back along the route to each of the finish nodes */
 
- /* Loop across all segments */
+ for(i=0;i<nfinish;i++)
+   {
+    Result *result;
 
- segment=FirstSegment(segments,node,3); /* endnode cannot be a fake node (must be a super-node) */
+    if(finish_nodes[i]!=NO_NODE && finish_nodes[i]==start_node)
+      {
+       distances[i]=0;
+       durations[i]=0;
+       nfound++;
+       continue;
+      }
 
- while(segment)
-   {
-    if(IsSuperSegment(segment))
+    if(!finish_results[i])
       {
-       Results *results;
-       index_t startnode;
+       distances[i]=INF_DISTANCE;
+       durations[i]=INF_DISTANCE;
+       continue;
+      }
 
-       startnode=OtherNode(segment,endnode);
+    distances[i]=0;
+    durations[i]=0;
 
-       results=FindNormalRoute(nodes,segments,ways,relations,profile,startnode,NO_SEGMENT,endnode);
+    for(result=finish_results[i];result->prev;result=result->prev)
+      {
+       Segment *segment;
+       Way *way;
 
-       if(results && results->last_segment==endsegment)
-         {
-          FreeResultsList(results);
-          return(IndexSegment(segments,segment));
-         }
+       if(IsFakeSegment(result->segment))
+          segment=LookupFakeSegment(result->segment);
+       else
+          segment=LookupSegment(segments,result->segment,1);
 
-       if(results)
-          FreeResultsList(results);
+       way=LookupWay(ways,segment->way,1);
+
+       distances[i]+=DISTANCE(segment->distance);
+       durations[i]+=Duration(segment,way,profile);
       }
 
-    segment=NextSegment(segments,segment,endnode); /* endnode cannot be a fake node (must be a super-node) */
+    nfound++;
    }
 
- return(endsegment);
+ FreeResultsList(results);
+
+ free(finish_results);
+
+ return(nfound);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Find all routes from a specified node to any super-node.
+  Perform a single search from one node that stops when all of a set of nodes have been reached.
 
-  Results *FindStartRoutes Returns a set of results.
+  Results *FindOneToManySearch Returns the set of results for the whole search.
 
   Nodes *nodes The set of nodes to use.
 
@@ -710,19 +1021,42 @@ static index_t FindSuperSegment(Nodes *nodes,Segments *segments,Ways *ways,Relat
 
   index_t prev_segment The previous segment before the start node.
 
-  index_t finish_node The finish node.
+  index_t *finish_nodes The finish nodes (NO_NODE entries are ignored).
 
-  int *nsuper Returns the number of super-nodes seen.
+  int nfinish The number of finish nodes.
+
+  Result **finish_results Returns the best result for each of the finish nodes (or NULL if it was not reached).
   ++++++++++++++++++++++++++++++++++++++*/
 
-Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t finish_node,int *nsuper)
+static Results *FindOneToManySearch(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t *finish_nodes,int nfinish,
+                                    Result **finish_results)
 {
  Results *results;
  Queue   *queue;
+ index_t *targets;
+ Result **target_results;
+ int      ntargets=0,nfound=0;
  Result  *result1,*result2;
- int     found_finish=0;
+ int      i,j;
 
- /* Create the results and insert the start node */
+ /* Set up the finish conditions, a sorted list of the distinct finish nodes */
+
+ targets=(index_t*)malloc(nfinish*sizeof(index_t));
+ target_results=(Result**)calloc(nfinish,sizeof(Result*));
+
+ for(i=0;i<nfinish;i++)
+    if(finish_nodes[i]!=NO_NODE && finish_nodes[i]!=start_node)
+       targets[ntargets++]=finish_nodes[i];
+
+ qsort(targets,ntargets,sizeof(index_t),(int (*)(const void*,const void*))sort_by_index);
+
+ for(i=0,j=0;i<ntargets;i++)
+    if(j==0 || targets[i]!=targets[j-1])
+       targets[j++]=targets[i];
+
+ ntargets=j;
+
+ /* Create the list of results and insert the first node into the queue */
 
  results=NewResultsList(64);
 
@@ -731,24 +1065,36 @@ Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
 
  result1=InsertResult(results,results->start_node,results->prev_segment);
 
- /* Insert the first node into the queue */
-
  queue=NewQueueList();
 
  InsertInQueue(queue,result1);
 
- /* Loop across all nodes in the queue */
+ /* Loop across all nodes in the queue until all finish nodes have been reached */
 
- while((result1=PopFromQueue(queue)))
+ while(nfound<ntargets && (result1=PopFromQueue(queue)))
    {
     Node *node1p=NULL;
     Segment *segment;
     index_t node1,seg1,seg1r;
     index_t turnrelation=NO_RELATION;
+    int extra=0;
 
     node1=result1->node;
     seg1=result1->segment;
 
+    /* the first result popped for a finish node is the best one */
+    i=find_target(targets,ntargets,node1);
+
+    if(i>=0 && !target_results[i])
+      {
+       target_results[i]=result1;
+       nfound++;
+      }
+
+    /* fake finish nodes are only reached, not passed through */
+    if(IsFakeNode(node1) && node1!=start_node)
+       continue;
+
     if(IsFakeSegment(seg1))
        seg1r=IndexRealSegment(seg1);
     else
@@ -774,7 +1120,6 @@ Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
        Way *way;
        index_t node2,seg2,seg2r;
        score_t segment_pref,segment_score,cumulative_score;
-       int i;
 
        node2=OtherNode(segment,node1); /* need this here because we use node2 at the end of the loop */
 
@@ -805,6 +1150,9 @@ Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
        if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1r,seg2r,profile->allow))
           goto endloop;
 
+       if(!IsFakeNode(node2))
+          node2p=LookupNode(nodes,node2,2);
+
        way=LookupWay(ways,segment->way,1);
 
        /* mode of transport must be allowed on the highway */
@@ -821,24 +1169,12 @@ Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
           (way->length && way->length<profile->length))
           goto endloop;
 
-       segment_pref=profile->highway[HIGHWAY(way->type)];
-
-       for(i=1;i<Property_Count;i++)
-          if(ways->file.props & PROPERTIES(i))
-            {
-             if(way->props & PROPERTIES(i))
-                segment_pref*=profile->props_yes[i];
-             else
-                segment_pref*=profile->props_no[i];
-            }
+       segment_pref=WayPreference(profile,way);
 
        /* profile preferences must allow this highway */
        if(segment_pref==0)
           goto endloop;
 
-       if(!IsFakeNode(node2))
-          node2p=LookupNode(nodes,node2,2);
-
        /* mode of transport must be allowed through node2 */
        if(node2p && !(node2p->allow&profile->allow))
           goto endloop;
@@ -846,7 +1182,7 @@ Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
        if(option_quickest==0)
           segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
        else
-          segment_score=(score_t)Duration(segment,way,profile)/segment_pref;
+          segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
 
        cumulative_score=result1->score+segment_score;
 
@@ -857,65 +1193,69 @@ Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
           result2=InsertResult(results,node2,seg2);
           result2->prev=result1;
           result2->score=cumulative_score;
+          result2->sortby=result2->score;
 
-          if(node2p && IsSuperNode(node2p))
-             (*nsuper)++;
-
-          if(node2p && !IsSuperNode(node2p))
-            {
-             result2->sortby=result2->score;
-             InsertInQueue(queue,result2);
-            }
-
-          if(node2==finish_node)
-             found_finish=1;
+          InsertInQueue(queue,result2);
          }
-       else if(cumulative_score<result2->score) /* New end node/segment combination is better */
+       else if(cumulative_score<result2->score) /* New score for end node/segment combination is better */
          {
           result2->prev=result1;
           result2->score=cumulative_score;
+          result2->segment=seg2;
+          result2->sortby=result2->score;
 
-          if(node2p && !IsSuperNode(node2p))
-            {
-             result2->sortby=result2->score;
-             InsertInQueue(queue,result2);
-            }
+          InsertInQueue(queue,result2);
          }
 
       endloop:
 
        if(IsFakeNode(node1))
           segment=NextFakeSegment(segment,node1);
-       else if(IsFakeNode(node2))
-          segment=NULL; /* cannot call NextSegment() with a fake segment */
        else
          {
-          segment=NextSegment(segments,segment,node1);
+          if(IsFakeNode(node2))
+             segment=NULL; /* cannot call NextSegment() with a fake segment */
+          else
+             segment=NextSegment(segments,segment,node1);
 
-          if(!segment && IsFakeNode(finish_node))
-             segment=ExtraFakeSegment(node1,finish_node);
+          /* the fake segments to reach the finish nodes are not part of the real node's list */
+          while(!segment && extra<ntargets)
+             if(IsFakeNode(targets[extra]))
+                segment=ExtraFakeSegment(node1,targets[extra++]);
+             else
+                extra++;
          }
       }
    }
 
  FreeQueueList(queue);
 
- /* Check it worked */
+ /* Match the results to the finish nodes */
 
- if(results->number==1 || (*nsuper==0 && found_finish==0))
+ for(i=0;i<nfinish;i++)
    {
-    FreeResultsList(results);
-    return(NULL);
+    j=find_target(targets,ntargets,finish_nodes[i]);
+
+    if(j<0)
+       finish_results[i]=NULL;
+    else
+       finish_results[i]=target_results[j];
    }
 
+ free(target_results);
+ free(targets);
+
  return(results);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Find all routes from any super-node to a specific node (by working backwards from the specific node to all super-nodes).
+  Find the optimum route between two nodes using a contraction hierarchy (searching upwards
+  from both ends at the same time) and then check that the unpacked route obeys the rules
+  that the contraction hierarchy does not contain (turn relations and U-turns).
 
-  Results *FindFinishRoutes Returns a set of results.
+  Results *FindContractedRoute Returns a set of results or NULL if there is no route or it does
+  not obey the rules (the other route finding functions must be used instead).
 
   Nodes *nodes The set of nodes to use.
 
@@ -927,37 +1267,170 @@ Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *r
 
   Profile *profile The profile containing the transport type, speeds and allowed highways.
 
-  index_t finish_node The finishing node.
-  ++++++++++++++++++++++++++++++++++++++*/
+  Contraction *contraction The contraction hierarchy that was created for this profile.
 
-Results *FindFinishRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t finish_node)
-{
- Results *results,*results2;
- Queue   *queue;
- Result  *result1,*result2,*result3;
+  index_t start_node The start node.
 
- /* Create the results and insert the finish node */
+  index_t prev_segment The previous segment before the start node.
 
- results=NewResultsList(64);
+  index_t finish_node The finish node.
+  ++++++++++++++++++++++++++++++++++++++*/
 
- results->finish_node=finish_node;
+Results *FindContractedRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Contraction *contraction,
+                             index_t start_node,index_t prev_segment,index_t finish_node)
+{
+ Results *forward,*backward,*results=NULL;
+ Queue   *forward_queue,*backward_queue;
+ score_t  finish_score=INF_SCORE;
+ Result  *forward_result=NULL,*backward_result=NULL;
+ Result  *result1,*result2;
+ index_t *route=NULL,*edges=NULL;
+ score_t *scores=NULL;
+ int      nroute=0,aroute=0,nedges=0,i;
 
- result1=InsertResult(results,finish_node,NO_SEGMENT);
+ /* Waypoints within the same segment are joined by a fake segment that is not in the hierarchy */
 
- /* Insert the first node into the queue */
+ if(IsFakeSameSegment(start_node,finish_node))
+    return(NULL);
 
- queue=NewQueueList();
+ /* Create the lists of results and insert the nodes at each end into the queues */
 
- InsertInQueue(queue,result1);
+ forward=NewResultsList(64);
+ backward=NewResultsList(64);
 
- /* Loop across all nodes in the queue */
+ forward_queue=NewQueueList();
+ backward_queue=NewQueueList();
 
- while((result1=PopFromQueue(queue)))
+ InsertContractedEnd(forward,forward_queue,nodes,ways,profile,start_node,0);
+ InsertContractedEnd(backward,backward_queue,nodes,ways,profile,finish_node,1);
+
+ /* Loop across the nodes in the two queues (the one with the lowest score each time) until
+    neither can improve on the best route found so far */
+
+ while(1)
+   {
+    Result *forward_top=PeekAtQueue(forward_queue);
+    Result *backward_top=PeekAtQueue(backward_queue);
+    Results *search,*opposite;
+    Queue *queue;
+    index_t edge,lastedge;
+    int upwards;
+
+    if(forward_top && forward_top->sortby>=finish_score)
+       forward_top=NULL;
+
+    if(backward_top && backward_top->sortby>=finish_score)
+       backward_top=NULL;
+
+    if(!forward_top && !backward_top)
+       break;
+
+    if(forward_top && (!backward_top || forward_top->sortby<=backward_top->sortby))
+      {
+       search=forward; opposite=backward; queue=forward_queue; upwards=1;
+      }
+    else
+      {
+       search=backward; opposite=forward; queue=backward_queue; upwards=0;
+      }
+
+    result1=PopFromQueue(queue);
+
+    /* check if the other search has reached this node */
+
+    result2=FindResult1(opposite,result1->node);
+
+    if(result2 && (result1->score+result2->score)<finish_score)
+      {
+       finish_score=result1->score+result2->score;
+
+       forward_result =upwards?result1:result2;
+       backward_result=upwards?result2:result1;
+      }
+
+    /* Loop across the edges that go upwards from this node (forwards) or come downwards to it (backwards) */
+
+    if(upwards)
+      {
+       edge    =FirstUpwardEdge(contraction,result1->node);
+       lastedge=FirstUpwardEdge(contraction,result1->node+1);
+      }
+    else
+      {
+       edge    =FirstDownwardEdge(contraction,result1->node);
+       lastedge=FirstDownwardEdge(contraction,result1->node+1);
+      }
+
+    for(;edge<lastedge;edge++)
+      {
+       ContractionEdge edgestore,*edgep=LookupContractionEdge(contraction,edge,&edgestore);
+       score_t cumulative_score=result1->score+edgep->score;
+
+       if(cumulative_score>=finish_score)
+          continue;
+
+       result2=FindResult1(search,edgep->node);
+
+       if(!result2)
+         {
+          result2=InsertResult(search,edgep->node,edge);
+          result2->prev=result1;
+          result2->score=cumulative_score;
+          result2->sortby=cumulative_score;
+
+          InsertInQueue(queue,result2);
+         }
+       else if(cumulative_score<result2->score)
+         {
+          result2->prev=result1;
+          result2->score=cumulative_score;
+          result2->sortby=cumulative_score;
+          result2->segment=edge;
+
+          InsertInQueue(queue,result2);
+         }
+      }
+   }
+
+ FreeQueueList(forward_queue);
+ FreeQueueList(backward_queue);
+
+ if(!forward_result)
+    goto finished;
+
+ /* Unpack the edges into a list of segments from the start to the finish */
+
+ for(result1=forward_result;result1->prev;result1=result1->prev)
+   {
+    edges=(index_t*)realloc((void*)edges,(nedges+1)*sizeof(index_t));
+    edges[nedges++]=result1->segment;
+   }
+
+ if(result1->segment!=NO_SEGMENT) /* the fake segment from the start */
+    UnpackContractedEdge(contraction,NO_SEGMENT,result1->segment,result1->score,&route,&scores,&nroute,&aroute);
+
+ while(nedges>0)
+    UnpackContractedEdge(contraction,edges[--nedges],NO_SEGMENT,0,&route,&scores,&nroute,&aroute);
+
+ for(result1=backward_result;result1->prev;result1=result1->prev)
+    UnpackContractedEdge(contraction,result1->segment,NO_SEGMENT,0,&route,&scores,&nroute,&aroute);
+
+ if(result1->segment!=NO_SEGMENT) /* the fake segment to the finish */
+    UnpackContractedEdge(contraction,NO_SEGMENT,result1->segment,result1->score,&route,&scores,&nroute,&aroute);
+
+ /* Create the results following the list of segments and check the rules at each node */
+
+ results=NewResultsList(64);
+
+ results->start_node=start_node;
+ results->prev_segment=prev_segment;
+
+ result1=InsertResult(results,results->start_node,results->prev_segment);
+
+ for(i=0;i<nroute;i++)
    {
-    Node *node1p=NULL;
     Segment *segment;
-    index_t node1,seg1,seg1r;
-    index_t turnrelation=NO_RELATION;
+    index_t node1,node2,seg1,seg1r,seg2,seg2r;
 
     node1=result1->node;
     seg1=result1->segment;
@@ -967,375 +1440,2245 @@ Results *FindFinishRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *
     else
        seg1r=seg1;
 
-    if(!IsFakeNode(node1))
-       node1p=LookupNode(nodes,node1,1);
+    seg2=route[i];
 
-    /* lookup if a turn restriction applies */
-    if(profile->turns && node1p && IsTurnRestrictedNode(node1p))
-       turnrelation=FindFirstTurnRelation1(relations,node1); /* working backwards => turn relation sort order doesn't help */
+    if(IsFakeSegment(seg2))
+      {
+       segment=LookupFakeSegment(seg2);
+       seg2r=IndexRealSegment(seg2);
+      }
+    else
+      {
+       segment=LookupSegment(segments,seg2,1);
+       seg2r=seg2;
+      }
 
-    /* Loop across all segments */
+    node2=OtherNode(segment,node1);
 
-    if(IsFakeNode(node1))
-       segment=FirstFakeSegment(node1);
-    else
-       segment=FirstSegment(segments,node1p,1);
+    /* must not perform U-turn (unless profile allows) */
+    if(profile->turns && (seg1==seg2 || seg1==seg2r || seg1r==seg2 || (seg1r==seg2r && IsFakeUTurn(seg1,seg2))))
+       break;
 
-    while(segment)
+    /* must obey turn relations */
+    if(profile->turns && !IsFakeNode(node1) && IsTurnRestrictedNode(LookupNode(nodes,node1,1)))
       {
-       Node *node2p=NULL;
-       Way *way;
-       index_t node2,seg2,seg2r;
-       score_t segment_pref,segment_score,cumulative_score;
-       int i;
+       index_t turnrelation=FindFirstTurnRelation2(relations,node1,seg1r);
 
-       /* must be a normal segment */
-       if((IsFakeNode(node1) || !IsSuperNode(node1p)) && !IsNormalSegment(segment))
-          goto endloop;
+       if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1r,seg2r,profile->allow))
+          break;
+      }
 
-       /* must obey one-way restrictions (unless profile allows) */
-       if(profile->oneway && IsOnewayFrom(segment,node1)) /* Disallow oneway from node2 *to* node1 */
-          goto endloop;
+    /* must not visit the same node and segment twice */
+    if(FindResult(results,node2,seg2))
+       break;
 
-       node2=OtherNode(segment,node1);
+    result2=InsertResult(results,node2,seg2);
+    result2->prev=result1;
+    result2->score=result1->score+scores[i];
 
-       if(IsFakeNode(node1) || IsFakeNode(node2))
+    result1=result2;
+   }
+
+ if(i<nroute || result1->node!=finish_node)
+   {
+    FreeResultsList(results);
+    results=NULL;
+   }
+ else
+    FixForwardRoute(results,result1);
+
+ finished:
+
+ FreeResultsList(forward);
+ FreeResultsList(backward);
+
+ if(route)
+    free(route);
+ if(scores)
+    free(scores);
+ if(edges)
+    free(edges);
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the optimum route between two nodes where the start and end are a set of pre/post-routed super-nodes.
+
+  Results *FindMiddleRoute Returns a set of results.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  Results *begin The initial portion of the route.
+
+  Results *end The final portion of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Results *FindMiddleRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Results *begin,Results *end)
+{
+ Results *results;
+ Queue   *queue;
+ Result  *finish_result;
+ score_t finish_score;
+ double  finish_lat,finish_lon;
+ Result  *result1,*result2,*result3,*result4;
+
+ if(option_bidirectional)
+    return(FindMiddleRouteBidirectional(nodes,segments,ways,relations,profile,begin,end));
+
+ if(!option_quiet)
+    printf_first("Routing: Super-Nodes checked = 0");
+
+ /* Set up the finish conditions */
+
+ finish_score=INF_DISTANCE;
+ finish_result=NULL;
+
+ if(IsFakeNode(end->finish_node))
+    GetFakeLatLong(end->finish_node,&finish_lat,&finish_lon);
+ else
+    GetLatLong(nodes,end->finish_node,&finish_lat,&finish_lon);
+
+ /* Create the list of results and insert the first node into the queue */
+
+ results=NewResultsList(65536);
+
+ results->start_node=begin->start_node;
+ results->prev_segment=begin->prev_segment;
+
+ if(begin->number==1)
+   {
+    if(begin->prev_segment==NO_SEGMENT)
+       results->prev_segment=NO_SEGMENT;
+    else
+      {
+       index_t superseg=FindSuperSegment(nodes,segments,ways,relations,profile,begin->start_node,begin->prev_segment);
+
+       results->prev_segment=superseg;
+      }
+   }
+
+ result1=InsertResult(results,results->start_node,results->prev_segment);
+
+ queue=NewQueueList();
+
+ /* Insert the finish points of the beginning part of the path into the queue,
+    translating the segments into super-segments. */
+
+ result3=FirstResult(begin);
+
+ while(result3)
+   {
+    if((results->start_node!=result3->node || results->prev_segment!=result3->segment) &&
+       !IsFakeNode(result3->node) && IsSuperNode(LookupNode(nodes,result3->node,5)))
+      {
+       Result *result5=result1;
+       index_t superseg=FindSuperSegment(nodes,segments,ways,relations,profile,result3->node,result3->segment);
+
+       if(superseg!=result3->segment)
          {
-          seg2 =IndexFakeSegment(segment);
-          seg2r=IndexRealSegment(seg2);
+          result5=InsertResult(results,result3->node,result3->segment);
+
+          result5->prev=result1;
          }
-       else
+
+       if(!FindResult(results,result3->node,superseg))
          {
-          seg2 =IndexSegment(segments,segment);
-          seg2r=seg2;
-         }
+          result2=InsertResult(results,result3->node,superseg);
+          result2->prev=result5;
 
-       /* must not perform U-turn (unless profile allows) */
-       if(profile->turns && (seg1==seg2 || seg1==seg2r || seg1r==seg2 || (seg1r==seg2r && IsFakeUTurn(seg1,seg2))))
-          goto endloop;
+          result2->score=result3->score;
+          result2->sortby=result3->score;
 
-       /* must obey turn relations */
-       if(turnrelation!=NO_RELATION)
-         {
-          index_t turnrelation2=FindFirstTurnRelation2(relations,node1,seg2r); /* node2 -> node1 -> result1->next->node */
+          InsertInQueue(queue,result2);
 
-          if(turnrelation2!=NO_RELATION && !IsTurnAllowed(relations,turnrelation2,node1,seg2r,seg1r,profile->allow))
-             goto endloop;
+          if((result4=FindResult(end,result2->node,result2->segment)))
+            {
+             if((result2->score+result4->score)<finish_score)
+               {
+                finish_score=result2->score+result4->score;
+                finish_result=result2;
+               }
+            }
          }
+      }
 
-       way=LookupWay(ways,segment->way,1);
+    result3=NextResult(begin,result3);
+   }
 
-       /* mode of transport must be allowed on the highway */
-       if(!(way->allow&profile->allow))
-          goto endloop;
+ if(begin->number==1)
+    InsertInQueue(queue,result1);
 
-       /* must obey weight restriction (if exists) */
-       if(way->weight && way->weight<profile->weight)
-          goto endloop;
+ /* Loop across all nodes in the queue */
 
-       /* must obey height/width/length restriction (if exists) */
-       if((way->height && way->height<profile->height) ||
+ while((result1=PopFromQueue(queue)))
+   {
+    Node *node1p;
+    Segment *segment;
+    index_t node1,seg1;
+    index_t turnrelation=NO_RELATION;
+
+    /* score must be better than current best score */
+    if(result1->score>finish_score)
+       continue;
+
+    node1=result1->node;
+    seg1=result1->segment;
+
+    node1p=LookupNode(nodes,node1,1); /* node1 cannot be a fake node (must be a super-node) */
+
+    /* lookup if a turn restriction applies */
+    if(profile->turns && IsTurnRestrictedNode(node1p)) /* node1 cannot be a fake node (must be a super-node) */
+       turnrelation=FindFirstTurnRelation2(relations,node1,seg1);
+
+    /* Loop across all segments */
+
+    segment=FirstSegment(segments,node1p,1); /* node1 cannot be a fake node (must be a super-node) */
+
+    while(segment)
+      {
+       Node *node2p;
+       Way *way;
+       index_t node2,seg2;
+       score_t segment_pref,segment_score,cumulative_score;
+
+       /* must be a super segment */
+       if(!IsSuperSegment(segment))
+          goto endloop;
+
+       /* must obey one-way restrictions (unless profile allows) */
+       if(profile->oneway && IsOnewayTo(segment,node1))
+          goto endloop;
+
+       node2=OtherNode(segment,node1);
+
+       seg2=IndexSegment(segments,segment); /* node2 cannot be a fake node (must be a super-node) */
+
+       /* must not perform U-turn */
+       if(seg1==seg2) /* No fake segments, applies to all profiles */
+          goto endloop;
+
+       /* must obey turn relations */
+       if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1,seg2,profile->allow))
+          goto endloop;
+
+       way=LookupWay(ways,segment->way,1);
+
+       /* transport must be allowed on the highway */
+       if(!(way->allow&profile->allow))
+          goto endloop;
+
+       /* must obey weight restriction (if exists) */
+       if(way->weight && way->weight<profile->weight)
+          goto endloop;
+
+       /* must obey height/width/length restriction (if exists) */
+       if((way->height && way->height<profile->height) ||
           (way->width  && way->width <profile->width ) ||
           (way->length && way->length<profile->length))
           goto endloop;
 
-       segment_pref=profile->highway[HIGHWAY(way->type)];
+       segment_pref=WayPreference(profile,way);
+
+       /* profile preferences must allow this highway */
+       if(segment_pref==0)
+          goto endloop;
+
+       node2p=LookupNode(nodes,node2,2); /* node2 cannot be a fake node (must be a super-node) */
+
+       /* mode of transport must be allowed through node2 */
+       if(!(node2p->allow&profile->allow))
+          goto endloop;
+
+       if(option_quickest==0)
+          segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+       else
+          segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+       cumulative_score=result1->score+segment_score;
+
+       /* score must be better than current best score */
+       if(cumulative_score>finish_score)
+          goto endloop;
+
+       result2=FindResult(results,node2,seg2);
+
+       if(!result2) /* New end node/segment pair */
+         {
+          result2=InsertResult(results,node2,seg2);
+          result2->prev=result1;
+          result2->score=cumulative_score;
+
+          if((result3=FindResult(end,node2,seg2)))
+            {
+             if((result2->score+result3->score)<finish_score)
+               {
+                finish_score=result2->score+result3->score;
+                finish_result=result2;
+               }
+            }
+          else
+            {
+             double lat,lon;
+             distance_t direct;
+
+             GetLatLong(nodes,node2,&lat,&lon); /* node2 cannot be a fake node (must be a super-node) */
+
+             direct=Distance(lat,lon,finish_lat,finish_lon);
+
+             if(option_quickest==0)
+                result2->sortby=result2->score+(score_t)direct/profile->max_pref;
+             else
+                result2->sortby=result2->score+(score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref;
+
+             if(result2->sortby<finish_score)
+                InsertInQueue(queue,result2);
+            }
+         }
+       else if(cumulative_score<result2->score) /* New end node/segment pair is better */
+         {
+          result2->prev=result1;
+          result2->score=cumulative_score;
+
+          if((result3=FindResult(end,node2,seg2)))
+            {
+             if((result2->score+result3->score)<finish_score)
+               {
+                finish_score=result2->score+result3->score;
+                finish_result=result2;
+               }
+            }
+          else if(result2->score<finish_score)
+            {
+             double lat,lon;
+             distance_t direct;
+
+             GetLatLong(nodes,node2,&lat,&lon); /* node2 cannot be a fake node (must be a super-node) */
+
+             direct=Distance(lat,lon,finish_lat,finish_lon);
+
+             if(option_quickest==0)
+                result2->sortby=result2->score+(score_t)direct/profile->max_pref;
+             else
+                result2->sortby=result2->score+(score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref;
+
+             if(result2->sortby<finish_score)
+                InsertInQueue(queue,result2);
+            }
+         }
+
+       if(!option_quiet && !(results->number%1000))
+          printf_middle("Routing: Super-Nodes checked = %d",results->number);
+
+      endloop:
+
+       segment=NextSegment(segments,segment,node1); /* node1 cannot be a fake node (must be a super-node) */
+      }
+   }
+
+ if(!option_quiet)
+    printf_last("Routing: Super-Nodes checked = %d",results->number);
+
+ FreeQueueList(queue);
+
+ /* Check it worked */
+
+ if(!finish_result)
+   {
+    FreeResultsList(results);
+    return(NULL);
+   }
+
+ /* Finish off the end part of the route */
+
+ if(finish_result->node!=end->finish_node)
+   {
+    result3=InsertResult(results,end->finish_node,NO_SEGMENT);
+
+    result3->prev=finish_result;
+    result3->score=finish_score;
+
+    finish_result=result3;
+   }
+
+ FixForwardRoute(results,finish_result);
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the optimum route between two nodes where the start and end are a set of pre/post-routed super-nodes
+  by searching forwards from the beginning and backwards from the end at the same time.
+
+  Results *FindMiddleRouteBidirectional Returns a set of results.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  Results *begin The initial portion of the route.
+
+  Results *end The final portion of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Results *FindMiddleRouteBidirectional(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Results *begin,Results *end)
+{
+ Results *results,*backward,*sources;
+ Queue   *queue,*bqueue;
+ Result  *finish_result,*finish_backward;
+ score_t finish_score;
+ double  finish_lat,finish_lon;
+ double  start_lat,start_lon;
+ Result  *result1,*result2,*result3,*result4;
+
+ if(!option_quiet)
+    printf_first("Routing: Super-Nodes checked = 0");
+
+ /* Set up the finish conditions */
+
+ finish_score=INF_DISTANCE;
+ finish_result=NULL;
+ finish_backward=NULL;
+
+ if(IsFakeNode(end->finish_node))
+    GetFakeLatLong(end->finish_node,&finish_lat,&finish_lon);
+ else
+    GetLatLong(nodes,end->finish_node,&finish_lat,&finish_lon);
+
+ if(IsFakeNode(begin->start_node))
+    GetFakeLatLong(begin->start_node,&start_lat,&start_lon);
+ else
+    GetLatLong(nodes,begin->start_node,&start_lat,&start_lon);
+
+ /* Create the list of results and insert the first node into the queue */
+
+ results=NewResultsList(65536);
+
+ results->start_node=begin->start_node;
+ results->prev_segment=begin->prev_segment;
+
+ if(begin->number==1)
+   {
+    if(begin->prev_segment==NO_SEGMENT)
+       results->prev_segment=NO_SEGMENT;
+    else
+      {
+       index_t superseg=FindSuperSegment(nodes,segments,ways,relations,profile,begin->start_node,begin->prev_segment);
+
+       results->prev_segment=superseg;
+      }
+   }
+
+ result1=InsertResult(results,results->start_node,results->prev_segment);
+
+ queue=NewQueueList();
+
+ /* The forward search starts from these node/segment combinations (the only ones that
+    it continues from if they are also part of the end of the route). */
+
+ sources=NewResultsList(64);
+
+ /* Insert the finish points of the beginning part of the path into the queue,
+    translating the segments into super-segments. */
+
+ result3=FirstResult(begin);
+
+ while(result3)
+   {
+    if((results->start_node!=result3->node || results->prev_segment!=result3->segment) &&
+       !IsFakeNode(result3->node) && IsSuperNode(LookupNode(nodes,result3->node,5)))
+      {
+       Result *result5=result1;
+       index_t superseg=FindSuperSegment(nodes,segments,ways,relations,profile,result3->node,result3->segment);
+
+       if(superseg!=result3->segment)
+         {
+          result5=InsertResult(results,result3->node,result3->segment);
+
+          result5->prev=result1;
+         }
+
+       if(!FindResult(results,result3->node,superseg))
+         {
+          result2=InsertResult(results,result3->node,superseg);
+          result2->prev=result5;
+
+          result2->score=result3->score;
+          result2->sortby=result3->score;
+
+          InsertInQueue(queue,result2);
+
+          InsertResult(sources,result3->node,superseg);
+
+          if((result4=FindResult(end,result2->node,result2->segment)))
+            {
+             if((result2->score+result4->score)<finish_score)
+               {
+                finish_score=result2->score+result4->score;
+                finish_result=result2;
+               }
+            }
+         }
+      }
+
+    result3=NextResult(begin,result3);
+   }
+
+ if(begin->number==1)
+   {
+    InsertInQueue(queue,result1);
+
+    InsertResult(sources,result1->node,result1->segment);
+   }
+
+ /* Create the list of backward results (the node and the segment used to arrive at
+    it with the score to the finish) and insert the start points of the end part of
+    the path that arrive at a super-node along a super-segment into the queue. */
+
+ backward=NewResultsList(65536);
+
+ backward->finish_node=end->finish_node;
+
+ bqueue=NewQueueList();
+
+ result3=FirstResult(end);
+
+ while(result3)
+   {
+    if(!IsFakeNode(result3->node) && result3->segment!=NO_SEGMENT && !IsFakeSegment(result3->segment) &&
+       IsSuperNode(LookupNode(nodes,result3->node,5)) && IsSuperSegment(LookupSegment(segments,result3->segment,2)))
+      {
+       double lat,lon;
+       distance_t direct;
+
+       result2=InsertResult(backward,result3->node,result3->segment);
+
+       result2->score=result3->score;
+
+       GetLatLong(nodes,result3->node,&lat,&lon); /* node cannot be a fake node (must be a super-node) */
+
+       direct=Distance(lat,lon,start_lat,start_lon);
+
+       if(option_quickest==0)
+          result2->sortby=result2->score+(score_t)direct/profile->max_pref;
+       else
+          result2->sortby=result2->score+(score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref;
+
+       InsertInQueue(bqueue,result2);
+      }
+
+    result3=NextResult(end,result3);
+   }
+
+ /* Loop across the nodes in the queue that is the least advanced until either search can't find a better route */
+
+ while(1)
+   {
+    Result *top1=PeekAtQueue(queue);
+    Result *top2=PeekAtQueue(bqueue);
+
+    if(!top1 || !top2)
+       break;
+
+    if(top1->sortby>=finish_score || top2->sortby>=finish_score)
+       break;
+
+    if(top1->sortby<=top2->sortby) /* Forwards from the beginning */
+      {
+       Node *node1p;
+       Segment *segment;
+       index_t node1,seg1;
+       index_t turnrelation=NO_RELATION;
+
+       result1=PopFromQueue(queue);
+
+       /* score must be better than current best score */
+       if(result1->score>finish_score)
+          continue;
+
+       node1=result1->node;
+       seg1=result1->segment;
+
+       node1p=LookupNode(nodes,node1,1); /* node1 cannot be a fake node (must be a super-node) */
+
+       /* lookup if a turn restriction applies */
+       if(profile->turns && IsTurnRestrictedNode(node1p)) /* node1 cannot be a fake node (must be a super-node) */
+          turnrelation=FindFirstTurnRelation2(relations,node1,seg1);
+
+       /* Loop across all segments */
+
+       segment=FirstSegment(segments,node1p,1); /* node1 cannot be a fake node (must be a super-node) */
+
+       while(segment)
+         {
+          Node *node2p;
+          Way *way;
+          index_t node2,seg2;
+          score_t segment_pref,segment_score,cumulative_score;
+
+          /* must be a super segment */
+          if(!IsSuperSegment(segment))
+             goto endloop;
+
+          /* must obey one-way restrictions (unless profile allows) */
+          if(profile->oneway && IsOnewayTo(segment,node1))
+             goto endloop;
+
+          node2=OtherNode(segment,node1);
+
+          seg2=IndexSegment(segments,segment); /* node2 cannot be a fake node (must be a super-node) */
+
+          /* must not perform U-turn */
+          if(seg1==seg2) /* No fake segments, applies to all profiles */
+             goto endloop;
+
+          /* must obey turn relations */
+          if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1,seg2,profile->allow))
+             goto endloop;
+
+          way=LookupWay(ways,segment->way,1);
+
+          /* transport must be allowed on the highway */
+          if(!(way->allow&profile->allow))
+             goto endloop;
+
+          /* must obey weight restriction (if exists) */
+          if(way->weight && way->weight<profile->weight)
+             goto endloop;
+
+          /* must obey height/width/length restriction (if exists) */
+          if((way->height && way->height<profile->height) ||
+             (way->width  && way->width <profile->width ) ||
+             (way->length && way->length<profile->length))
+             goto endloop;
+
+          segment_pref=WayPreference(profile,way);
+
+          /* profile preferences must allow this highway */
+          if(segment_pref==0)
+             goto endloop;
+
+          node2p=LookupNode(nodes,node2,2); /* node2 cannot be a fake node (must be a super-node) */
+
+          /* mode of transport must be allowed through node2 */
+          if(!(node2p->allow&profile->allow))
+             goto endloop;
+
+          if(option_quickest==0)
+             segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+          else
+             segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+          cumulative_score=result1->score+segment_score;
+
+          /* score must be better than current best score */
+          if(cumulative_score>finish_score)
+             goto endloop;
+
+          result2=FindResult(results,node2,seg2);
+
+          if(!result2) /* New end node/segment pair */
+            {
+             result2=InsertResult(results,node2,seg2);
+             result2->prev=result1;
+             result2->score=cumulative_score;
+            }
+          else if(cumulative_score<result2->score) /* New end node/segment pair is better */
+            {
+             result2->prev=result1;
+             result2->score=cumulative_score;
+            }
+          else
+             goto endloop;
+
+          if((result3=FindResult(end,node2,seg2)))
+            {
+             if((result2->score+result3->score)<finish_score)
+               {
+                finish_score=result2->score+result3->score;
+                finish_result=result2;
+                finish_backward=NULL;
+               }
+            }
+          else
+            {
+             double lat,lon;
+             distance_t direct;
+
+             /* check if the backward search has already been here */
+             if((result3=FindResult(backward,node2,seg2)) && (result2->score+result3->score)<finish_score)
+               {
+                finish_score=result2->score+result3->score;
+                finish_result=result2;
+                finish_backward=result3->next;
+               }
+
+             GetLatLong(nodes,node2,&lat,&lon); /* node2 cannot be a fake node (must be a super-node) */
+
+             direct=Distance(lat,lon,finish_lat,finish_lon);
+
+             if(option_quickest==0)
+                result2->sortby=result2->score+(score_t)direct/profile->max_pref;
+             else
+                result2->sortby=result2->score+(score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref;
+
+             if(result2->sortby<finish_score)
+                InsertInQueue(queue,result2);
+            }
+
+         endloop:
+
+          segment=NextSegment(segments,segment,node1); /* node1 cannot be a fake node (must be a super-node) */
+         }
+      }
+    else /* Backwards from the end */
+      {
+       Node *node1p,*node2p;
+       Segment *segment;
+       Way *way;
+       index_t node1,node2,seg1;
+       score_t segment_pref,segment_score,cumulative_score,direct_score;
+       double lat,lon;
+       distance_t direct;
+       int turns,extra;
+
+       result1=PopFromQueue(bqueue);
+
+       /* score must be better than current best score */
+       if(result1->score>finish_score)
+          continue;
+
+       node1=result1->node;
+       seg1=result1->segment;
+
+       segment=LookupSegment(segments,seg1,2); /* No fake segments */
+
+       node2=OtherNode(segment,node1);
+
+       /* The super-segment from node2 to node1 is checked in the same way as the forward search */
+
+       /* must be a super segment */
+       if(!IsSuperSegment(segment))
+          continue;
+
+       /* must obey one-way restrictions (unless profile allows) */
+       if(profile->oneway && IsOnewayFrom(segment,node1)) /* Disallow oneway from node2 *to* node1 */
+          continue;
+
+       way=LookupWay(ways,segment->way,1);
+
+       /* transport must be allowed on the highway */
+       if(!(way->allow&profile->allow))
+          continue;
+
+       /* must obey weight restriction (if exists) */
+       if(way->weight && way->weight<profile->weight)
+          continue;
+
+       /* must obey height/width/length restriction (if exists) */
+       if((way->height && way->height<profile->height) ||
+          (way->width  && way->width <profile->width ) ||
+          (way->length && way->length<profile->length))
+          continue;
+
+       segment_pref=WayPreference(profile,way);
+
+       /* profile preferences must allow this highway */
+       if(segment_pref==0)
+          continue;
+
+       node1p=LookupNode(nodes,node1,1); /* node1 cannot be a fake node (must be a super-node) */
+
+       /* mode of transport must be allowed through node1 */
+       if(!(node1p->allow&profile->allow))
+          continue;
+
+       if(option_quickest==0)
+          segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+       else
+          segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+       cumulative_score=result1->score+segment_score;
+
+       /* score must be better than current best score */
+       if(cumulative_score>finish_score)
+          continue;
+
+       node2p=LookupNode(nodes,node2,2); /* node2 cannot be a fake node (must be a super-node) */
+
+       turns=(profile->turns && IsTurnRestrictedNode(node2p));
+
+       GetLatLong(nodes,node2,&lat,&lon); /* node2 cannot be a fake node (must be a super-node) */
+
+       direct=Distance(lat,lon,start_lat,start_lon);
+
+       if(option_quickest==0)
+          direct_score=(score_t)direct/profile->max_pref;
+       else
+          direct_score=(score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref;
+
+       /* Loop across all super-segments that the forward search could have used to arrive
+          at node2 (and the previous segment at the start node if it is not one of them) */
+
+       segment=FirstSegment(segments,node2p,1); /* node2 cannot be a fake node (must be a super-node) */
+
+       extra=(begin->number==1 && node2==results->start_node && results->prev_segment==NO_SEGMENT);
+
+       while(segment || extra)
+         {
+          index_t seg2;
+
+          /* must be a super segment (or one that the forward search started from) */
+          if(segment && !IsSuperSegment(segment) && !FindResult(sources,node2,IndexSegment(segments,segment)))
+             goto endloop2;
+
+          if(segment)
+             seg2=IndexSegment(segments,segment);
+          else
+            {
+             seg2=results->prev_segment;
+             extra=0;
+            }
+
+          /* must not perform U-turn */
+          if(seg1==seg2) /* No fake segments, applies to all profiles */
+             goto endloop2;
+
+          /* must obey turn relations */
+          if(turns)
+            {
+             index_t turnrelation=FindFirstTurnRelation2(relations,node2,seg2); /* seg2 -> node2 -> seg1 */
+
+             if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node2,seg2,seg1,profile->allow))
+                goto endloop2;
+            }
+
+          /* The forward search does not continue from the end part of the route unless it started there */
+
+          if(FindResult(end,node2,seg2))
+            {
+             if(FindResult(sources,node2,seg2) &&
+                (result3=FindResult(results,node2,seg2)) && (result3->prev || begin->number==1) &&
+                (result3->score+cumulative_score)<finish_score)
+               {
+                finish_score=result3->score+cumulative_score;
+                finish_result=result3;
+                finish_backward=result1;
+               }
+
+             goto endloop2;
+            }
+
+          result2=FindResult(backward,node2,seg2);
+
+          if(!result2) /* New end node/segment pair */
+            {
+             result2=InsertResult(backward,node2,seg2);
+             result2->next=result1;   /* working backwards */
+             result2->score=cumulative_score;
+            }
+          else if(cumulative_score<result2->score) /* New end node/segment pair is better */
+            {
+             result2->next=result1;   /* working backwards */
+             result2->score=cumulative_score;
+            }
+          else
+             goto endloop2;
+
+          /* check if the forward search has already been here (the start node is only used if there is no beginning part) */
+          if((result3=FindResult(results,node2,seg2)) && (result3->prev || begin->number==1) &&
+             (result3->score+result2->score)<finish_score)
+            {
+             finish_score=result3->score+result2->score;
+             finish_result=result3;
+             finish_backward=result1;
+            }
+
+          result2->sortby=result2->score+direct_score;
+
+          if(result2->sortby<finish_score)
+             InsertInQueue(bqueue,result2);
+
+         endloop2:
+
+          if(segment)
+             segment=NextSegment(segments,segment,node2); /* node2 cannot be a fake node (must be a super-node) */
+         }
+      }
+
+    if(!option_quiet && !((results->number+backward->number)%1000))
+       printf_middle("Routing: Super-Nodes checked = %d",results->number+backward->number);
+   }
+
+ if(!option_quiet)
+    printf_last("Routing: Super-Nodes checked = %d",results->number+backward->number);
+
+ FreeQueueList(queue);
+ FreeQueueList(bqueue);
+
+ FreeResultsList(sources);
+
+ /* Check it worked */
+
+ if(!finish_result)
+   {
+    FreeResultsList(results);
+    FreeResultsList(backward);
+    return(NULL);
+   }
+
+ /* Join on the part of the route found by the backward search */
+
+ finish_result=JoinBidirectionalRoute(results,finish_result,finish_backward,finish_score);
+
+ FreeResultsList(backward);
+
+ /* Finish off the end part of the route */
+
+ if(finish_result->node!=end->finish_node)
+   {
+    result3=InsertResult(results,end->finish_node,NO_SEGMENT);
+
+    result3->prev=finish_result;
+    result3->score=finish_score;
+
+    finish_result=result3;
+   }
+
+ FixForwardRoute(results,finish_result);
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the super-segment that represents the route that contains a particular segment.
+
+  index_t FindSuperSegment Returns the index of the super-segment.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  index_t endnode The super-node that the route ends at.
+
+  index_t endsegment The segment that the route ends with.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t FindSuperSegment(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t endnode,index_t endsegment)
+{
+ Node *node=LookupNode(nodes,endnode,5); /* endnode cannot be a fake node (must be a super-node) */
+ Segment *segment;
+
+ if(IsFakeSegment(endsegment))
+    endsegment=IndexRealSegment(endsegment);
+
+ segment=LookupSegment(segments,endsegment,2);
+
+ if(IsSuperSegment(segment))
+    return(endsegment);
+
+ /* Loop across all segments */
+
+ segment=FirstSegment(segments,node,3); /* endnode cannot be a fake node (must be a super-node) */
+
+ while(segment)
+   {
+    if(IsSuperSegment(segment))
+      {
+       Results *results;
+       index_t startnode;
+
+       startnode=OtherNode(segment,endnode);
+
+       results=FindNormalRoute(nodes,segments,ways,relations,profile,startnode,NO_SEGMENT,endnode);
+
+       if(results && results->last_segment==endsegment)
+         {
+          FreeResultsList(results);
+          return(IndexSegment(segments,segment));
+         }
+
+       if(results)
+          FreeResultsList(results);
+      }
+
+    segment=NextSegment(segments,segment,endnode); /* endnode cannot be a fake node (must be a super-node) */
+   }
+
+ return(endsegment);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find all routes from a specified node to any super-node.
+
+  Results *FindStartRoutes Returns a set of results.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  index_t start_node The start node.
+
+  index_t prev_segment The previous segment before the start node.
+
+  index_t finish_node The finish node.
+
+  int *nsuper Returns the number of super-nodes seen.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Results *FindStartRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t finish_node,int *nsuper)
+{
+ Results *results;
+ Queue   *queue;
+ Result  *result1,*result2;
+ int     found_finish=0;
+ score_t finish_score=INF_SCORE;
+ Estimate estimate;
+ int     stopped=0;
+
+ if(option_astar)
+    InitEstimate(&estimate,nodes,finish_node);
+
+ /* Create the results and insert the start node */
+
+ results=NewResultsList(64);
+
+ results->start_node=start_node;
+ results->prev_segment=prev_segment;
+
+ result1=InsertResult(results,results->start_node,results->prev_segment);
+
+ /* Insert the first node into the queue */
+
+ queue=NewQueueList();
+
+ InsertInQueue(queue,result1);
+
+ /* Loop across all nodes in the queue */
+
+ while((result1=PopFromQueue(queue)))
+   {
+    Node *node1p=NULL;
+    Segment *segment;
+    index_t node1,seg1,seg1r;
+    index_t turnrelation=NO_RELATION;
+
+    /* estimated score must not be worse than the route to the finish node without super-nodes
+       (any route through a super-node from here would be worse so stop searching) */
+    if(option_astar && result1->sortby>finish_score)
+      {
+       stopped=1;
+       break;
+      }
+
+    node1=result1->node;
+    seg1=result1->segment;
+
+    if(IsFakeSegment(seg1))
+       seg1r=IndexRealSegment(seg1);
+    else
+       seg1r=seg1;
+
+    if(!IsFakeNode(node1))
+       node1p=LookupNode(nodes,node1,1);
+
+    /* lookup if a turn restriction applies */
+    if(profile->turns && node1p && IsTurnRestrictedNode(node1p))
+       turnrelation=FindFirstTurnRelation2(relations,node1,seg1r);
+
+    /* Loop across all segments */
+
+    if(IsFakeNode(node1))
+       segment=FirstFakeSegment(node1);
+    else
+       segment=FirstSegment(segments,node1p,1);
+
+    while(segment)
+      {
+       Node *node2p=NULL;
+       Way *way;
+       index_t node2,seg2,seg2r;
+       score_t segment_pref,segment_score,cumulative_score;
+
+       node2=OtherNode(segment,node1); /* need this here because we use node2 at the end of the loop */
+
+       /* must be a normal segment */
+       if(!IsNormalSegment(segment))
+          goto endloop;
+
+       /* must obey one-way restrictions (unless profile allows) */
+       if(profile->oneway && IsOnewayTo(segment,node1))
+          goto endloop;
+
+       if(IsFakeNode(node1) || IsFakeNode(node2))
+         {
+          seg2 =IndexFakeSegment(segment);
+          seg2r=IndexRealSegment(seg2);
+         }
+       else
+         {
+          seg2 =IndexSegment(segments,segment);
+          seg2r=seg2;
+         }
+
+       /* must not perform U-turn (unless profile allows) */
+       if(profile->turns && (seg1==seg2 || seg1==seg2r || seg1r==seg2 || (seg1r==seg2r && IsFakeUTurn(seg1,seg2))))
+          goto endloop;
+
+       /* must obey turn relations */
+       if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1r,seg2r,profile->allow))
+          goto endloop;
+
+       way=LookupWay(ways,segment->way,1);
+
+       /* mode of transport must be allowed on the highway */
+       if(!(way->allow&profile->allow))
+          goto endloop;
+
+       /* must obey weight restriction (if exists) */
+       if(way->weight && way->weight<profile->weight)
+          goto endloop;
+
+       /* must obey height/width/length restriction (if exists) */
+       if((way->height && way->height<profile->height) ||
+          (way->width  && way->width <profile->width ) ||
+          (way->length && way->length<profile->length))
+          goto endloop;
+
+       segment_pref=WayPreference(profile,way);
+
+       /* profile preferences must allow this highway */
+       if(segment_pref==0)
+          goto endloop;
+
+       if(!IsFakeNode(node2))
+          node2p=LookupNode(nodes,node2,2);
+
+       /* mode of transport must be allowed through node2 */
+       if(node2p && !(node2p->allow&profile->allow))
+          goto endloop;
+
+       if(option_quickest==0)
+          segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+       else
+          segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+       cumulative_score=result1->score+segment_score;
+
+       result2=FindResult(results,node2,seg2);
+
+       if(!result2) /* New end node/segment combination */
+         {
+          result2=InsertResult(results,node2,seg2);
+          result2->prev=result1;
+          result2->score=cumulative_score;
+
+          if(node2p && IsSuperNode(node2p))
+             (*nsuper)++;
+
+          if(node2p && !IsSuperNode(node2p))
+            {
+             if(option_astar)
+                result2->sortby=result2->score+EstimateScore(&estimate,nodes,profile,node2);
+             else
+                result2->sortby=result2->score;
+
+             InsertInQueue(queue,result2);
+            }
+
+          if(node2==finish_node)
+            {
+             found_finish=1;
+
+             if(cumulative_score<finish_score)
+                finish_score=cumulative_score;
+            }
+         }
+       else if(cumulative_score<result2->score) /* New end node/segment combination is better */
+         {
+          result2->prev=result1;
+          result2->score=cumulative_score;
+
+          if(node2p && !IsSuperNode(node2p))
+            {
+             if(option_astar)
+                result2->sortby=result2->score+EstimateScore(&estimate,nodes,profile,node2);
+             else
+                result2->sortby=result2->score;
+
+             InsertInQueue(queue,result2);
+            }
+
+          if(node2==finish_node && cumulative_score<finish_score)
+             finish_score=cumulative_score;
+         }
+
+      endloop:
+
+       if(IsFakeNode(node1))
+          segment=NextFakeSegment(segment,node1);
+       else if(IsFakeNode(node2))
+          segment=NULL; /* cannot call NextSegment() with a fake segment */
+       else
+         {
+          segment=NextSegment(segments,segment,node1);
+
+          if(!segment && IsFakeNode(finish_node))
+             segment=ExtraFakeSegment(node1,finish_node);
+         }
+      }
+   }
+
+ FreeQueueList(queue);
+
+ /* If the search stopped early then only the super-nodes that might give a better route than
+    the one already found are counted, the others (which might not have their best score) are
+    given an infinite score so that the middle part of the route is not started from them. */
+
+ if(stopped)
+   {
+    result1=FirstResult(results);
+
+    *nsuper=0;
+
+    while(result1)
+      {
+       if(result1->node!=finish_node && !IsFakeNode(result1->node) && IsSuperNode(LookupNode(nodes,result1->node,1)))
+         {
+          if((result1->score+EstimateScore(&estimate,nodes,profile,result1->node))<finish_score)
+             (*nsuper)++;
+          else if(result1->prev)
+             result1->score=INF_SCORE;
+         }
+
+       result1=NextResult(results,result1);
+      }
+   }
+
+ /* Check it worked */
+
+ if(results->number==1 || (*nsuper==0 && found_finish==0))
+   {
+    FreeResultsList(results);
+    return(NULL);
+   }
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find all routes from any super-node to a specific node (by working backwards from the specific node to all super-nodes).
+
+  Results *FindFinishRoutes Returns a set of results.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  index_t finish_node The finishing node.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Results *FindFinishRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t finish_node)
+{
+ Results *results,*results2;
+ Queue   *queue;
+ Result  *result1,*result2,*result3;
+
+ /* Create the results and insert the finish node */
+
+ results=NewResultsList(64);
+
+ results->finish_node=finish_node;
+
+ result1=InsertResult(results,finish_node,NO_SEGMENT);
+
+ /* Insert the first node into the queue */
+
+ queue=NewQueueList();
+
+ InsertInQueue(queue,result1);
+
+ /* Loop across all nodes in the queue */
+
+ while((result1=PopFromQueue(queue)))
+   {
+    Node *node1p=NULL;
+    Segment *segment;
+    index_t node1,seg1,seg1r;
+    index_t turnrelation=NO_RELATION;
+
+    node1=result1->node;
+    seg1=result1->segment;
+
+    if(IsFakeSegment(seg1))
+       seg1r=IndexRealSegment(seg1);
+    else
+       seg1r=seg1;
+
+    if(!IsFakeNode(node1))
+       node1p=LookupNode(nodes,node1,1);
+
+    /* lookup if a turn restriction applies */
+    if(profile->turns && node1p && IsTurnRestrictedNode(node1p))
+       turnrelation=FindFirstTurnRelation1(relations,node1); /* working backwards => turn relation sort order doesn't help */
+
+    /* Loop across all segments */
+
+    if(IsFakeNode(node1))
+       segment=FirstFakeSegment(node1);
+    else
+       segment=FirstSegment(segments,node1p,1);
+
+    while(segment)
+      {
+       Node *node2p=NULL;
+       Way *way;
+       index_t node2,seg2,seg2r;
+       score_t segment_pref,segment_score,cumulative_score;
+
+       /* must be a normal segment */
+       if((IsFakeNode(node1) || !IsSuperNode(node1p)) && !IsNormalSegment(segment))
+          goto endloop;
+
+       /* must obey one-way restrictions (unless profile allows) */
+       if(profile->oneway && IsOnewayFrom(segment,node1)) /* Disallow oneway from node2 *to* node1 */
+          goto endloop;
+
+       node2=OtherNode(segment,node1);
+
+       if(IsFakeNode(node1) || IsFakeNode(node2))
+         {
+          seg2 =IndexFakeSegment(segment);
+          seg2r=IndexRealSegment(seg2);
+         }
+       else
+         {
+          seg2 =IndexSegment(segments,segment);
+          seg2r=seg2;
+         }
+
+       /* must not perform U-turn (unless profile allows) */
+       if(profile->turns && (seg1==seg2 || seg1==seg2r || seg1r==seg2 || (seg1r==seg2r && IsFakeUTurn(seg1,seg2))))
+          goto endloop;
+
+       /* must obey turn relations */
+       if(turnrelation!=NO_RELATION)
+         {
+          index_t turnrelation2=FindFirstTurnRelation2(relations,node1,seg2r); /* node2 -> node1 -> result1->next->node */
+
+          if(turnrelation2!=NO_RELATION && !IsTurnAllowed(relations,turnrelation2,node1,seg2r,seg1r,profile->allow))
+             goto endloop;
+         }
+
+       way=LookupWay(ways,segment->way,1);
+
+       /* mode of transport must be allowed on the highway */
+       if(!(way->allow&profile->allow))
+          goto endloop;
+
+       /* must obey weight restriction (if exists) */
+       if(way->weight && way->weight<profile->weight)
+          goto endloop;
+
+       /* must obey height/width/length restriction (if exists) */
+       if((way->height && way->height<profile->height) ||
+          (way->width  && way->width <profile->width ) ||
+          (way->length && way->length<profile->length))
+          goto endloop;
+
+       segment_pref=WayPreference(profile,way);
+
+       /* profile preferences must allow this highway */
+       if(segment_pref==0)
+          goto endloop;
+
+       if(!IsFakeNode(node2))
+          node2p=LookupNode(nodes,node2,2);
+
+       /* mode of transport must be allowed through node2 */
+       if(node2p && !(node2p->allow&profile->allow))
+          goto endloop;
+
+       if(option_quickest==0)
+          segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+       else
+          segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+       cumulative_score=result1->score+segment_score;
+
+       result2=FindResult(results,node2,seg2);
+
+       if(!result2) /* New end node */
+         {
+          result2=InsertResult(results,node2,seg2);
+          result2->next=result1;   /* working backwards */
+          result2->score=cumulative_score;
+
+          if(IsFakeNode(node1) || (!IsFakeNode(node1) && !IsSuperNode(node1p))) /* Overshoot by one segment */
+            {
+             result2->sortby=result2->score;
+             InsertInQueue(queue,result2);
+            }
+         }
+       else if(cumulative_score<result2->score) /* New end node is better */
+         {
+          result2->next=result1; /* working backwards */
+          result2->score=cumulative_score;
+
+          if(IsFakeNode(node1) || (!IsFakeNode(node1) && !IsSuperNode(node1p))) /* Overshoot by one segment */
+            {
+             result2->sortby=result2->score;
+             InsertInQueue(queue,result2);
+            }
+         }
+
+      endloop:
+
+       if(IsFakeNode(node1))
+          segment=NextFakeSegment(segment,node1);
+       else
+          segment=NextSegment(segments,segment,node1);
+      }
+   }
+
+ FreeQueueList(queue);
+
+ /* Check it worked */
+
+ if(results->number==1)
+   {
+    FreeResultsList(results);
+    return(NULL);
+   }
+
+ /* Create a results structure with the node at the end of the segment opposite the start */
+
+ results2=NewResultsList(64);
+
+ results2->finish_node=results->finish_node;
+
+ result3=FirstResult(results);
+
+ while(result3)
+   {
+    if(result3->next)
+      {
+       result2=InsertResult(results2,result3->next->node,result3->segment);
+
+       result2->score=result3->next->score;
+      }
+
+    result3=NextResult(results,result3);
+   }
+
+ /* Fix up the result->next pointers */
+
+ result3=FirstResult(results);
+
+ while(result3)
+   {
+    if(result3->next && result3->next->next)
+      {
+       result1=FindResult(results2,result3->next->node,result3->segment);
+       result2=FindResult(results2,result3->next->next->node,result3->next->segment);
+
+       result1->next=result2;
+      }
+
+    result3=NextResult(results,result3);
+   }
+
+ FreeResultsList(results);
+
+ return(results2);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Create an optimum route given the set of super-nodes to follow.
+
+  Results *CombineRoutes Returns the results from joining the super-nodes.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  Results *begin The set of results for the start of the route.
+
+  Results *middle The set of results from the super-node route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Results *CombineRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Results *begin,Results *middle)
+{
+ Result *midres,*comres1;
+ Results *combined;
+ score_t score;
+
+ combined=NewResultsList(256);
+
+ combined->start_node=begin->start_node;
+ combined->prev_segment=begin->prev_segment;
+
+ /* Insert the start point */
+
+ midres=FindResult(middle,middle->start_node,middle->prev_segment);
+
+ comres1=InsertResult(combined,combined->start_node,combined->prev_segment);
+
+ /* Insert the start of the route */
+
+ if(begin->number>1 && midres->next)
+   {
+    Result *begres;
+
+    midres=FindResult(middle,midres->next->node,midres->next->segment);
+
+    begres=FindResult(begin,midres->node,midres->segment);
+
+    FixForwardRoute(begin,begres);
+
+    if(midres->next && midres->next->node==midres->node)
+       midres=midres->next;
+
+    begres=FindResult(begin,begin->start_node,begin->prev_segment);
+
+    begres=begres->next;
+
+    score=comres1->score;
+
+    do
+      {
+       Result *comres2;
+
+       comres2=InsertResult(combined,begres->node,begres->segment);
+
+       comres2->score=begres->score+score;
+       comres2->prev=comres1;
+
+       begres=begres->next;
+
+       comres1=comres2;
+      }
+    while(begres);
+   }
+
+ /* Sort out the combined route */
+
+ do
+   {
+    Result *result;
+
+    if(midres->next)
+      {
+       Results *results=NULL;
+
+       if(midres->next->node!=midres->node)
+          results=UnpackSuperSegment(nodes,segments,ways,relations,profile,comres1->node,comres1->segment,midres->next->segment);
+
+       if(!results)
+          results=FindNormalRoute(nodes,segments,ways,relations,profile,comres1->node,comres1->segment,midres->next->node);
+
+       if(!results)
+          return(NULL);
+
+       result=FindResult(results,midres->node,comres1->segment);
+
+       result=result->next;
+
+       score=comres1->score;
+
+       /*
+        *      midres                          midres->next
+        *         =                                  =
+        *      ---*----------------------------------*  = middle
+        *
+        *      ---*----.----.----.----.----.----.----*  = results
+        *              =
+        *             result
+        *
+        *      ---*----.----.----.----.----.----.----*  = combined
+        *         =    =
+        *   comres1  comres2
+        */
+
+       do
+         {
+          Result *comres2;
+
+          comres2=InsertResult(combined,result->node,result->segment);
+
+          comres2->score=result->score+score;
+          comres2->prev=comres1;
+
+          result=result->next;
+
+          comres1=comres2;
+         }
+       while(result);
+
+       FreeResultsList(results);
+      }
+
+    midres=midres->next;
+   }
+ while(midres);
+
+ FixForwardRoute(combined,comres1);
+
+ return(combined);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Create the route along the normal segments that make up a super-segment using the stored
+  super-segment paths instead of searching for it.
+
+  Results *UnpackSuperSegment Returns a set of results (the same as FindNormalRoute() would) or NULL if
+                              the path is not stored or cannot be used with this profile.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  index_t start_node The start node (one end of the super-segment).
+
+  index_t prev_segment The previous segment before the start node.
+
+  index_t supersegment The super-segment to follow.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Results *UnpackSuperSegment(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,index_t start_node,index_t prev_segment,index_t supersegment)
+{
+ Results *results;
+ Result  *result1;
+ Segment *segment;
+ index_t finish_node,first,npath,i;
+ int     forwards;
+
+ if(IsFakeNode(start_node) || IsFakeSegment(supersegment) || supersegment==NO_SEGMENT)
+    return(NULL);
+
+ segment=LookupSegment(segments,supersegment,1);
+
+ if(segment->node1==start_node)
+   {
+    finish_node=segment->node2;
+    forwards=1;
+   }
+ else if(segment->node2==start_node)
+   {
+    finish_node=segment->node1;
+    forwards=0;
+   }
+ else
+    return(NULL);
+
+ /* A segment that is also a normal segment is its own path */
+
+ if(IsNormalSegment(segment))
+   {
+    first=NO_SEGMENT;
+    npath=1;
+   }
+ else
+   {
+    npath=LookupSuperSegmentPath(segments,supersegment,&first);
+
+    if(npath==0)
+       return(NULL);
+   }
+
+ /* Create the list of results and insert the first node */
+
+ results=NewResultsList(8);
+
+ results->start_node=start_node;
+ results->prev_segment=prev_segment;
+
+ result1=InsertResult(results,start_node,prev_segment);
+
+ /* Follow the path checking each segment the same way as FindNormalRoute() */
+
+ for(i=0;i<npath;i++)
+   {
+    Node *node1p,*node2p;
+    Way *way;
+    Result *result2;
+    index_t node1,node2,seg1,seg1r,seg2;
+    index_t turnrelation=NO_RELATION;
+    score_t segment_pref,segment_score;
+
+    node1=result1->node;
+    seg1=result1->segment;
+
+    if(IsFakeSegment(seg1))
+       seg1r=IndexRealSegment(seg1);
+    else
+       seg1r=seg1;
+
+    if(first==NO_SEGMENT)
+       seg2=supersegment;
+    else if(forwards)
+       seg2=LookupPathSegment(segments,first+i);
+    else
+       seg2=LookupPathSegment(segments,first+npath-1-i);
+
+    segment=LookupSegment(segments,seg2,1);
+
+    /* must join on to the previous segment */
+    if(segment->node1!=node1 && segment->node2!=node1)
+       goto failed;
+
+    node2=OtherNode(segment,node1);
+
+    /* must obey one-way restrictions (unless profile allows) */
+    if(profile->oneway && IsOnewayTo(segment,node1))
+       goto failed;
+
+    /* must not perform U-turn (unless profile allows) */
+    if(profile->turns && (seg1==seg2 || seg1r==seg2))
+       goto failed;
+
+    node1p=LookupNode(nodes,node1,1);
+
+    /* must obey turn relations */
+    if(profile->turns && IsTurnRestrictedNode(node1p))
+      {
+       turnrelation=FindFirstTurnRelation2(relations,node1,seg1r);
+
+       if(turnrelation!=NO_RELATION && !IsTurnAllowed(relations,turnrelation,node1,seg1r,seg2,profile->allow))
+          goto failed;
+      }
+
+    way=LookupWay(ways,segment->way,1);
+
+    /* mode of transport must be allowed on the highway */
+    if(!(way->allow&profile->allow))
+       goto failed;
+
+    /* must obey weight restriction (if exists) */
+    if(way->weight && way->weight<profile->weight)
+       goto failed;
+
+    /* must obey height/width/length restriction (if exists) */
+    if((way->height && way->height<profile->height) ||
+       (way->width  && way->width <profile->width ) ||
+       (way->length && way->length<profile->length))
+       goto failed;
+
+    segment_pref=WayPreference(profile,way);
+
+    /* profile preferences must allow this highway */
+    if(segment_pref==0)
+       goto failed;
+
+    node2p=LookupNode(nodes,node2,2);
+
+    /* mode of transport must be allowed through node2 */
+    if(!(node2p->allow&profile->allow))
+       goto failed;
+
+    if(option_quickest==0)
+       segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+    else
+       segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
+
+    /* must not loop back to a node/segment that is already in the route */
+    if(FindResult(results,node2,seg2))
+       goto failed;
+
+    result2=InsertResult(results,node2,seg2);
+    result2->prev=result1;
+    result2->score=result1->score+segment_score;
+
+    result1=result2;
+   }
+
+ /* must finish at the other end of the super-segment */
+ if(result1->node!=finish_node)
+    goto failed;
+
+ FixForwardRoute(results,result1);
+
+ return(results);
+
+ failed:
+
+ FreeResultsList(results);
+
+ return(NULL);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Fix the forward route (i.e. setup next pointers for forward path from prev nodes on reverse path).
+
+  Results *results The set of results to update.
+
+  Result *finish_result The result for the finish point.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void FixForwardRoute(Results *results,Result *finish_result)
+{
+ Result *result2=finish_result;
+
+ /* Erase the old route if there is one */
+
+ if(results->finish_node!=NO_NODE)
+   {
+    Result *result1=FirstResult(results);
+
+    while(result1)
+      {
+       result1->next=NULL;
+
+       result1=NextResult(results,result1);
+      }
+   }
+
+ /* Create the forward links for the optimum path */
+
+ do
+   {
+    Result *result1;
+
+    if(result2->prev)
+      {
+       index_t node1=result2->prev->node;
+       index_t seg1=result2->prev->segment;
+
+       result1=FindResult(results,node1,seg1);
+
+       assert(!result1->next);   /* Bugs elsewhere can lead to infinite loop here. */
+
+       result1->next=result2;
+
+       result2=result1;
+      }
+    else
+       result2=NULL;
+   }
+ while(result2);
+
+ results->finish_node=finish_result->node;
+ results->last_segment=finish_result->segment;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Join the part of a route found by a backward search onto the end of the part found by a forward search.
+
+  Result *JoinBidirectionalRoute Returns the result at the end of the joined route.
+
+  Results *results The set of results from the forward search (to add the joined route to).
+
+  Result *forward The result where the forward search met the backward search.
+
+  Result *backward The first result from the backward search after the meeting point (or NULL if there is none).
+
+  score_t score The score of the complete route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Result *JoinBidirectionalRoute(Results *results,Result *forward,Result *backward,score_t score)
+{
+ while(backward)
+   {
+    Result *result=FindResult(results,backward->node,backward->segment);
+
+    if(!result)
+       result=InsertResult(results,backward->node,backward->segment);
+
+    result->prev=forward;
+    result->score=score-backward->score;
+
+    forward=result;
+
+    backward=backward->next;
+   }
+
+ return(forward);
+}
+
 
-       for(i=1;i<Property_Count;i++)
-          if(ways->file.props & PROPERTIES(i))
-            {
-             if(way->props & PROPERTIES(i))
-                segment_pref*=profile->props_yes[i];
-             else
-                segment_pref*=profile->props_no[i];
-            }
+/*++++++++++++++++++++++++++++++++++++++
+  Insert the node at one end of a route into the results and queue for a search of a contraction
+  hierarchy (or if it is a fake node then the real nodes at the ends of its fake segments).
 
-       /* profile preferences must allow this highway */
-       if(segment_pref==0)
-          goto endloop;
+  Results *results The set of results to insert the node(s) into.
 
-       if(!IsFakeNode(node2))
-          node2p=LookupNode(nodes,node2,2);
+  Queue *queue The queue to insert the result(s) into.
 
-       /* mode of transport must be allowed through node2 */
-       if(node2p && !(node2p->allow&profile->allow))
-          goto endloop;
+  Nodes *nodes The set of nodes to use.
 
-       if(option_quickest==0)
-          segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
-       else
-          segment_score=(score_t)Duration(segment,way,profile)/segment_pref;
+  Ways *ways The set of ways to use.
 
-       cumulative_score=result1->score+segment_score;
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
 
-       result2=FindResult(results,node2,seg2);
+  index_t node The node at the end of the route.
 
-       if(!result2) /* New end node */
-         {
-          result2=InsertResult(results,node2,seg2);
-          result2->next=result1;   /* working backwards */
-          result2->score=cumulative_score;
+  int finish Set to 1 if the node is the finish node (to follow the fake segments towards it) or 0 for the start node.
+  ++++++++++++++++++++++++++++++++++++++*/
 
-          if(IsFakeNode(node1) || (!IsFakeNode(node1) && !IsSuperNode(node1p))) /* Overshoot by one segment */
-            {
-             result2->sortby=result2->score;
-             InsertInQueue(queue,result2);
-            }
-         }
-       else if(cumulative_score<result2->score) /* New end node is better */
-         {
-          result2->next=result1; /* working backwards */
-          result2->score=cumulative_score;
+static void InsertContractedEnd(Results *results,Queue *queue,Nodes *nodes,Ways *ways,Profile *profile,index_t node,int finish)
+{
+ Segment *segment;
+ Result *result;
 
-          if(IsFakeNode(node1) || (!IsFakeNode(node1) && !IsSuperNode(node1p))) /* Overshoot by one segment */
-            {
-             result2->sortby=result2->score;
-             InsertInQueue(queue,result2);
-            }
-         }
+ if(!IsFakeNode(node))
+   {
+    result=InsertResult(results,node,NO_SEGMENT);
 
-      endloop:
+    InsertInQueue(queue,result);
 
-       if(IsFakeNode(node1))
-          segment=NextFakeSegment(segment,node1);
-       else
-          segment=NextSegment(segments,segment,node1);
-      }
+    return;
    }
 
- FreeQueueList(queue);
+ for(segment=FirstFakeSegment(node);segment;segment=NextFakeSegment(segment,node))
+   {
+    Way *way;
+    index_t othernode;
+    score_t segment_pref,segment_score;
 
- /* Check it worked */
+    othernode=OtherNode(segment,node);
 
- if(results->number==1)
-   {
-    FreeResultsList(results);
-    return(NULL);
-   }
+    /* must not be a segment to another fake node */
+    if(IsFakeNode(othernode))
+       continue;
 
- /* Create a results structure with the node at the end of the segment opposite the start */
+    /* must obey one-way restrictions (unless profile allows) */
+    if(profile->oneway && IsOnewayTo(segment,finish?othernode:node))
+       continue;
 
- results2=NewResultsList(64);
+    way=LookupWay(ways,segment->way,1);
 
- results2->finish_node=results->finish_node;
+    /* mode of transport must be allowed on the highway */
+    if(!(way->allow&profile->allow))
+       continue;
 
- result3=FirstResult(results);
+    /* must obey weight restriction (if exists) */
+    if(way->weight && way->weight<profile->weight)
+       continue;
 
- while(result3)
-   {
-    if(result3->next)
-      {
-       result2=InsertResult(results2,result3->next->node,result3->segment);
+    /* must obey height/width/length restriction (if exists) */
+    if((way->height && way->height<profile->height) ||
+       (way->width  && way->width <profile->width ) ||
+       (way->length && way->length<profile->length))
+       continue;
 
-       result2->score=result3->next->score;
-      }
+    segment_pref=WayPreference(profile,way);
 
-    result3=NextResult(results,result3);
-   }
+    /* profile preferences must allow this highway */
+    if(segment_pref==0)
+       continue;
 
- /* Fix up the result->next pointers */
+    /* mode of transport must be allowed through the real node */
+    if(!finish && !(LookupNode(nodes,othernode,1)->allow&profile->allow))
+       continue;
 
- result3=FirstResult(results);
+    if(option_quickest==0)
+       segment_score=(score_t)DISTANCE(segment->distance)/segment_pref;
+    else
+       segment_score=(score_t)(ExactDuration(segment,way,profile)/segment_pref);
 
- while(result3)
-   {
-    if(result3->next && result3->next->next)
+    result=FindResult1(results,othernode);
+
+    if(!result)
       {
-       result1=FindResult(results2,result3->next->node,result3->segment);
-       result2=FindResult(results2,result3->next->next->node,result3->next->segment);
+       result=InsertResult(results,othernode,IndexFakeSegment(segment));
+       result->score=segment_score;
+       result->sortby=segment_score;
 
-       result1->next=result2;
+       InsertInQueue(queue,result);
       }
+    else if(segment_score<result->score)
+      {
+       result->segment=IndexFakeSegment(segment);
+       result->score=segment_score;
+       result->sortby=segment_score;
 
-    result3=NextResult(results,result3);
+       InsertInQueue(queue,result);
+      }
    }
-
- FreeResultsList(results);
-
- return(results2);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Create an optimum route given the set of super-nodes to follow.
+  Append the segments that an edge of a contraction hierarchy replaces to a list of segments.
 
-  Results *CombineRoutes Returns the results from joining the super-nodes.
+  Contraction *contraction The contraction hierarchy to use.
 
-  Nodes *nodes The set of nodes to use.
+  index_t edge The edge to unpack (or NO_SEGMENT to append a single segment instead).
 
-  Segments *segments The set of segments to use.
+  index_t segment The segment to append if there is no edge (the fake segment at the start or finish).
 
-  Ways *ways The set of ways to use.
+  score_t score The score of the segment to append if there is no edge.
 
-  Relations *relations The set of relations to use.
+  index_t **route The list of segments to append to.
 
-  Profile *profile The profile containing the transport type, speeds and allowed highways.
+  score_t **scores The list of scores of the segments to append to.
 
-  Results *begin The set of results for the start of the route.
+  int *nroute The number of segments in the list.
 
-  Results *middle The set of results from the super-node route.
+  int *aroute The allocated length of the lists.
   ++++++++++++++++++++++++++++++++++++++*/
 
-Results *CombineRoutes(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Results *begin,Results *middle)
+static void UnpackContractedEdge(Contraction *contraction,index_t edge,index_t segment,score_t score,
+                                 index_t **route,score_t **scores,int *nroute,int *aroute)
 {
- Result *midres,*comres1;
- Results *combined;
+ ContractionEdge edgestore,*edgep;
+ index_t child1,child2;
 
- combined=NewResultsList(256);
-
- combined->start_node=begin->start_node;
- combined->prev_segment=begin->prev_segment;
+ if(edge!=NO_SEGMENT)
+   {
+    edgep=LookupContractionEdge(contraction,edge,&edgestore);
 
- /* Insert the start point */
+    child1=edgep->child1;
+    child2=edgep->child2;
 
- midres=FindResult(middle,middle->start_node,middle->prev_segment);
+    if(!IsSegmentEdge(edgep))
+      {
+       UnpackContractedEdge(contraction,child1,NO_SEGMENT,0,route,scores,nroute,aroute);
+       UnpackContractedEdge(contraction,child2,NO_SEGMENT,0,route,scores,nroute,aroute);
 
- comres1=InsertResult(combined,combined->start_node,combined->prev_segment);
+       return;
+      }
 
- /* Insert the start of the route */
+    segment=child1;
+    score=edgep->score;
+   }
 
- if(begin->number>1 && midres->next)
+ if(*nroute==*aroute)
    {
-    Result *begres;
-
-    midres=FindResult(middle,midres->next->node,midres->next->segment);
+    *aroute+=64;
 
-    begres=FindResult(begin,midres->node,midres->segment);
+    *route =(index_t*)realloc((void*)*route ,*aroute*sizeof(index_t));
+    *scores=(score_t*)realloc((void*)*scores,*aroute*sizeof(score_t));
+   }
 
-    FixForwardRoute(begin,begres);
+ (*route)[*nroute]=segment;
+ (*scores)[*nroute]=score;
 
-    if(midres->next && midres->next->node==midres->node)
-       midres=midres->next;
+ (*nroute)++;
+}
 
-    begres=FindResult(begin,begin->start_node,begin->prev_segment);
 
-    begres=begres->next;
+/*++++++++++++++++++++++++++++++++++++++
+  Prepare to estimate the lowest possible score from any node to a finish node.
 
-    do
-      {
-       Result *comres2;
+  Estimate *estimate Returns the information needed for the estimates.
 
-       comres2=InsertResult(combined,begres->node,begres->segment);
+  Nodes *nodes The set of nodes to use.
 
-       comres2->score=begres->score+comres1->score;
-       comres2->prev=comres1;
+  index_t finish_node The finish node.
+  ++++++++++++++++++++++++++++++++++++++*/
 
-       begres=begres->next;
+static void InitEstimate(Estimate *estimate,Nodes *nodes,index_t finish_node)
+{
+ if(IsFakeNode(finish_node))
+    GetFakeLatLong(finish_node,&estimate->finish_lat,&estimate->finish_lon);
+ else
+    GetLatLong(nodes,finish_node,&estimate->finish_lat,&estimate->finish_lon);
 
-       comres1=comres2;
-      }
-    while(begres);
-   }
+ estimate->nlandmarks=FindNodeLandmarks(nodes,finish_node,estimate->landmarks);
+}
 
- /* Sort out the combined route */
 
- do
-   {
-    Result *result;
+/*++++++++++++++++++++++++++++++++++++++
+  Estimate the lowest possible score from a node to the finish node using the straight
+  line distance and the distances from the landmarks (if there are any).
 
-    if(midres->next)
-      {
-       Results *results=FindNormalRoute(nodes,segments,ways,relations,profile,comres1->node,comres1->segment,midres->next->node);
+  score_t EstimateScore Returns the estimated score (never more than the actual score).
 
-       if(!results)
-          return(NULL);
+  Estimate *estimate The information from InitEstimate().
 
-       result=FindResult(results,midres->node,comres1->segment);
+  Nodes *nodes The set of nodes to use.
 
-       result=result->next;
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
 
-       /*
-        *      midres                          midres->next
-        *         =                                  =
-        *      ---*----------------------------------*  = middle
-        *
-        *      ---*----.----.----.----.----.----.----*  = results
-        *              =
-        *             result
-        *
-        *      ---*----.----.----.----.----.----.----*  = combined
-        *         =    =
-        *   comres1  comres2
-        */
+  index_t node The node to start from.
+  ++++++++++++++++++++++++++++++++++++++*/
 
-       do
-         {
-          Result *comres2;
+static score_t EstimateScore(Estimate *estimate,Nodes *nodes,Profile *profile,index_t node)
+{
+ double lat,lon;
+ distance_t direct;
 
-          comres2=InsertResult(combined,result->node,result->segment);
+ if(IsFakeNode(node))
+    GetFakeLatLong(node,&lat,&lon);
+ else
+    GetLatLong(nodes,node,&lat,&lon);
 
-          comres2->score=result->score+comres1->score;
-          comres2->prev=comres1;
+ direct=Distance(lat,lon,estimate->finish_lat,estimate->finish_lon);
 
-          result=result->next;
+ /* The difference in the distances from a landmark is also a lower limit */
 
-          comres1=comres2;
-         }
-       while(result);
+ if(estimate->nlandmarks)
+   {
+    distance_t landmarks[MAX_LANDMARKS];
+    int i,n;
 
-       FreeResultsList(results);
-      }
+    n=FindNodeLandmarks(nodes,node,landmarks);
 
-    midres=midres->next;
+    for(i=0;i<n;i++)
+       if(landmarks[i]!=INF_DISTANCE && estimate->landmarks[i]!=INF_DISTANCE)
+         {
+          if(landmarks[i]>estimate->landmarks[i] && (landmarks[i]-estimate->landmarks[i])>direct)
+             direct=landmarks[i]-estimate->landmarks[i];
+          else if(estimate->landmarks[i]>landmarks[i] && (estimate->landmarks[i]-landmarks[i])>direct)
+             direct=estimate->landmarks[i]-landmarks[i];
+         }
    }
- while(midres);
-
- FixForwardRoute(combined,comres1);
 
- return(combined);
+ if(option_quickest==0)
+    return((score_t)direct/profile->max_pref);
+ else
+    return((score_t)distance_speed_to_duration(direct,profile->max_speed)/profile->max_pref);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Fix the forward route (i.e. setup next pointers for forward path from prev nodes on reverse path).
+  Find the distances from each of the landmarks to a node (for a fake node the shortest
+  distance via the real nodes at each end of its segment).
 
-  Results *results The set of results to update.
+  int FindNodeLandmarks Returns the number of distances (0 if there are no landmarks).
 
-  Result *finish_result The result for the finish point.
+  Nodes *nodes The set of nodes to use.
+
+  index_t node The node (may be a fake node).
+
+  distance_t *distances Returns the distances.
   ++++++++++++++++++++++++++++++++++++++*/
 
-void FixForwardRoute(Results *results,Result *finish_result)
+static int FindNodeLandmarks(Nodes *nodes,index_t node,distance_t *distances)
 {
- Result *result2=finish_result;
+ Segment *segment;
+ int i,n=0;
 
- /* Erase the old route if there is one */
+ if(nodes->nlandmarks==0)
+    return(0);
 
- if(results->finish_node!=NO_NODE)
+ if(!IsFakeNode(node))
+    return(GetLandmarkDistances(nodes,node,distances));
+
+ for(i=0;i<nodes->nlandmarks;i++)
+    distances[i]=INF_DISTANCE;
+
+ for(segment=FirstFakeSegment(node);segment;segment=NextFakeSegment(segment,node))
    {
-    Result *result1=FirstResult(results);
+    distance_t others[MAX_LANDMARKS];
+    index_t othernode=OtherNode(segment,node);
 
-    while(result1)
-      {
-       result1->next=NULL;
+    if(IsFakeNode(othernode))
+       continue;
 
-       result1=NextResult(results,result1);
-      }
+    n=GetLandmarkDistances(nodes,othernode,others);
+
+    for(i=0;i<n;i++)
+       if(others[i]!=INF_DISTANCE && (others[i]+DISTANCE(segment->distance))<distances[i])
+          distances[i]=others[i]+DISTANCE(segment->distance);
    }
 
- /* Create the forward links for the optimum path */
+ return(nodes->nlandmarks);
+}
 
- do
-   {
-    Result *result1;
 
-    if(result2->prev)
-      {
-       index_t node1=result2->prev->node;
-       index_t seg1=result2->prev->segment;
+/*++++++++++++++++++++++++++++++++++++++
+  Sort the node indexes into order (for the list of finish nodes).
 
-       result1=FindResult(results,node1,seg1);
+  int sort_by_index Returns the comparison of the two indexes.
 
-       assert(!result1->next);   /* Bugs elsewhere can lead to infinite loop here. */
+  index_t *a The first index.
 
-       result1->next=result2;
+  index_t *b The second index.
+  ++++++++++++++++++++++++++++++++++++++*/
 
-       result2=result1;
-      }
+static int sort_by_index(index_t *a,index_t *b)
+{
+ if(*a<*b)
+    return(-1);
+ else if(*a>*b)
+    return(1);
+ else
+    return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the position of a node in the sorted list of finish nodes.
+
+  int find_target Returns the position in the list or -1 if it is not in the list.
+
+  index_t *targets The sorted list of finish nodes.
+
+  int ntargets The number of finish nodes.
+
+  index_t node The node to look for.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int find_target(index_t *targets,int ntargets,index_t node)
+{
+ int start=0,end=ntargets-1;
+
+ while(start<=end)
+   {
+    int mid=(start+end)/2;
+
+    if(targets[mid]<node)
+       start=mid+1;
+    else if(targets[mid]>node)
+       end=mid-1;
     else
-       result2=NULL;
+       return(mid);
    }
- while(result2);
 
- results->finish_node=finish_result->node;
- results->last_segment=finish_result->segment;
+ return(-1);
 }
@@ -33,10 +33,13 @@
 #include "segments.h"
 #include "ways.h"
 
+#include "files.h"
 #include "functions.h"
+#include "formatting.h"
 #include "fakes.h"
 #include "translations.h"
 #include "results.h"
+#include "routestore.h"
 #include "xmlparse.h"
 
 
@@ -54,6 +57,35 @@
 #define IMP_UTURN        8      /*+ The location of a U-turn. +*/
 #define IMP_WAYPOINT     9      /*+ A waypoint. +*/
 
+/*+ The scale factor for the coordinates in the binary route file (degrees to integer). +*/
+#define BINARY_SCALE 1.0E7
+
+/*+ The scale factor for the coordinates in the encoded polyline (degrees to integer). +*/
+#define POLYLINE_SCALE 1.0E5
+
+/*+ The size of the buffer used for writing each of the output files. +*/
+#define OUTPUT_BUFFER_SIZE (256*1024)
+
+/*+ The EWKB geometry type of a LineString with an SRID. +*/
+#define EWKB_LINESTRING_SRID 0x20000002
+
+/*+ The SRID of the coordinates in the EWKB geometry (WGS84 latitude and longitude). +*/
+#define EWKB_SRID 4326
+
+
+/* Local types */
+
+/*+ A point in the binary route file (the file contains only the points in order). +*/
+typedef struct _BinaryRoutePoint
+{
+ int32_t    latitude;           /*+ The latitude (degrees multiplied by BINARY_SCALE). +*/
+ int32_t    longitude;          /*+ The longitude (degrees multiplied by BINARY_SCALE). +*/
+
+ distance_t distance;           /*+ The total distance from the start of the route. +*/
+ duration_t duration;           /*+ The total duration from the start of the route. +*/
+}
+ BinaryRoutePoint;
+
 
 /* Global variables */
 
@@ -62,6 +94,11 @@ extern int option_quickest;
 
 /*+ The options to select the format of the output. +*/
 extern int option_html,option_gpx_track,option_gpx_route,option_text,option_text_all;
+extern int option_binary,option_polyline,option_geojson;
+
+/*+ The options to select where the output is written. +*/
+extern char *option_output_dir,*option_output_prefix;
+extern int option_output_stdout;
 
 
 /* Local variables */
@@ -85,6 +122,18 @@ static char junction_other_way[Way_Count][Way_Count]=
  };
 
 
+/* Local functions */
+
+static FILE *OpenOutputFile(const char *name);
+static void CloseOutputFile(FILE *file);
+
+static void PrintPolylineValue(FILE *file,int32_t value);
+
+static void PrintCopyText(FILE *file,const char *text);
+static void PrintHexUint32(FILE *file,uint32_t value);
+static void PrintHexDouble(FILE *file,double value);
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Print the optimum route between two nodes.
 
@@ -104,6 +153,8 @@ static char junction_other_way[Way_Count][Way_Count]=
 void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile)
 {
  FILE *htmlfile=NULL,*gpxtrackfile=NULL,*gpxroutefile=NULL,*textfile=NULL,*textallfile=NULL;
+ FILE *binaryfile=NULL,*polylinefile=NULL,*geojsonfile=NULL;
+ int32_t polyline_lat=0,polyline_lon=0;
 
  char *prev_bearing=NULL,*prev_wayname=NULL;
  distance_t cum_distance=0;
@@ -111,8 +162,9 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
  int point=1;
  int segment_count=0,route_count=0;
- int point_count=0;
+ int point_count=0,track_count=0;
  int roundabout=0;
+ int describe;
 
  /* Open the files */
 
@@ -121,54 +173,48 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
     /* Print the result for the shortest route */
 
     if(option_html)
-       htmlfile    =fopen("shortest.html","w");
+       htmlfile    =OpenOutputFile("shortest.html");
     if(option_gpx_track)
-       gpxtrackfile=fopen("shortest-track.gpx","w");
+       gpxtrackfile=OpenOutputFile("shortest-track.gpx");
     if(option_gpx_route)
-       gpxroutefile=fopen("shortest-route.gpx","w");
+       gpxroutefile=OpenOutputFile("shortest-route.gpx");
     if(option_text)
-       textfile    =fopen("shortest.txt","w");
+       textfile    =OpenOutputFile("shortest.txt");
     if(option_text_all)
-       textallfile =fopen("shortest-all.txt","w");
-
-    if(option_html && !htmlfile)
-       fprintf(stderr,"Warning: Cannot open file 'shortest.html' for writing [%s].\n",strerror(errno));
-    if(option_gpx_track && !gpxtrackfile)
-       fprintf(stderr,"Warning: Cannot open file 'shortest-track.gpx' for writing [%s].\n",strerror(errno));
-    if(option_gpx_route && !gpxroutefile)
-       fprintf(stderr,"Warning: Cannot open file 'shortest-route.gpx' for writing [%s].\n",strerror(errno));
-    if(option_text && !textfile)
-       fprintf(stderr,"Warning: Cannot open file 'shortest.txt' for writing [%s].\n",strerror(errno));
-    if(option_text_all && !textallfile)
-       fprintf(stderr,"Warning: Cannot open file 'shortest-all.txt' for writing [%s].\n",strerror(errno));
+       textallfile =OpenOutputFile("shortest-all.txt");
+    if(option_binary)
+       binaryfile  =OpenOutputFile("shortest.bin");
+    if(option_polyline)
+       polylinefile=OpenOutputFile("shortest.polyline");
+    if(option_geojson)
+       geojsonfile =OpenOutputFile("shortest.geojson");
    }
  else
    {
     /* Print the result for the quickest route */
 
     if(option_html)
-       htmlfile    =fopen("quickest.html","w");
+       htmlfile    =OpenOutputFile("quickest.html");
     if(option_gpx_track)
-       gpxtrackfile=fopen("quickest-track.gpx","w");
+       gpxtrackfile=OpenOutputFile("quickest-track.gpx");
     if(option_gpx_route)
-       gpxroutefile=fopen("quickest-route.gpx","w");
+       gpxroutefile=OpenOutputFile("quickest-route.gpx");
     if(option_text)
-       textfile    =fopen("quickest.txt","w");
+       textfile    =OpenOutputFile("quickest.txt");
     if(option_text_all)
-       textallfile =fopen("quickest-all.txt","w");
-
-    if(option_html && !htmlfile)
-       fprintf(stderr,"Warning: Cannot open file 'quickest.html' for writing [%s].\n",strerror(errno));
-    if(option_gpx_track && !gpxtrackfile)
-       fprintf(stderr,"Warning: Cannot open file 'quickest-track.gpx' for writing [%s].\n",strerror(errno));
-    if(option_gpx_route && !gpxroutefile)
-       fprintf(stderr,"Warning: Cannot open file 'quickest-route.gpx' for writing [%s].\n",strerror(errno));
-    if(option_text && !textfile)
-       fprintf(stderr,"Warning: Cannot open file 'quickest.txt' for writing [%s].\n",strerror(errno));
-    if(option_text_all && !textallfile)
-       fprintf(stderr,"Warning: Cannot open file 'quickest-all.txt' for writing [%s].\n",strerror(errno));
+       textallfile =OpenOutputFile("quickest-all.txt");
+    if(option_binary)
+       binaryfile  =OpenOutputFile("quickest.bin");
+    if(option_polyline)
+       polylinefile=OpenOutputFile("quickest.polyline");
+    if(option_geojson)
+       geojsonfile =OpenOutputFile("quickest.geojson");
    }
 
+ /* The junctions only need to be found for the formats that describe them */
+
+ describe=(htmlfile || gpxroutefile || textfile || textallfile);
+
  /* Print the head of the files */
 
  if(htmlfile)
@@ -303,6 +349,9 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
                         /* "%10.6f\t%11.6f\t%8d%c\t%s\t%5.3f\t%5.2f\t%5.2f\t%5.1f\t%3d\t%4d\t%s\n" */
    }
 
+ if(geojsonfile)
+    fprintf(geojsonfile,"{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\",\"coordinates\":[");
+
  /* Loop through all the sections of the route and print them */
 
  while(!results[point])
@@ -314,6 +363,7 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
     distance_t junc_distance=0;
     duration_t junc_duration=0;
     Result *result;
+    int section_start=1;
 
     result=FindResult(results[point],results[point]->start_node,results[point]->prev_segment);
 
@@ -340,6 +390,7 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
        char *waynameraw=NULL,*wayname=NULL,*next_waynameraw=NULL,*next_wayname=NULL;
        int bearing_int=0,turn_int=0,next_bearing_int=0;
        char *turn=NULL,*next_bearing=NULL;
+       char latstr[24]="",lonstr[24]="";
 
        /* Calculate the information about this point */
 
@@ -351,6 +402,12 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
        if(!IsFakeNode(result->node))
           resultnode=LookupNode(nodes,result->node,6);
 
+       if(gpxtrackfile || textallfile || geojsonfile) /* formats with every point */
+         {
+          FormatFixed(latstr,radians_to_degrees(latitude),6);
+          FormatFixed(lonstr,radians_to_degrees(longitude),6);
+         }
+
        /* Calculate the next result */
 
        next_result=result->next;
@@ -392,9 +449,9 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
           cum_duration+=seg_duration;
          }
 
-       /* Calculate the information about the next segment */
+       /* Calculate the information about the next segment (only needed to describe the junctions) */
 
-       if(next_result)
+       if(describe && next_result)
          {
           if(IsFakeSegment(next_result->segment))
             {
@@ -410,7 +467,7 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
        /* Decide if this is a roundabout */
 
-       if(next_result)
+       if(describe && next_result)
          {
           next_resultway=LookupWay(ways,next_resultsegment->way,2);
 
@@ -457,7 +514,9 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
        /* Decide if this is an important junction */
 
-       if(roundabout)           /* roundabout */
+       if(!describe)            /* no junctions are described */
+          ;
+       else if(roundabout)      /* roundabout */
           ;
        else if(point_count==0)  /* first point overall = Waypoint */
           important=IMP_WAYPOINT;
@@ -547,6 +606,12 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
        if(important>IMP_JUNCT_CONT)
          {
+          if(!*latstr)          /* formats with only the important points */
+            {
+             FormatFixed(latstr,radians_to_degrees(latitude),6);
+             FormatFixed(lonstr,radians_to_degrees(longitude),6);
+            }
+
           if(htmlfile)
             {
              char *type;
@@ -572,9 +637,9 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
                }
 
              /* <tr class='c'><td class='l'>*N*:<td class='r'>*latitude* *longitude* */
-             fprintf(htmlfile,"<tr class='c'><td class='l'>%d:<td class='r'>%.6f %.6f\n",
+             fprintf(htmlfile,"<tr class='c'><td class='l'>%d:<td class='r'>%s %s\n",
                               point_count+1,
-                              radians_to_degrees(latitude),radians_to_degrees(longitude));
+                              latstr,lonstr);
 
              if(point_count==0) /* first point */
                {
@@ -638,14 +703,14 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
              if(point_count==0) /* first point */
                {
-                fprintf(gpxroutefile,"<rtept lat=\"%.6f\" lon=\"%.6f\"><name>%s</name>\n",
-                                     radians_to_degrees(latitude),radians_to_degrees(longitude),
+                fprintf(gpxroutefile,"<rtept lat=\"%s\" lon=\"%s\"><name>%s</name>\n",
+                                     latstr,lonstr,
                                      translate_gpx_start);
                }
              else if(!next_result) /* end point */
                {
-                fprintf(gpxroutefile,"<rtept lat=\"%.6f\" lon=\"%.6f\"><name>%s</name>\n",
-                                     radians_to_degrees(latitude),radians_to_degrees(longitude),
+                fprintf(gpxroutefile,"<rtept lat=\"%s\" lon=\"%s\"><name>%s</name>\n",
+                                     latstr,lonstr,
                                      translate_gpx_finish);
                 fprintf(gpxroutefile,"<desc>");
                 fprintf(gpxroutefile,translate_gpx_final,
@@ -655,12 +720,12 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
              else            /* middle point */
                {
                 if(important==IMP_WAYPOINT)
-                   fprintf(gpxroutefile,"<rtept lat=\"%.6f\" lon=\"%.6f\"><name>%s%d</name>\n",
-                                        radians_to_degrees(latitude),radians_to_degrees(longitude),
+                   fprintf(gpxroutefile,"<rtept lat=\"%s\" lon=\"%s\"><name>%s%d</name>\n",
+                                        latstr,lonstr,
                                         translate_gpx_inter,++segment_count);
                 else
-                   fprintf(gpxroutefile,"<rtept lat=\"%.6f\" lon=\"%.6f\"><name>%s%03d</name>\n",
-                                        radians_to_degrees(latitude),radians_to_degrees(longitude),
+                   fprintf(gpxroutefile,"<rtept lat=\"%s\" lon=\"%s\"><name>%s%03d</name>\n",
+                                        latstr,lonstr,
                                         translate_gpx_trip,++route_count);
                }
             }
@@ -676,8 +741,8 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
              if(point_count==0) /* first point */
                {
-                fprintf(textfile,"%10.6f\t%11.6f\t%6.3f km\t%4.1f min\t%5.1f km\t%4.0f min\t%s\t\t %+d\t%s\n",
-                                 radians_to_degrees(latitude),radians_to_degrees(longitude),
+                fprintf(textfile,"%10s\t%11s\t%6.3f km\t%4.1f min\t%5.1f km\t%4.0f min\t%s\t\t %+d\t%s\n",
+                                 latstr,lonstr,
                                  0.0,0.0,0.0,0.0,
                                  type,
                                  ((22+next_bearing_int)/45+4)%8-4,
@@ -685,16 +750,16 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
                }
              else if(!next_result) /* end point */
                {
-                fprintf(textfile,"%10.6f\t%11.6f\t%6.3f km\t%4.1f min\t%5.1f km\t%4.0f min\t%s\t\t\t\n",
-                                 radians_to_degrees(latitude),radians_to_degrees(longitude),
+                fprintf(textfile,"%10s\t%11s\t%6.3f km\t%4.1f min\t%5.1f km\t%4.0f min\t%s\t\t\t\n",
+                                 latstr,lonstr,
                                  distance_to_km(junc_distance),duration_to_minutes(junc_duration),
                                  distance_to_km(cum_distance),duration_to_minutes(cum_duration),
                                  type);
                }
              else               /* middle point */
                {
-                fprintf(textfile,"%10.6f\t%11.6f\t%6.3f km\t%4.1f min\t%5.1f km\t%4.0f min\t%s\t %+d\t %+d\t%s\n",
-                                 radians_to_degrees(latitude),radians_to_degrees(longitude),
+                fprintf(textfile,"%10s\t%11s\t%6.3f km\t%4.1f min\t%5.1f km\t%4.0f min\t%s\t %+d\t %+d\t%s\n",
+                                 latstr,lonstr,
                                  distance_to_km(junc_distance),duration_to_minutes(junc_duration),
                                  distance_to_km(cum_distance),duration_to_minutes(cum_duration),
                                  type,
@@ -731,8 +796,40 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
        /* Print out all of the results */
 
        if(gpxtrackfile)
-          fprintf(gpxtrackfile,"<trkpt lat=\"%.6f\" lon=\"%.6f\"/>\n",
-                               radians_to_degrees(latitude),radians_to_degrees(longitude));
+          fprintf(gpxtrackfile,"<trkpt lat=\"%s\" lon=\"%s\"/>\n",latstr,lonstr);
+
+       if(!section_start || track_count==0) /* the waypoints that join the sections only once */
+         {
+          if(binaryfile)
+            {
+             BinaryRoutePoint routepoint;
+
+             routepoint.latitude =(int32_t)lrint(radians_to_degrees(latitude)*BINARY_SCALE);
+             routepoint.longitude=(int32_t)lrint(radians_to_degrees(longitude)*BINARY_SCALE);
+
+             routepoint.distance=cum_distance;
+             routepoint.duration=cum_duration;
+
+             fwrite(&routepoint,sizeof(BinaryRoutePoint),1,binaryfile);
+            }
+
+          if(polylinefile)
+            {
+             int32_t lat=(int32_t)lrint(radians_to_degrees(latitude)*POLYLINE_SCALE);
+             int32_t lon=(int32_t)lrint(radians_to_degrees(longitude)*POLYLINE_SCALE);
+
+             PrintPolylineValue(polylinefile,lat-polyline_lat);
+             PrintPolylineValue(polylinefile,lon-polyline_lon);
+
+             polyline_lat=lat;
+             polyline_lon=lon;
+            }
+
+          if(geojsonfile)
+             fprintf(geojsonfile,"%s[%s,%s]",track_count?",":"",lonstr,latstr);
+
+          track_count++;
+         }
 
        if(important>IMP_IGNORE)
          {
@@ -755,20 +852,26 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
              if(point_count==0) /* first point */
                {
-                fprintf(textallfile,"%10.6f\t%11.6f\t%8d%c\t%s\t%5.3f\t%5.2f\t%5.2f\t%5.1f\t\t\t\n",
-                                    radians_to_degrees(latitude),radians_to_degrees(longitude),
+                fprintf(textallfile,"%10s\t%11s\t%8d%c\t%s\t%5.3f\t%5.2f\t%5.2f\t%5.1f\t\t\t\n",
+                                    latstr,lonstr,
                                     IsFakeNode(result->node)?(NODE_FAKE-result->node):result->node,
                                     (resultnode && IsSuperNode(resultnode))?'*':' ',type,
                                     0.0,0.0,0.0,0.0);
                }
              else               /* not the first point */
                {
-                fprintf(textallfile,"%10.6f\t%11.6f\t%8d%c\t%s\t%5.3f\t%5.2f\t%5.2f\t%5.1f\t%3d\t%4d\t%s\n",
-                                    radians_to_degrees(latitude),radians_to_degrees(longitude),
+                char segdist[24],segdur[24],cumdist[24],cumdur[24];
+
+                FormatFixed(segdist,distance_to_km(seg_distance),3);
+                FormatFixed(segdur ,duration_to_minutes(seg_duration),2);
+                FormatFixed(cumdist,distance_to_km(cum_distance),2);
+                FormatFixed(cumdur ,duration_to_minutes(cum_duration),1);
+
+                fprintf(textallfile,"%10s\t%11s\t%8d%c\t%s\t%5s\t%5s\t%5s\t%5s\t%3d\t%4d\t%s\n",
+                                    latstr,lonstr,
                                     IsFakeNode(result->node)?(NODE_FAKE-result->node):result->node,
                                     (resultnode && IsSuperNode(resultnode))?'*':' ',type,
-                                    distance_to_km(seg_distance),duration_to_minutes(seg_duration),
-                                    distance_to_km(cum_distance),duration_to_minutes(cum_duration),
+                                    segdist,segdur,cumdist,cumdur,
                                     speed_to_kph(seg_speed),
                                     bearing_int,
                                     waynameraw);
@@ -783,6 +886,8 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
 
        if(important>IMP_JUNCT_CONT)
           point_count++;
+
+       section_start=0;
       }
     while(point==next_point);
 
@@ -831,16 +936,467 @@ void PrintRoute(Results **results,int nresults,Nodes *nodes,Segments *segments,W
     fprintf(gpxroutefile,"</gpx>\n");
    }
 
+ if(polylinefile)
+    fprintf(polylinefile,"\n");
+
+ if(geojsonfile)
+    fprintf(geojsonfile,"]},\"properties\":{\"type\":\"%s\",\"distance\":%.3f,\"duration\":%.1f}}\n",
+                        option_quickest?"quickest":"shortest",
+                        distance_to_km(cum_distance),duration_to_minutes(cum_duration));
+
  /* Close the files */
 
  if(htmlfile)
-    fclose(htmlfile);
+    CloseOutputFile(htmlfile);
  if(gpxtrackfile)
-    fclose(gpxtrackfile);
+    CloseOutputFile(gpxtrackfile);
  if(gpxroutefile)
-    fclose(gpxroutefile);
+    CloseOutputFile(gpxroutefile);
  if(textfile)
-    fclose(textfile);
+    CloseOutputFile(textfile);
  if(textallfile)
-    fclose(textallfile);
+    CloseOutputFile(textallfile);
+ if(binaryfile)
+    CloseOutputFile(binaryfile);
+ if(polylinefile)
+    CloseOutputFile(polylinefile);
+ if(geojsonfile)
+    CloseOutputFile(geojsonfile);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Open one of the route output files (in the selected directory and with the selected prefix)
+  or use stdout if the output is to be streamed.
+
+  FILE *OpenOutputFile Returns the file or NULL if it cannot be opened.
+
+  const char *name The name of the file without the directory or prefix.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static FILE *OpenOutputFile(const char *name)
+{
+ char *filename;
+ FILE *file;
+
+ if(option_output_stdout)
+    return(stdout);
+
+ filename=FileName(option_output_dir,option_output_prefix,name);
+
+ file=fopen(filename,"w");
+
+ if(!file)
+    fprintf(stderr,"Warning: Cannot open file '%s' for writing [%s].\n",filename,strerror(errno));
+ else
+    setvbuf(file,NULL,_IOFBF,OUTPUT_BUFFER_SIZE);
+
+ free(filename);
+
+ return(file);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Close one of the route output files (or flush stdout if the output is being streamed).
+
+  FILE *file The file to close.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void CloseOutputFile(FILE *file)
+{
+ if(file==stdout)
+    fflush(file);
+ else
+    fclose(file);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print one value (the change in latitude or longitude from the previous point) in the
+  encoded polyline format (5-bit chunks of the zig-zag encoded value as printable characters).
+
+  FILE *file The file to print the value to.
+
+  int32_t value The value to print.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void PrintPolylineValue(FILE *file,int32_t value)
+{
+ uint32_t bits=(value<0)?~((uint32_t)value<<1):((uint32_t)value<<1);
+
+ while(bits>=0x20)
+   {
+    putc((int)((0x20|(bits&0x1f))+63),file);
+    bits>>=5;
+   }
+
+ putc((int)(bits+63),file);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print the latitude and longitude of each point of a route (one per line), the waypoints
+  that join the sections of the route are only printed once.
+
+  FILE *file The file to print the points to.
+
+  const char *key A string to print at the start of each line (or NULL for none).
+
+  Results **results The set of results to print (some may be NULL - ignore them).
+
+  int nresults The number of items in the list of results (which may be NULL).
+
+  Nodes *nodes The set of nodes to use.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void PrintRoutePoints(FILE *file,const char *key,Results **results,int nresults,Nodes *nodes)
+{
+ int point,first=1;
+
+ for(point=1;point<=nresults;point++)
+   {
+    Result *result;
+
+    if(!results[point])
+       continue;
+
+    result=FindResult(results[point],results[point]->start_node,results[point]->prev_segment);
+
+    if(!first)
+       result=result->next;
+
+    for(;result;result=result->next)
+      {
+       double latitude,longitude;
+       char latstr[24],lonstr[24];
+
+       if(IsFakeNode(result->node))
+          GetFakeLatLong(result->node,&latitude,&longitude);
+       else
+          GetLatLong(nodes,result->node,&latitude,&longitude);
+
+       FormatFixed(latstr,radians_to_degrees(latitude),6);
+       FormatFixed(lonstr,radians_to_degrees(longitude),6);
+
+       if(key)
+          fprintf(file,"%s %s %s\n",key,latstr,lonstr);
+       else
+          fprintf(file,"%s %s\n",latstr,lonstr);
+      }
+
+    first=0;
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print a route as one row of text for the PostgreSQL COPY command: the start and end
+  identifiers, the total distance (km), the total duration (minutes) and the route as a
+  LineString in hex-encoded EWKB with SRID 4326 (the waypoints that join the sections of the
+  route are only included once).
+
+  FILE *file The file to print the row to.
+
+  const char *start_key The identifier to print in the first column (the start of the route).
+
+  const char *end_key The identifier to print in the second column (the end of the route).
+
+  Results **results The set of results to print (some may be NULL - ignore them).
+
+  int nresults The number of items in the list of results (which may be NULL).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void PrintRouteCopy(FILE *file,const char *start_key,const char *end_key,Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile)
+{
+ double *coords=NULL;
+ int npoints=0;
+ int point,first=1,i;
+ distance_t distance=0;
+ duration_t duration=0;
+
+ /* Find the points and the total distance and duration */
+
+ for(point=1;point<=nresults;point++)
+   {
+    Result *result;
+
+    if(!results[point])
+       continue;
+
+    result=FindResult(results[point],results[point]->start_node,results[point]->prev_segment);
+
+    if(!first)
+       result=result->next;
+
+    for(;result;result=result->next)
+      {
+       double latitude,longitude;
+
+       if(IsFakeNode(result->node))
+          GetFakeLatLong(result->node,&latitude,&longitude);
+       else
+          GetLatLong(nodes,result->node,&latitude,&longitude);
+
+       if(result->node!=results[point]->start_node) /* not first point of a section of the route */
+         {
+          Segment *segment;
+          Way *way;
+
+          if(IsFakeSegment(result->segment))
+             segment=LookupFakeSegment(result->segment);
+          else
+             segment=LookupSegment(segments,result->segment,1);
+
+          way=LookupWay(ways,segment->way,1);
+
+          distance+=DISTANCE(segment->distance);
+          duration+=Duration(segment,way,profile);
+         }
+
+       if((npoints%256)==0)
+          coords=(double*)realloc((void*)coords,2*(npoints+256)*sizeof(double));
+
+       coords[2*npoints  ]=radians_to_degrees(longitude);
+       coords[2*npoints+1]=radians_to_degrees(latitude);
+
+       npoints++;
+      }
+
+    first=0;
+   }
+
+ /* Print the identifiers (with the special characters escaped) and the totals */
+
+ PrintCopyText(file,start_key);
+ putc('\t',file);
+ PrintCopyText(file,end_key);
+
+ fprintf(file,"\t%.3f\t%.1f\t",distance_to_km(distance),duration_to_minutes(duration));
+
+ /* Print the geometry (a LineString needs two points so a single point is repeated) */
+
+ if(npoints==0)
+    fprintf(file,"\\N");
+ else
+   {
+    fprintf(file,"01");         /* little-endian */
+
+    PrintHexUint32(file,EWKB_LINESTRING_SRID);
+    PrintHexUint32(file,EWKB_SRID);
+    PrintHexUint32(file,npoints==1?2:npoints);
+
+    for(i=0;i<npoints;i++)
+      {
+       PrintHexDouble(file,coords[2*i]);
+       PrintHexDouble(file,coords[2*i+1]);
+      }
+
+    if(npoints==1)
+      {
+       PrintHexDouble(file,coords[0]);
+       PrintHexDouble(file,coords[1]);
+      }
+   }
+
+ fprintf(file,"\n");
+
+ if(coords)
+    free(coords);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print a route as a binary record to be put into a route store by WriteRouteStore(): the
+  header, the identifier, the coordinates of the points and the real segment used to reach
+  each point (the waypoints that join the sections of the route are only included once).
+
+  FILE *file The file to print the record to.
+
+  const char *key The identifier of the route.
+
+  Results **results The set of results to print (some may be NULL - ignore them).
+
+  int nresults The number of items in the list of results (which may be NULL).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void PrintRouteRecord(FILE *file,const char *key,Results **results,int nresults,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile)
+{
+ RouteStoreRecord record;
+ RouteStoreCoord *coords=NULL;
+ index_t *segs=NULL;
+ int point,first=1;
+
+ record.idlength=strlen(key);
+ record.npoints=0;
+ record.distance=0;
+ record.duration=0;
+
+ /* Find the points and the total distance and duration */
+
+ for(point=1;point<=nresults;point++)
+   {
+    Result *result;
+
+    if(!results[point])
+       continue;
+
+    result=FindResult(results[point],results[point]->start_node,results[point]->prev_segment);
+
+    if(!first)
+       result=result->next;
+
+    for(;result;result=result->next)
+      {
+       double latitude,longitude;
+
+       if(IsFakeNode(result->node))
+          GetFakeLatLong(result->node,&latitude,&longitude);
+       else
+          GetLatLong(nodes,result->node,&latitude,&longitude);
+
+       if((record.npoints%256)==0)
+         {
+          coords=(RouteStoreCoord*)realloc((void*)coords,(record.npoints+256)*sizeof(RouteStoreCoord));
+          segs=(index_t*)realloc((void*)segs,(record.npoints+256)*sizeof(index_t));
+         }
+
+       coords[record.npoints].latitude =(int32_t)lrint(radians_to_degrees(latitude )*ROUTESTORE_SCALE);
+       coords[record.npoints].longitude=(int32_t)lrint(radians_to_degrees(longitude)*ROUTESTORE_SCALE);
+
+       segs[record.npoints]=NO_SEGMENT;
+
+       if(result->node!=results[point]->start_node) /* not first point of a section of the route */
+         {
+          Segment *segment;
+          Way *way;
+
+          if(IsFakeSegment(result->segment))
+            {
+             segment=LookupFakeSegment(result->segment);
+             segs[record.npoints]=IndexRealSegment(result->segment);
+            }
+          else
+            {
+             segment=LookupSegment(segments,result->segment,1);
+             segs[record.npoints]=result->segment;
+            }
+
+          way=LookupWay(ways,segment->way,1);
+
+          record.distance+=DISTANCE(segment->distance);
+          record.duration+=Duration(segment,way,profile);
+         }
+
+       record.npoints++;
+      }
+
+    first=0;
+   }
+
+ /* Print the record */
+
+ fwrite(&record,sizeof(RouteStoreRecord),1,file);
+
+ fwrite(key,1,record.idlength,file);
+
+ if(record.npoints)
+   {
+    fwrite(coords,sizeof(RouteStoreCoord),record.npoints,file);
+    fwrite(segs,sizeof(index_t),record.npoints,file);
+
+    free(coords);
+    free(segs);
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print a text column for the PostgreSQL COPY command (with the special characters escaped).
+
+  FILE *file The file to print the text to.
+
+  const char *text The text to print.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void PrintCopyText(FILE *file,const char *text)
+{
+ const char *t;
+
+ for(t=text;*t;t++)
+   {
+    if(*t=='\\')
+       fputs("\\\\",file);
+    else if(*t=='\t')
+       fputs("\\t",file);
+    else if(*t=='\n')
+       fputs("\\n",file);
+    else if(*t=='\r')
+       fputs("\\r",file);
+    else
+       putc(*t,file);
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print a 32-bit integer as little-endian hex.
+
+  FILE *file The file to print the value to.
+
+  uint32_t value The value to print.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void PrintHexUint32(FILE *file,uint32_t value)
+{
+ int i;
+
+ for(i=0;i<4;i++)
+   {
+    putc("0123456789ABCDEF"[(value>>4)&15],file);
+    putc("0123456789ABCDEF"[ value    &15],file);
+
+    value>>=8;
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print a double as little-endian hex (IEEE 754 format).
+
+  FILE *file The file to print the value to.
+
+  double value The value to print.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void PrintHexDouble(FILE *file,double value)
+{
+ uint64_t bits;
+ int i;
+
+ memcpy(&bits,&value,sizeof(double));
+
+ for(i=0;i<8;i++)
+   {
+    putc("0123456789ABCDEF"[(bits>>4)&15],file);
+    putc("0123456789ABCDEF"[ bits    &15],file);
+
+    bits>>=8;
+   }
 }
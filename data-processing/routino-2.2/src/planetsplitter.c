@@ -35,12 +35,19 @@
 #include "relationsx.h"
 #include "superx.h"
 #include "prunex.h"
+#include "contractx.h"
+#include "landmarksx.h"
+
+#include "nodes.h"
+#include "segments.h"
+#include "ways.h"
 
 #include "files.h"
 #include "logging.h"
 #include "functions.h"
 #include "osmparser.h"
 #include "tagging.h"
+#include "profiles.h"
 
 
 /* Global variables */
@@ -54,6 +61,11 @@ size_t option_filesort_ramsize=0;
 
 /* Local functions */
 
+static void CreateSuperSegmentPaths(const char *dirname,const char *prefix);
+static void CreateSegmentBins(const char *dirname,const char *prefix);
+static void CreateLandmarks(const char *dirname,const char *prefix,int nlandmarks);
+static void CreateContractions(const char *dirname,const char *prefix,char **profilenames,int nprofiles);
+
 static void print_usage(int detail,const char *argerr,const char *err);
 
 
@@ -70,6 +82,9 @@ int main(int argc,char** argv)
  int         iteration=0,quit=0;
  int         max_iterations=5;
  char       *dirname=NULL,*prefix=NULL,*tagging=NULL,*errorlog=NULL;
+ char       *profiles=NULL,**contract=NULL;
+ int         ncontract=0;
+ int         nlandmarks=0;
  int         option_parse_only=0,option_process_only=0;
  int         option_filenames=0;
  int         option_prune_isolated=500,option_prune_short=5,option_prune_straight=3;
@@ -103,6 +118,27 @@ int main(int argc,char** argv)
        max_iterations=atoi(&argv[arg][17]);
     else if(!strncmp(argv[arg],"--tagging=",10))
        tagging=&argv[arg][10];
+    else if(!strncmp(argv[arg],"--profiles=",11))
+       profiles=&argv[arg][11];
+    else if(!strncmp(argv[arg],"--contract=",11))
+      {
+       char *name=&argv[arg][11];
+
+       while(name)
+         {
+          char *comma=strchr(name,',');
+
+          if(comma)
+             *comma=0;
+
+          contract=(char**)realloc((void*)contract,(ncontract+1)*sizeof(char*));
+          contract[ncontract++]=name;
+
+          name=comma?comma+1:NULL;
+         }
+      }
+    else if(!strncmp(argv[arg],"--landmarks=",12))
+       nlandmarks=atoi(&argv[arg][12]);
     else if(!strncmp(argv[arg],"--prune",7))
       {
        if(!strcmp(&argv[arg][7],"-none"))
@@ -130,6 +166,9 @@ int main(int argc,char** argv)
  if(option_filenames && option_process_only)
     print_usage(0,NULL,"Cannot use '--process-only' and filenames at the same time.");
 
+ if(nlandmarks<0 || nlandmarks>MAX_LANDMARKS)
+    print_usage(0,NULL,"The '--landmarks' option must be between 0 and 32.");
+
  if(!option_filesort_ramsize)
    {
 #if SLIM
@@ -176,6 +215,45 @@ int main(int argc,char** argv)
     return(1);
    }
 
+ if(ncontract)
+   {
+    int i;
+
+    if(profiles)
+      {
+       if(!ExistsFile(profiles))
+         {
+          fprintf(stderr,"Error: The '--profiles' option specifies a file that does not exist.\n");
+          return(1);
+         }
+      }
+    else
+      {
+       if(ExistsFile(FileName(dirname,prefix,"profiles.xml")))
+          profiles=FileName(dirname,prefix,"profiles.xml");
+       else if(ExistsFile(FileName(DATADIR,NULL,"profiles.xml")))
+          profiles=FileName(DATADIR,NULL,"profiles.xml");
+       else
+         {
+          fprintf(stderr,"Error: The '--profiles' option was not used and the default 'profiles.xml' does not exist.\n");
+          return(1);
+         }
+      }
+
+    if(ParseXMLProfiles(profiles))
+      {
+       fprintf(stderr,"Error: Cannot read the profiles in the file '%s'.\n",profiles);
+       return(1);
+      }
+
+    for(i=0;i<ncontract;i++)
+       if(!GetProfile(contract[i]))
+         {
+          fprintf(stderr,"Error: Cannot find a profile called '%s' in '%s'.\n",contract[i],profiles);
+          return(1);
+         }
+   }
+
  /* Create new node, segment, way and relation variables */
 
  Nodes=NewNodeList(option_parse_only||option_process_only);
@@ -420,6 +498,10 @@ int main(int argc,char** argv)
  printf("\nWrite Out Database Files\n========================\n\n");
  fflush(stdout);
 
+ /* Write out the connected components of the nodes */
+
+ SaveComponentList(Nodes,Segments,Ways,FileName(dirname,prefix,"components.mem"));
+
  /* Write out the nodes */
 
  SaveNodeList(Nodes,FileName(dirname,prefix,"nodes.mem"));
@@ -444,6 +526,34 @@ int main(int argc,char** argv)
 
  FreeRelationList(Relations,0);
 
+ /* Write out the super-segment paths */
+
+ CreateSuperSegmentPaths(dirname,prefix);
+
+ /* Write out the segment bins */
+
+ CreateSegmentBins(dirname,prefix);
+
+ /* Create the landmark distances */
+
+ if(nlandmarks)
+   {
+    printf("\nCreate Landmarks\n================\n\n");
+    fflush(stdout);
+
+    CreateLandmarks(dirname,prefix,nlandmarks);
+   }
+
+ /* Create the contraction hierarchies */
+
+ if(ncontract)
+   {
+    printf("\nCreate Contraction Hierarchies\n==============================\n\n");
+    fflush(stdout);
+
+    CreateContractions(dirname,prefix,contract,ncontract);
+   }
+
  /* Close the error log file */
 
  if(errorlog)
@@ -453,6 +563,127 @@ int main(int argc,char** argv)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Find the normal segments that make up each super-segment using the database files that
+  have just been written (the segment indexes are not final until then).
+
+  const char *dirname The directory name for the database files.
+
+  const char *prefix The filename prefix for the database files.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void CreateSuperSegmentPaths(const char *dirname,const char *prefix)
+{
+ Nodes    *nodes;
+ Segments *segments;
+ Ways     *ways;
+
+ nodes=LoadNodeList(FileName(dirname,prefix,"nodes.mem"));
+
+ segments=LoadSegmentList(FileName(dirname,prefix,"segments.mem"));
+
+ ways=LoadWayList(FileName(dirname,prefix,"ways.mem"));
+
+ SaveSuperSegmentPaths(nodes,segments,ways,FileName(dirname,prefix,"supersegments.mem"));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  List the segments in each lat/long bin using the database files that have just been written.
+
+  const char *dirname The directory name for the database files.
+
+  const char *prefix The filename prefix for the database files.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void CreateSegmentBins(const char *dirname,const char *prefix)
+{
+ Nodes    *nodes;
+ Segments *segments;
+
+ nodes=LoadNodeList(FileName(dirname,prefix,"nodes.mem"));
+
+ segments=LoadSegmentList(FileName(dirname,prefix,"segments.mem"));
+
+ SaveSegmentBins(nodes,segments,FileName(dirname,prefix,"segmentbins.mem"));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Choose a number of landmarks and save the distance from each of them to every node using
+  the database files that have just been written.
+
+  const char *dirname The directory name for the database files.
+
+  const char *prefix The filename prefix for the database files.
+
+  int nlandmarks The number of landmarks.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void CreateLandmarks(const char *dirname,const char *prefix,int nlandmarks)
+{
+ Nodes    *nodes;
+ Segments *segments;
+
+ nodes=LoadNodeList(FileName(dirname,prefix,"nodes.mem"));
+
+ segments=LoadSegmentList(FileName(dirname,prefix,"segments.mem"));
+
+ SaveLandmarkList(nodes,segments,nlandmarks,DatabaseStamp(dirname,prefix),FileName(dirname,prefix,"landmarks.mem"));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Create a contraction hierarchy (for the shortest and quickest routes) for each of a list of
+  profiles using the database files that have just been written.
+
+  const char *dirname The directory name for the database files.
+
+  const char *prefix The filename prefix for the database files.
+
+  char **profilenames The names of the profiles.
+
+  int nprofiles The number of profiles.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void CreateContractions(const char *dirname,const char *prefix,char **profilenames,int nprofiles)
+{
+ Nodes    *nodes;
+ Segments *segments;
+ Ways     *ways;
+ uint64_t  stamp=DatabaseStamp(dirname,prefix);
+ int       i,quickest;
+
+ nodes=LoadNodeList(FileName(dirname,prefix,"nodes.mem"));
+
+ segments=LoadSegmentList(FileName(dirname,prefix,"segments.mem"));
+
+ ways=LoadWayList(FileName(dirname,prefix,"ways.mem"));
+
+ for(i=0;i<nprofiles;i++)
+   {
+    Profile *profile=GetProfile(profilenames[i]);
+
+    if(UpdateProfile(profile,ways))
+      {
+       fprintf(stderr,"Warning: Profile '%s' is invalid or not compatible with database and will not be contracted.\n",profilenames[i]);
+       continue;
+      }
+
+    for(quickest=0;quickest<=1;quickest++)
+      {
+       char *filename=(char*)malloc(strlen(profilenames[i])+32);
+
+       sprintf(filename,"contraction-%s-%s.mem",profilenames[i],quickest?"quickest":"shortest");
+
+       ContractNodes(nodes,segments,ways,profile,quickest,stamp,FileName(dirname,prefix,filename));
+
+       free(filename);
+      }
+   }
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Print out the usage information.
 
@@ -471,6 +702,9 @@ static void print_usage(int detail,const char *argerr,const char *err)
          "                      [--sort-ram-size=<size>]\n"
          "                      [--tmpdir=<dirname>]\n"
          "                      [--tagging=<filename>]\n"
+         "                      [--contract=<name>[,<name>...]]\n"
+         "                      [--profiles=<filename>]\n"
+         "                      [--landmarks=<number>]\n"
          "                      [--loggable] [--errorlog[=<name>]]\n"
          "                      [--parse-only | --process-only]\n"
          "                      [--max-iterations=<number>]\n"
@@ -512,6 +746,16 @@ static void print_usage(int detail,const char *argerr,const char *err)
             "                           '--prefix' options or the file installed in\n"
             "                           '" DATADIR "').\n"
             "\n"
+            "--contract=<name>[,<name>...]\n"
+            "                          Create a contraction hierarchy for the shortest and\n"
+            "                          quickest routes of each named profile.\n"
+            "--profiles=<filename>     The name of the XML file containing the profiles\n"
+            "                          (defaults to 'profiles.xml' with '--dir' and\n"
+            "                           '--prefix' options or the file installed in\n"
+            "                           '" DATADIR "').\n"
+            "--landmarks=<number>      Save the distances from this number of landmarks\n"
+            "                          for 'router --astar' (defaults to 0, maximum 32).\n"
+            "\n"
             "--loggable                Print progress messages suitable for logging to file.\n"
             "--errorlog[=<name>]       Log parsing errors to 'error.log' or the given name\n"
             "                          (the '--dir' and '--prefix' options are applied).\n"
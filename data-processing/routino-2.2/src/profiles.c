@@ -768,10 +768,69 @@ int UpdateProfile(Profile *profile,Ways *ways)
           profile->max_pref*=profile->props_no[i];
       }
 
+ /* Combine the highway and property preferences for each type of way that can exist in the database */
+
+ for(i=0;i<Way_Count;i++)
+   {
+    int props,j;
+
+    for(props=0;props<PROPERTY_COMBINATIONS;props++)
+      {
+       score_t pref=profile->highway[i];
+
+       for(j=1;j<Property_Count;j++)
+          if(ways->file.props & PROPERTIES(j))
+            {
+             if(props & PROPERTIES(j))
+                pref*=profile->props_yes[j];
+             else
+                pref*=profile->props_no[j];
+            }
+
+       profile->way_pref[i][props]=pref;
+      }
+   }
+
  return(0);
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate a checksum of the parts of an updated profile that affect the route (used to
+  check that a contraction hierarchy, snapped points or cached routes match the profile).
+
+  uint32_t ProfileChecksum Returns the checksum.
+
+  const Profile *profile The profile (after it has been updated by UpdateProfile()).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+uint32_t ProfileChecksum(const Profile *profile)
+{
+ uint32_t checksum=2166136261U;
+ const unsigned char *bytes;
+ size_t i;
+
+#define CHECKSUM(xxx) for(bytes=(const unsigned char*)&(xxx),i=0;i<sizeof(xxx);i++) checksum=(checksum^bytes[i])*16777619U
+
+ CHECKSUM(profile->transport);
+ CHECKSUM(profile->allow);
+ CHECKSUM(profile->highway);
+ CHECKSUM(profile->speed);
+ CHECKSUM(profile->props_yes);
+ CHECKSUM(profile->props_no);
+ CHECKSUM(profile->oneway);
+ CHECKSUM(profile->turns);
+ CHECKSUM(profile->weight);
+ CHECKSUM(profile->height);
+ CHECKSUM(profile->width);
+ CHECKSUM(profile->length);
+
+#undef CHECKSUM
+
+ return(checksum);
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Print out a profile.
 
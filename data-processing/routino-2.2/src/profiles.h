@@ -26,6 +26,12 @@
 #include "types.h"
 
 
+/* Constants */
+
+/*+ The number of different combinations of way properties. +*/
+#define PROPERTY_COMBINATIONS (1<<(Property_Count-1))
+
+
 /* Data structures */
 
 /*+ A data structure to hold a transport type profile. +*/
@@ -54,10 +60,19 @@ typedef struct _Profile
  height_t     height;                    /*+ The minimum height of vehicles on the route. +*/
  width_t      width;                     /*+ The minimum width of vehicles on the route. +*/
  length_t     length;                    /*+ The minimum length of vehicles on the route. +*/
+
+ score_t      way_pref[Way_Count][PROPERTY_COMBINATIONS]; /*+ The combined highway and property preference for each type of way
+                                                               (calculated by UpdateProfile()). +*/
 }
  Profile;
 
 
+/* Macros */
+
+/*+ Return the combined highway and property preference for a way (after UpdateProfile()). +*/
+#define WayPreference(profile,way) ((profile)->way_pref[HIGHWAY((way)->type)][(way)->props&(PROPERTY_COMBINATIONS-1)])
+
+
 /* Functions in profiles.c */
 
 int ParseXMLProfiles(const char *filename);
@@ -66,6 +81,8 @@ Profile *GetProfile(const char *name);
 
 int UpdateProfile(Profile *profile,Ways *ways);
 
+uint32_t ProfileChecksum(const Profile *profile);
+
 void PrintProfile(const Profile *profile);
 
 void PrintProfilesXML(void);
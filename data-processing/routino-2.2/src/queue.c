@@ -29,19 +29,46 @@
 /*+ The size of the increment to the allocated memory. +*/
 #define QUEUE_INCREMENT 1024
 
+/*+ The number of children of each item in the heap (2 for a binary heap, the default). +*/
+#ifndef QUEUE_ARITY
+#define QUEUE_ARITY 2
+#endif
+
+
+/*+ An item in the queue (with a copy of the sort key so that the result is not read when comparing). +*/
+typedef struct _QueueItem
+{
+ score_t  sortby;               /*+ The value to sort the queue by (copied from the result). +*/
+ Result  *result;               /*+ The result. +*/
+}
+ QueueItem;
+
+
+/*+ The maximum number of freed queues that are kept by each thread to be reused. +*/
+#define MAX_CACHED 4
+
 
 /*+ A queue of results. +*/
 struct _Queue
 {
- int      nallocated;           /*+ The number of entries allocated. +*/
- int      noccupied;            /*+ The number of entries occupied. +*/
+ int        nallocated;         /*+ The number of entries allocated. +*/
+ int        noccupied;          /*+ The number of entries occupied. +*/
 
- Result **data;                 /*+ The queue of pointers to results. +*/
+ QueueItem *data;               /*+ The queue of results and their sort keys. +*/
 };
 
 
+/* Local variables */
+
+/*+ The queues that have been freed and can be reused. +*/
+static THREAD_LOCAL Queue *cached[MAX_CACHED];
+
+/*+ The number of cached queues. +*/
+static THREAD_LOCAL int ncached=0;
+
+
 /*++++++++++++++++++++++++++++++++++++++
-  Allocate a new queue.
+  Allocate a new queue (or reuse one that was freed by this thread).
 
   Queue *NewQueueList Returns the queue.
   ++++++++++++++++++++++++++++++++++++++*/
@@ -50,36 +77,70 @@ Queue *NewQueueList(void)
 {
  Queue *queue;
 
+ if(ncached>0)
+   {
+    queue=cached[--ncached];
+
+    queue->noccupied=0;
+
+    return(queue);
+   }
+
  queue=(Queue*)malloc(sizeof(Queue));
 
  queue->nallocated=QUEUE_INCREMENT;
  queue->noccupied=0;
 
- queue->data=(Result**)malloc(queue->nallocated*sizeof(Result*));
+ queue->data=(QueueItem*)malloc(queue->nallocated*sizeof(QueueItem));
 
  return(queue);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Free a queue.
+  Free a queue (or keep it to be reused by this thread).
 
   Queue *queue The queue to be freed.
   ++++++++++++++++++++++++++++++++++++++*/
 
 void FreeQueueList(Queue *queue)
 {
+ if(ncached<MAX_CACHED)
+   {
+    cached[ncached++]=queue;
+    return;
+   }
+
  free(queue->data);
 
  free(queue);
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Free all of the queues that this thread has kept to be reused.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void FreeQueueCache(void)
+{
+ while(ncached>0)
+   {
+    Queue *queue=cached[--ncached];
+
+    free(queue->data);
+
+    free(queue);
+   }
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Insert a new item into the queue in the right place.
 
-  The data is stored in a "Binary Heap" http://en.wikipedia.org/wiki/Binary_heap
-  and this operation is adding an item to the heap.
+  The data is stored in a "d-ary Heap" http://en.wikipedia.org/wiki/D-ary_heap
+  and this operation is adding an item to the heap (or moving it up if it is
+  already in the heap and the score has reduced). The items are indexed from 0
+  and result->queued is one more than the index so that zero means not queued.
 
   Queue *queue The queue to insert the result into.
 
@@ -88,53 +149,55 @@ void FreeQueueList(Queue *queue)
 
 void InsertInQueue(Queue *queue,Result *result)
 {
+ QueueItem *data;
+ score_t sortby=result->sortby;
  int index;
 
+ routing_counters.pushed++;
+
  if(result->queued==NOT_QUEUED)
    {
-    queue->noccupied++;
-    index=queue->noccupied;
-
     if(queue->noccupied==queue->nallocated)
       {
        queue->nallocated=queue->nallocated+QUEUE_INCREMENT;
-       queue->data=(Result**)realloc((void*)queue->data,queue->nallocated*sizeof(Result*));
+       queue->data=(QueueItem*)realloc((void*)queue->data,queue->nallocated*sizeof(QueueItem));
       }
 
-    queue->data[index]=result;
-    queue->data[index]->queued=index;
+    index=queue->noccupied;
+    queue->noccupied++;
    }
  else
    {
-    index=result->queued;
+    index=result->queued-1;
    }
 
- /* Bubble up the new value */
+ data=queue->data;
 
- while(index>1 &&
-       queue->data[index]->sortby<queue->data[index/2]->sortby)
-   {
-    int newindex;
-    Result *temp;
+ /* Bubble up the new value by moving the parents down until the right place is found */
 
-    newindex=index/2;
+ while(index>0)
+   {
+    int parent=(index-1)/QUEUE_ARITY;
 
-    temp=queue->data[index];
-    queue->data[index]=queue->data[newindex];
-    queue->data[newindex]=temp;
+    if(!(sortby<data[parent].sortby))
+       break;
 
-    queue->data[index]->queued=index;
-    queue->data[newindex]->queued=newindex;
+    data[index]=data[parent];
+    data[index].result->queued=index+1;
 
-    index=newindex;
+    index=parent;
    }
+
+ data[index].sortby=sortby;
+ data[index].result=result;
+ result->queued=index+1;
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
   Pop an item from the front of the queue.
 
-  The data is stored in a "Binary Heap" http://en.wikipedia.org/wiki/Binary_heap
+  The data is stored in a "d-ary Heap" http://en.wikipedia.org/wiki/D-ary_heap
   and this operation is deleting the root item from the heap.
 
   Result *PopFromQueue Returns the top item.
@@ -144,59 +207,71 @@ void InsertInQueue(Queue *queue,Result *result)
 
 Result *PopFromQueue(Queue *queue)
 {
- int index;
+ QueueItem *data=queue->data;
+ QueueItem last;
  Result *retval;
+ int index,noccupied;
 
  if(queue->noccupied==0)
     return(NULL);
 
- retval=queue->data[1];
+ retval=data[0].result;
  retval->queued=NOT_QUEUED;
 
- index=1;
+ routing_counters.popped++;
+
+ noccupied=--queue->noccupied;
 
- queue->data[index]=queue->data[queue->noccupied];
- queue->noccupied--;
+ if(noccupied==0)
+    return(retval);
 
- /* Bubble down the newly promoted value */
+ last=data[noccupied];
 
- while((2*index)<queue->noccupied &&
-       (queue->data[index]->sortby>queue->data[2*index  ]->sortby ||
-        queue->data[index]->sortby>queue->data[2*index+1]->sortby))
+ /* Bubble down the last value by moving the smallest children up until the right place is found */
+
+ index=0;
+
+ while(1)
    {
-    int newindex;
-    Result *temp;
+    int first=QUEUE_ARITY*index+1,child,newindex;
+
+    if(first>=noccupied)
+       break;
 
-    if(queue->data[2*index]->sortby<queue->data[2*index+1]->sortby)
-       newindex=2*index;
-    else
-       newindex=2*index+1;
+    newindex=first;
 
-    temp=queue->data[newindex];
-    queue->data[newindex]=queue->data[index];
-    queue->data[index]=temp;
+    for(child=first+1;child<(first+QUEUE_ARITY) && child<noccupied;child++)
+       if(data[child].sortby<data[newindex].sortby)
+          newindex=child;
 
-    queue->data[index]->queued=index;
-    queue->data[newindex]->queued=newindex;
+    if(!(data[newindex].sortby<last.sortby))
+       break;
+
+    data[index]=data[newindex];
+    data[index].result->queued=index+1;
 
     index=newindex;
    }
 
- if((2*index)==queue->noccupied &&
-    queue->data[index]->sortby>queue->data[2*index]->sortby)
-   {
-    int newindex;
-    Result *temp;
+ data[index]=last;
+ data[index].result->queued=index+1;
 
-    newindex=2*index;
+ return(retval);
+}
 
-    temp=queue->data[newindex];
-    queue->data[newindex]=queue->data[index];
-    queue->data[index]=temp;
 
-    queue->data[index]->queued=index;
-    queue->data[newindex]->queued=newindex;
-   }
+/*++++++++++++++++++++++++++++++++++++++
+  Look at the item at the front of the queue without removing it.
 
- return(retval);
+  Result *PeekAtQueue Returns the top item (or NULL if the queue is empty).
+
+  Queue *queue The queue to look at.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Result *PeekAtQueue(Queue *queue)
+{
+ if(queue->noccupied==0)
+    return(NULL);
+
+ return(queue->data[0].result);
 }
@@ -90,6 +90,37 @@ Relations *LoadRelationList(const char *filename)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Create a copy of a relation list that can be used by another thread at the same time
+  (the copy has its own cache in slim mode).
+
+  Relations *CopyRelationList Returns the new relation list.
+
+  Relations *relations The relation list to copy.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Relations *CopyRelationList(Relations *relations)
+{
+ Relations *copy;
+#if SLIM
+ int i;
+#endif
+
+ copy=(Relations*)malloc(sizeof(Relations));
+
+ *copy=*relations;
+
+#if SLIM
+
+ for(i=0;i<sizeof(copy->cached)/sizeof(copy->cached[0]);i++)
+    copy->incache[i]=NO_RELATION;
+
+#endif
+
+ return(copy);
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Find the first turn relation in the file whose 'via' matches a specific node.
 
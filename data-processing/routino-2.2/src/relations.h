@@ -85,6 +85,8 @@ struct _Relations
 
 Relations *LoadRelationList(const char *filename);
 
+Relations *CopyRelationList(Relations *relations);
+
 index_t FindFirstTurnRelation1(Relations *relations,index_t via);
 index_t FindNextTurnRelation1(Relations *relations,index_t current);
 
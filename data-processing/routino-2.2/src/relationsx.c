@@ -71,7 +71,7 @@ RelationsX *NewRelationList(int append)
 
  /* Route Relations */
 
- relationsx->rfilename=(char*)malloc(strlen(option_tmpdirname)+32);
+ relationsx->rfilename=(char*)malloc(strlen(option_tmpdirname)+40);
 
  if(append)
     sprintf(relationsx->rfilename,"%s/relationsx.route.input.tmp",option_tmpdirname);
@@ -104,7 +104,7 @@ RelationsX *NewRelationList(int append)
 
  /* Turn Restriction Relations */
 
- relationsx->trfilename=(char*)malloc(strlen(option_tmpdirname)+32);
+ relationsx->trfilename=(char*)malloc(strlen(option_tmpdirname)+40);
 
  if(append)
     sprintf(relationsx->trfilename,"%s/relationsx.turn.input.tmp",option_tmpdirname);
@@ -27,46 +27,125 @@
 #include "results.h"
 
 
-/*+ The maximum number of collisions in a bin for the Results 'point' arrays before worrying. +*/
-#define MAX_COLLISIONS 32
- 
+/*+ The hash table is enlarged when it is more than this fraction full (1/2^N). +*/
+#define MAX_LOAD_SHIFT 1
+
+/*+ The slot in the hash table to start looking for a node in (nodes that are close together in the
+    database stay close together in the table and there is space for four segments per node). +*/
+#define HASH_SLOT(results,node) (((uint32_t)(node)<<2)&(results)->mask)
+
+/*+ The result with a particular index in the 'data' array. +*/
+#define RESULT(results,index) (&(results)->data[(index)>>(results)->nshift][(index)&((results)->ndata2-1)])
+
+/*+ The maximum number of freed results lists that are kept by each thread to be reused. +*/
+#define MAX_CACHED 8
+
+/*+ The memory that a new results list would need for the same results (a reused list may have more allocated). +*/
+#define RESULTS_MEMORY(results) (sizeof(Results)+(results)->countbins*sizeof(ResultSlot)+ \
+                                 (results)->countdata1*(((size_t)1<<(results)->countshift)*sizeof(Result)+sizeof(Result*)))
+
+
+/* Global variables */
+
+/*+ The counters for the work done by the routing searches in this thread. +*/
+THREAD_LOCAL RoutingCounters routing_counters;
+
+
+/* Local variables */
+
+/*+ The results lists that have been freed and can be reused. +*/
+static THREAD_LOCAL Results *cached[MAX_CACHED];
+
+/*+ The number of cached results lists. +*/
+static THREAD_LOCAL int ncached=0;
+
+
+/* Local functions */
+
+static void DestroyResultsList(Results *results);
+static void ResizeResultsList(Results *results);
+static void AddResultsMemory(size_t memory);
+
 
 /*++++++++++++++++++++++++++++++++++++++
-  Allocate a new results list.
+  Allocate a new results list (or reuse one that was freed by this thread).
 
   Results *NewResultsList Returns the results list.
 
-  int nbins The initial number of bins in the results array.
+  int nbins The initial number of slots in the results hash table.
   ++++++++++++++++++++++++++++++++++++++*/
 
 Results *NewResultsList(int nbins)
 {
- Results *results;
+ Results *results=NULL;
+ uint32_t size=8,nshift=3;
+ int i,best=-1;
+
+ while(size<nbins)
+   {
+    size<<=1;
+    nshift++;
+   }
 
- results=(Results*)malloc(sizeof(Results));
+ /* Reuse the smallest cached list that is big enough (or the biggest one) */
 
- results->nbins=1;
- results->mask=~0;
+ for(i=0;i<ncached;i++)
+    if(best==-1 ||
+       (cached[best]->ndata2<size && cached[i]->ndata2>cached[best]->ndata2) ||
+       (cached[i]->ndata2>=size && cached[i]->ndata2<cached[best]->ndata2))
+       best=i;
 
- while(nbins>>=1)
+ if(best!=-1)
    {
-    results->mask<<=1;
-    results->nbins<<=1;
+    results=cached[best];
+
+    cached[best]=cached[--ncached];
+
+    /* The arrays of results must be big enough to hold as many as a new list would */
+
+    if(results->ndata2<size)
+      {
+       for(i=0;i<results->ndata1;i++)
+          free(results->data[i]);
+
+       results->ndata1=0;
+       results->ndata2=size;
+       results->nshift=nshift;
+      }
+
+    /* Empty all of the slots at once */
+
+    results->epoch++;
+
+    if(results->epoch==0)
+      {
+       memset(results->slots,0,results->nbins*sizeof(ResultSlot));
+       results->epoch=1;
+      }
    }
+ else
+   {
+    results=(Results*)malloc(sizeof(Results));
 
- results->mask=~results->mask;
+    results->nbins=size;
+    results->mask=results->nbins-1;
 
- results->number=0;
+    results->epoch=1;
 
- results->npoint1=0;
+    results->slots=(ResultSlot*)calloc(results->nbins,sizeof(ResultSlot));
 
- results->count=(uint8_t*)calloc(results->nbins,sizeof(uint8_t));
- results->point=(Result***)malloc(MAX_COLLISIONS*sizeof(Result**));
+    results->ndata1=0;
+    results->ndata2=size;
+    results->nshift=nshift;
 
- results->ndata1=0;
- results->ndata2=results->nbins;
+    results->data=NULL;
+   }
 
- results->data=NULL;
+ results->number=0;
+
+ results->countbins=size;
+ results->countdata1=0;
+ results->countshift=nshift;
 
  results->start_node=NO_NODE;
  results->prev_segment=NO_SEGMENT;
@@ -74,17 +153,47 @@ Results *NewResultsList(int nbins)
  results->finish_node=NO_NODE;
  results->last_segment=NO_SEGMENT;
 
+ AddResultsMemory(RESULTS_MEMORY(results));
+
  return(results);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Free a results list.
+  Free a results list (or keep it to be reused by this thread).
 
   Results *results The results list to be destroyed.
   ++++++++++++++++++++++++++++++++++++++*/
 
 void FreeResultsList(Results *results)
+{
+ routing_counters.memory-=RESULTS_MEMORY(results);
+
+ if(ncached<MAX_CACHED)
+    cached[ncached++]=results;
+ else
+    DestroyResultsList(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Free all of the results lists that this thread has kept to be reused.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void FreeResultsCache(void)
+{
+ while(ncached>0)
+    DestroyResultsList(cached[--ncached]);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Free the memory used by a results list.
+
+  Results *results The results list to be destroyed.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void DestroyResultsList(Results *results)
 {
  int i;
 
@@ -93,12 +202,7 @@ void FreeResultsList(Results *results)
 
  free(results->data);
 
- for(i=0;i<results->npoint1;i++)
-    free(results->point[i]);
-
- free(results->point);
-
- free(results->count);
+ free(results->slots);
 
  free(results);
 }
@@ -119,85 +223,60 @@ void FreeResultsList(Results *results)
 Result *InsertResult(Results *results,index_t node,index_t segment)
 {
  Result *result;
- int bin=node&results->mask;
+ uint32_t bin;
 
- /* Check if we have hit the limit on the number of collisions per bin */
-
- if(results->count[bin]>MAX_COLLISIONS && results->count[bin]==results->npoint1)
-   {
-    int i,j,k;
+ /* Check if the hash table is too full */
 
-    results->nbins<<=1;
-    results->mask=(results->mask<<1)|1;
+ if((results->number+1)>(results->nbins>>MAX_LOAD_SHIFT))
+    ResizeResultsList(results);
 
-    results->count=(uint8_t*)realloc((void*)results->count,results->nbins*sizeof(uint8_t));
-
-    for(i=0;i<results->npoint1;i++)
-       results->point[i]=(Result**)realloc((void*)results->point[i],results->nbins*sizeof(Result*));
-
-    for(i=0;i<results->nbins/2;i++)
-      {
-       int c=results->count[i];
-
-       results->count[i+results->nbins/2]=0;
+ /* Check that the arrays have enough space or allocate more. */
 
-       for(j=0,k=0;j<c;j++)
-         {
-          int newbin=results->point[j][i]->node&results->mask;
-
-          if(newbin==i)
-            {
-             if(k!=j)
-                results->point[k][i]=results->point[j][i];
-             k++;
-            }
-          else
-            {
-             results->point[results->count[newbin]][newbin]=results->point[j][i];
-
-             results->count[newbin]++;
-             results->count[i]--;
-            }
-         }
-      }
+ if((results->number>>results->nshift)==results->ndata1)
+   {
+    results->ndata1++;
 
-    bin=node&results->mask;
+    results->data=(Result**)realloc((void*)results->data,results->ndata1*sizeof(Result*));
+    results->data[results->ndata1-1]=(Result*)malloc(results->ndata2*sizeof(Result));
    }
 
- /* Check that the arrays have enough space or allocate more. */
+ /* Count the memory that a new list would need for the same results (so that the counters do
+    not depend on which lists were reused or how much memory they already had) */
 
- if(results->count[bin]==results->npoint1)
+ if((results->number+1)>(results->countbins>>MAX_LOAD_SHIFT))
    {
-    assert(results->npoint1<255);
-
-    results->npoint1++;
-
-    if(results->npoint1>MAX_COLLISIONS)
-       results->point=(Result***)realloc((void*)results->point,results->npoint1*sizeof(Result**));
+    AddResultsMemory(results->countbins*sizeof(ResultSlot));
 
-    results->point[results->npoint1-1]=(Result**)malloc(results->nbins*sizeof(Result*));
+    results->countbins<<=1;
    }
 
- if((results->number%results->ndata2)==0)
+ if((results->number>>results->countshift)==results->countdata1)
    {
-    results->ndata1++;
+    results->countdata1++;
 
-    results->data=(Result**)realloc((void*)results->data,results->ndata1*sizeof(Result*));
-    results->data[results->ndata1-1]=(Result*)malloc(results->ndata2*sizeof(Result));
+    AddResultsMemory(((size_t)1<<results->countshift)*sizeof(Result)+sizeof(Result*));
    }
 
- /* Insert the new entry */
+ result=RESULT(results,results->number);
+
+ /* Insert the new entry in the first empty slot */
 
- results->point[results->count[bin]][bin]=&results->data[results->ndata1-1][results->number%results->ndata2];
+ bin=HASH_SLOT(results,node);
+
+ while(results->slots[bin].epoch==results->epoch)
+    bin=(bin+1)&results->mask;
+
+ results->slots[bin].node=node;
+ results->slots[bin].segment=segment;
+ results->slots[bin].epoch=results->epoch;
+ results->slots[bin].index=results->number;
 
  results->number++;
 
- results->count[bin]++;
+ routing_counters.inserted++;
 
  /* Initialise the result */
 
- result=results->point[results->count[bin]-1][bin];
-
  result->node=node;
  result->segment=segment;
 
@@ -213,6 +292,74 @@ Result *InsertResult(Results *results,index_t node,index_t segment)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Double the size of the hash table and put the results back into it.
+
+  Results *results The results structure to resize.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void ResizeResultsList(Results *results)
+{
+ ResultSlot *oldslots=results->slots;
+ uint32_t oldnbins=results->nbins;
+ uint32_t i;
+
+ results->nbins<<=1;
+ results->mask=results->nbins-1;
+
+ results->slots=(ResultSlot*)calloc(results->nbins,sizeof(ResultSlot));
+
+ for(i=0;i<oldnbins;i++)
+    if(oldslots[i].epoch==results->epoch)
+      {
+       uint32_t bin=HASH_SLOT(results,oldslots[i].node);
+
+       while(results->slots[bin].epoch==results->epoch)
+          bin=(bin+1)&results->mask;
+
+       results->slots[bin]=oldslots[i];
+      }
+
+ free(oldslots);
+
+ routing_counters.resized++;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Add to the memory needed by the results lists that are in use and update the peak.
+
+  size_t memory The amount of memory that is needed.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void AddResultsMemory(size_t memory)
+{
+ routing_counters.memory+=memory;
+
+ if(routing_counters.memory>routing_counters.peak_memory)
+    routing_counters.peak_memory=routing_counters.memory;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Reset the counters for the work done by the routing searches in this thread (the peak
+  memory starts from the memory needed by the results lists that are still in use, which
+  is kept as the base so that it can be subtracted).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void ResetRoutingCounters(void)
+{
+ routing_counters.inserted=0;
+ routing_counters.resized=0;
+
+ routing_counters.pushed=0;
+ routing_counters.popped=0;
+
+ routing_counters.base_memory=routing_counters.memory;
+ routing_counters.peak_memory=routing_counters.memory;
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Find a result; search by node only (don't care about the segment but find the shortest).
 
@@ -225,18 +372,28 @@ Result *InsertResult(Results *results,index_t node,index_t segment)
 
 Result *FindResult1(Results *results,index_t node)
 {
- int bin=node&results->mask;
+ uint32_t bin=HASH_SLOT(results,node);
  score_t best_score=INF_SCORE;
  Result *best_result=NULL;
- int i;
 
- for(i=results->count[bin]-1;i>=0;i--)
-    if(results->point[i][bin]->node==node && results->point[i][bin]->score<best_score)
+ /* All of the results for a node are in the slots between the hashed one and the next empty one */
+
+ while(results->slots[bin].epoch==results->epoch)
+   {
+    if(results->slots[bin].node==node)
       {
-       best_score=results->point[i][bin]->score;
-       best_result=results->point[i][bin];
+       Result *result=RESULT(results,results->slots[bin].index);
+
+       if(result->score<best_score)
+         {
+          best_score=result->score;
+          best_result=result;
+         }
       }
 
+    bin=(bin+1)&results->mask;
+   }
+
  return(best_result);
 }
 
@@ -255,12 +412,18 @@ Result *FindResult1(Results *results,index_t node)
 
 Result *FindResult(Results *results,index_t node,index_t segment)
 {
- int bin=node&results->mask;
- int i;
+ uint32_t bin=HASH_SLOT(results,node);
+
+ /* The segment that the result was inserted with is used (a search that changes the segment of a
+    result after inserting it must only use FindResult1()) */
 
- for(i=results->count[bin]-1;i>=0;i--)
-    if(results->point[i][bin]->segment==segment && results->point[i][bin]->node==node)
-       return(results->point[i][bin]);
+ while(results->slots[bin].epoch==results->epoch)
+   {
+    if(results->slots[bin].node==node && results->slots[bin].segment==segment)
+       return(RESULT(results,results->slots[bin].index));
+
+    bin=(bin+1)&results->mask;
+   }
 
  return(NULL);
 }
@@ -53,28 +53,42 @@ struct _Result
  uint32_t  queued;              /*+ The position of this result in the queue. +*/
 };
 
+/*+ A slot in the hash table of results (with the key copied so that the result is only read when it matches). +*/
+typedef struct _ResultSlot
+{
+ index_t   node;                /*+ The node for the result. +*/
+ index_t   segment;             /*+ The segment for the result when it was inserted. +*/
+
+ uint32_t  epoch;               /*+ The epoch of the results list when the slot was filled (empty if not the current one). +*/
+ uint32_t  index;               /*+ The index of the result in the 'data' array. +*/
+}
+ ResultSlot;
+
 /*+ A list of results. +*/
 typedef struct _Results
 {
- uint32_t  nbins;               /*+ The number of bins. +*/
+ uint32_t  nbins;               /*+ The number of slots in the hash table (a power of 2). +*/
  uint32_t  mask;                /*+ A bit mask to select the bottom 'nbins' bits. +*/
 
- uint32_t  number;              /*+ The total number of occupied results. +*/
+ uint32_t  epoch;               /*+ The current epoch (incremented to empty all of the slots when the list is reused). +*/
 
- uint8_t   npoint1;             /*+ The amount of space allocated for results
-                                    (the first dimension of the 'point' array). +*/
+ uint32_t  number;              /*+ The total number of occupied results. +*/
 
- uint8_t  *count;               /*+ An array of nbins counters of results in each array. +*/
- Result ***point;               /*+ An array of nbins arrays of pointers to actual results. +*/
+ ResultSlot *slots;             /*+ An open-addressing hash table (linear probing on the node) of the results. +*/
 
- uint32_t  ndata1;              /*+ The size of the first dimension of the 'data' array. +*/
- uint32_t  ndata2;              /*+ The size of the second dimension of the 'data' array. +*/
+ uint32_t  ndata1;              /*+ The size of the first dimension of the 'data' array (the number of arrays allocated). +*/
+ uint32_t  ndata2;              /*+ The size of the second dimension of the 'data' array (a power of 2). +*/
+ uint32_t  nshift;              /*+ The number of bits to shift a result index by to get the first dimension. +*/
 
  Result  **data;                /*+ An array of arrays containing the actual results, the first
                                     dimension is reallocated but the second dimension is not.
                                     Most importantly pointers into the real data don't change
                                     as more space is allocated (since realloc is not being used). +*/
 
+ uint32_t  countbins;           /*+ The number of slots that a new list would have for the same results (for the counters). +*/
+ uint32_t  countdata1;          /*+ The number of arrays that a new list would have for the same results (for the counters). +*/
+ uint32_t  countshift;          /*+ The number of bits to shift a result index by in a new list (for the counters). +*/
+
  index_t start_node;            /*+ The start node. +*/
  index_t prev_segment;          /*+ The previous segment to get to the start node (if any). +*/
 
@@ -84,6 +98,27 @@ typedef struct _Results
  Results;
 
 
+/*+ Counters for the work done by the routing searches in the current thread. +*/
+typedef struct _RoutingCounters
+{
+ uint64_t  inserted;            /*+ The number of results inserted. +*/
+ uint64_t  resized;             /*+ The number of times that a results hash table was enlarged. +*/
+
+ uint64_t  pushed;              /*+ The number of results put into a queue (or moved up it). +*/
+ uint64_t  popped;              /*+ The number of results taken from a queue. +*/
+
+ size_t    memory;              /*+ The memory needed by the results lists that are in use (as if none were reused). +*/
+ size_t    base_memory;         /*+ The memory needed by the results lists that were in use when the counters were reset. +*/
+ size_t    peak_memory;         /*+ The largest memory needed by the results lists since the counters were reset. +*/
+}
+ RoutingCounters;
+
+
+/* Variables in results.c */
+
+extern THREAD_LOCAL RoutingCounters routing_counters;
+
+
 /* Forward definition for opaque type */
 
 typedef struct _Queue Queue;
@@ -94,6 +129,10 @@ typedef struct _Queue Queue;
 Results *NewResultsList(int nbins);
 void FreeResultsList(Results *results);
 
+void FreeResultsCache(void);
+
+void ResetRoutingCounters(void);
+
 Result *InsertResult(Results *results,index_t node,index_t segment);
 
 Result *FindResult1(Results *results,index_t node);
@@ -108,8 +147,11 @@ Result *NextResult(Results *results,Result *result);
 Queue *NewQueueList(void);
 void FreeQueueList(Queue *queue);
 
+void FreeQueueCache(void);
+
 void InsertInQueue(Queue *queue,Result *result);
 Result *PopFromQueue(Queue *queue);
+Result *PeekAtQueue(Queue *queue);
 
 
 #endif /* RESULTS_H */
@@ -0,0 +1,744 @@
+/***************************************
+ Persistent cache of calculated routes.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "types.h"
+#include "segments.h"
+#include "routecache.h"
+
+#include "fakes.h"
+#include "files.h"
+#include "functions.h"
+
+
+/*+ The initial number of slots in the hash table of added routes. +*/
+#define INITIAL_BINS 1024
+
+/*+ The number of routes that the array of added routes is increased by each time. +*/
+#define INCREMENT_ENTRIES 1024
+
+
+/* Local functions */
+
+static int NormaliseRoutePoint(RouteCachePoint *point,int start_point,int finish_point);
+static index_t CachedNode(index_t node,int start_point,int finish_point);
+static index_t CachedSegment(index_t segment,int start_point,int finish_point);
+static Results *RebuildRoute(RouteCachePoint *points,uint32_t npoints,int start_point,int finish_point);
+
+static RouteCacheEntry *FindNewEntry(RouteCache *cache,RouteCacheKey *key);
+static void InsertNewEntry(RouteCache *cache,uint32_t index);
+static uint32_t hash_key(RouteCacheKey *key);
+
+static void MapRouteCache(RouteCache *cache,off_t size);
+static void UnmapRouteCache(RouteCache *cache);
+
+static int compare_keys(const RouteCacheEntry *a,const RouteCacheEntry *b);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in the cached routes from a file (or start with no routes if the file does not
+  exist or was created for a different database).
+
+  RouteCache *LoadRouteCache Returns the route cache.
+
+  const char *filename The name of the file to load (and to save the routes to).
+
+  uint64_t stamp The stamp of the database files.
+
+  index_t nodes The number of nodes in the database.
+
+  index_t segments The number of segments in the database.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+RouteCache *LoadRouteCache(const char *filename,uint64_t stamp,index_t nodes,index_t segments)
+{
+ RouteCache *cache;
+
+ cache=(RouteCache*)calloc(1,sizeof(RouteCache));
+
+ cache->filename=strcpy((char*)malloc(strlen(filename)+1),filename);
+
+ cache->nbins=INITIAL_BINS;
+ cache->bins=(uint32_t*)calloc(cache->nbins,sizeof(uint32_t));
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ pthread_mutex_init(&cache->mutex,NULL);
+
+#endif
+
+ if(ExistsFile(filename))
+   {
+    off_t size=SizeFile(filename);
+
+    if(size>=(off_t)sizeof(RouteCacheFile))
+      {
+       MapRouteCache(cache,size);
+
+       if(cache->file.magic==ROUTECACHE_MAGIC && cache->file.version==ROUTECACHE_VERSION &&
+          cache->file.stamp==stamp && cache->file.nodes==nodes && cache->file.segments==segments &&
+          size==(off_t)(sizeof(RouteCacheFile)+cache->file.number*sizeof(RouteCacheEntry)+cache->file.npoints*sizeof(RouteCachePoint)))
+          return(cache);
+
+       UnmapRouteCache(cache);
+      }
+
+    fprintf(stderr,"Warning: The route cache file '%s' does not match the database and will be replaced.\n",filename);
+   }
+
+ cache->file.magic=ROUTECACHE_MAGIC;
+ cache->file.version=ROUTECACHE_VERSION;
+ cache->file.stamp=stamp;
+ cache->file.nodes=nodes;
+ cache->file.segments=segments;
+ cache->file.number=0;
+ cache->file.npoints=0;
+
+ return(cache);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Save the cached routes to the file if any have been added (the new file is written
+  alongside the old one and then replaces it).
+
+  int SaveRouteCache Returns 0 if the routes were saved or 1 in case of an error.
+
+  RouteCache *cache The route cache.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int SaveRouteCache(RouteCache *cache)
+{
+ RouteCacheFile file;
+ RouteCacheEntry *entries;
+ RouteCacheEntry **sources;
+ char *tmpfilename;
+ uint32_t i=0,j=0,k=0,offset=0;
+ int fd;
+
+ if(cache->nnew==0)
+    return(0);
+
+ /* Merge the sorted routes from the file with the sorted routes that have been added */
+
+ qsort(cache->newentries,cache->nnew,sizeof(RouteCacheEntry),(int (*)(const void*,const void*))compare_keys);
+
+ entries=(RouteCacheEntry*)malloc((cache->file.number+cache->nnew)*sizeof(RouteCacheEntry));
+ sources=(RouteCacheEntry**)malloc((cache->file.number+cache->nnew)*sizeof(RouteCacheEntry*));
+
+ while(i<cache->file.number || j<cache->nnew)
+   {
+    if(j==cache->nnew || (i<cache->file.number && compare_keys(&cache->entries[i],&cache->newentries[j])<=0))
+      {
+       if(j<cache->nnew && !compare_keys(&cache->entries[i],&cache->newentries[j]))
+          j++;
+
+       sources[k]=&cache->entries[i++];
+      }
+    else
+       sources[k]=&cache->newentries[j++];
+
+    entries[k]=*sources[k];
+    entries[k].offset=offset;
+
+    offset+=entries[k].npoints;
+    k++;
+   }
+
+ /* Write out the header, the routes and the points */
+
+ file=cache->file;
+ file.number=k;
+ file.npoints=offset;
+
+ tmpfilename=(char*)malloc(strlen(cache->filename)+8);
+ sprintf(tmpfilename,"%s.tmp",cache->filename);
+
+ fd=OpenFileNew(tmpfilename);
+
+ WriteFile(fd,&file,sizeof(RouteCacheFile));
+
+ WriteFile(fd,entries,k*sizeof(RouteCacheEntry));
+
+ for(i=0;i<k;i++)
+   {
+    RouteCachePoint *points;
+
+    if(sources[i]>=cache->entries && sources[i]<cache->entries+cache->file.number)
+       points=&cache->points[sources[i]->offset];
+    else
+       points=&cache->newpoints[sources[i]->offset];
+
+    WriteFile(fd,points,sources[i]->npoints*sizeof(RouteCachePoint));
+   }
+
+ CloseFile(fd);
+
+ free(sources);
+ free(entries);
+
+ /* Replace the old file and use the new one */
+
+ if(rename(tmpfilename,cache->filename))
+   {
+    fprintf(stderr,"Error: Cannot rename the route cache file '%s' to '%s' [%s].\n",tmpfilename,cache->filename,strerror(errno));
+    free(tmpfilename);
+    return(1);
+   }
+
+ free(tmpfilename);
+
+ UnmapRouteCache(cache);
+
+ MapRouteCache(cache,SizeFile(cache->filename));
+
+ cache->nnew=0;
+ cache->nnewpoints=0;
+
+ memset(cache->bins,0,cache->nbins*sizeof(uint32_t));
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Fill in the key for the route between two waypoints (a fake node is described by the
+  real segment that it is on and its distance along it so that the key does not depend
+  on the waypoint numbers).
+
+  int MakeRouteCacheKey Returns 0 if the key was made or 1 if the route cannot be cached.
+
+  RouteCacheKey *key Returns the key.
+
+  uint32_t checksum The checksum of the profile.
+
+  int quickest Set to 1 for the quickest route or 0 for the shortest.
+
+  index_t start_node The start node (or fake node).
+
+  index_t finish_node The finish node (or fake node).
+
+  int start_point The waypoint at the start.
+
+  index_t prev_segment The segment used to arrive at the start node (or NO_SEGMENT).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int MakeRouteCacheKey(RouteCacheKey *key,uint32_t checksum,int quickest,index_t start_node,index_t finish_node,int start_point,index_t prev_segment)
+{
+ key->checksum=checksum;
+ key->quickest=quickest;
+
+ if(IsFakeNode(start_node))
+   {
+    Segment *fakesegment=FirstFakeSegment(start_node);
+
+    key->start_node=NO_NODE;
+    key->start_segment=IndexRealSegment(IndexFakeSegment(fakesegment));
+    key->start_distance=DISTANCE(fakesegment->distance);
+   }
+ else
+   {
+    key->start_node=start_node;
+    key->start_segment=NO_SEGMENT;
+    key->start_distance=0;
+   }
+
+ if(IsFakeNode(finish_node))
+   {
+    Segment *fakesegment=FirstFakeSegment(finish_node);
+
+    key->finish_node=NO_NODE;
+    key->finish_segment=IndexRealSegment(IndexFakeSegment(fakesegment));
+    key->finish_distance=DISTANCE(fakesegment->distance);
+   }
+ else
+   {
+    key->finish_node=finish_node;
+    key->finish_segment=NO_SEGMENT;
+    key->finish_distance=0;
+   }
+
+ /* The segments that join two waypoints on the same segment depend on the other waypoints */
+
+ if(IsFakeNode(start_node) && IsFakeNode(finish_node) && key->start_segment==key->finish_segment)
+    return(1);
+
+ key->prev_segment=prev_segment;
+
+ if(IsFakeSegment(prev_segment))
+   {
+    index_t whichsegment=prev_segment-SEGMENT_FAKE;
+
+    if((int)(whichsegment/4+1)!=start_point || (whichsegment%4)>=2)
+       return(1);
+
+    key->prev_segment=SEGMENT_FAKE+whichsegment%4;
+   }
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find a route in the cache and create the results for it.
+
+  Results *FindCachedRoute Returns the results or NULL if the route is not cached.
+
+  RouteCache *cache The route cache.
+
+  RouteCacheKey *key The key of the route.
+
+  int start_point The waypoint at the start of the route.
+
+  int finish_point The waypoint at the finish of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Results *FindCachedRoute(RouteCache *cache,RouteCacheKey *key,int start_point,int finish_point)
+{
+ RouteCacheEntry *entry;
+ Results *results=NULL;
+
+ /* The routes in the file are not modified while routing so they can be searched by any thread */
+
+ if(cache->file.number)
+   {
+    entry=(RouteCacheEntry*)bsearch(key,cache->entries,cache->file.number,sizeof(RouteCacheEntry),(int (*)(const void*,const void*))compare_keys);
+
+    if(entry)
+       return(RebuildRoute(&cache->points[entry->offset],entry->npoints,start_point,finish_point));
+   }
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ pthread_mutex_lock(&cache->mutex);
+
+#endif
+
+ entry=FindNewEntry(cache,key);
+
+ if(entry)
+    results=RebuildRoute(&cache->newpoints[entry->offset],entry->npoints,start_point,finish_point);
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ pthread_mutex_unlock(&cache->mutex);
+
+#endif
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Add a route to the cache (unless it uses a fake node or segment of another waypoint).
+
+  RouteCache *cache The route cache.
+
+  RouteCacheKey *key The key of the route.
+
+  Results *results The results for the route.
+
+  int start_point The waypoint at the start of the route.
+
+  int finish_point The waypoint at the finish of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void AddCachedRoute(RouteCache *cache,RouteCacheKey *key,Results *results,int start_point,int finish_point)
+{
+ RouteCachePoint *points=NULL;
+ Result *result;
+ uint32_t npoints=0;
+
+ /* Copy the route and replace the fake nodes and segments */
+
+ result=FindResult(results,results->start_node,results->prev_segment);
+
+ for(;result;result=result->next)
+   {
+    if((npoints%64)==0)
+       points=(RouteCachePoint*)realloc((void*)points,(npoints+64)*sizeof(RouteCachePoint));
+
+    points[npoints].node=result->node;
+    points[npoints].segment=result->segment;
+    points[npoints].score=result->score;
+
+    if(NormaliseRoutePoint(&points[npoints],start_point,finish_point))
+      {
+       free(points);
+       return;
+      }
+
+    npoints++;
+   }
+
+ if(npoints==0)
+    return;
+
+ /* Store the route unless another thread has just stored it */
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ pthread_mutex_lock(&cache->mutex);
+
+#endif
+
+ if(!FindNewEntry(cache,key))
+   {
+    if((cache->nnew%INCREMENT_ENTRIES)==0)
+       cache->newentries=(RouteCacheEntry*)realloc((void*)cache->newentries,(cache->nnew+INCREMENT_ENTRIES)*sizeof(RouteCacheEntry));
+
+    if((cache->nnewpoints+npoints)>cache->snewpoints)
+      {
+       while((cache->nnewpoints+npoints)>cache->snewpoints)
+          cache->snewpoints=cache->snewpoints?2*cache->snewpoints:65536;
+
+       cache->newpoints=(RouteCachePoint*)realloc((void*)cache->newpoints,cache->snewpoints*sizeof(RouteCachePoint));
+      }
+
+    memcpy(&cache->newpoints[cache->nnewpoints],points,npoints*sizeof(RouteCachePoint));
+
+    cache->newentries[cache->nnew].key=*key;
+    cache->newentries[cache->nnew].offset=cache->nnewpoints;
+    cache->newentries[cache->nnew].npoints=npoints;
+
+    cache->nnewpoints+=npoints;
+
+    InsertNewEntry(cache,cache->nnew++);
+   }
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ pthread_mutex_unlock(&cache->mutex);
+
+#endif
+
+ free(points);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Replace the fake node and segment of a point on a route with ones that refer to the start
+  as waypoint 1 and the finish as waypoint 2.
+
+  int NormaliseRoutePoint Returns 0 if OK or 1 if the point cannot be cached.
+
+  RouteCachePoint *point The point to modify.
+
+  int start_point The waypoint at the start of the route.
+
+  int finish_point The waypoint at the finish of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int NormaliseRoutePoint(RouteCachePoint *point,int start_point,int finish_point)
+{
+ if(IsFakeNode(point->node))
+   {
+    int whichnode=point->node-NODE_FAKE;
+
+    if(whichnode==start_point)
+       point->node=NODE_FAKE+1;
+    else if(whichnode==finish_point)
+       point->node=NODE_FAKE+2;
+    else
+       return(1);
+   }
+
+ /* Only the two fake segments that split the real segment at a waypoint are kept */
+
+ if(IsFakeSegment(point->segment))
+   {
+    index_t whichsegment=point->segment-SEGMENT_FAKE;
+    int whichnode=whichsegment/4+1;
+
+    if((whichsegment%4)>=2)
+       return(1);
+
+    if(whichnode==start_point)
+       point->segment=SEGMENT_FAKE+whichsegment%4;
+    else if(whichnode==finish_point)
+       point->segment=SEGMENT_FAKE+4+whichsegment%4;
+    else
+       return(1);
+   }
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Convert a node from a cached route into one for the current waypoints.
+
+  index_t CachedNode Returns the node.
+
+  index_t node The node from the cached route.
+
+  int start_point The waypoint at the start of the route.
+
+  int finish_point The waypoint at the finish of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t CachedNode(index_t node,int start_point,int finish_point)
+{
+ if(IsFakeNode(node))
+    return(NODE_FAKE+((node==NODE_FAKE+1)?start_point:finish_point));
+
+ return(node);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Convert a segment from a cached route into one for the current waypoints.
+
+  index_t CachedSegment Returns the segment.
+
+  index_t segment The segment from the cached route.
+
+  int start_point The waypoint at the start of the route.
+
+  int finish_point The waypoint at the finish of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static index_t CachedSegment(index_t segment,int start_point,int finish_point)
+{
+ if(IsFakeSegment(segment))
+   {
+    index_t whichsegment=segment-SEGMENT_FAKE;
+
+    return(SEGMENT_FAKE+4*(((whichsegment/4)==0?start_point:finish_point)-1)+whichsegment%4);
+   }
+
+ return(segment);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Create the results for a cached route as if it had just been calculated.
+
+  Results *RebuildRoute Returns the results.
+
+  RouteCachePoint *points The points of the cached route.
+
+  uint32_t npoints The number of points.
+
+  int start_point The waypoint at the start of the route.
+
+  int finish_point The waypoint at the finish of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Results *RebuildRoute(RouteCachePoint *points,uint32_t npoints,int start_point,int finish_point)
+{
+ Results *results;
+ Result *result=NULL;
+ uint32_t i;
+
+ results=NewResultsList(2*npoints);
+
+ results->start_node=CachedNode(points[0].node,start_point,finish_point);
+ results->prev_segment=CachedSegment(points[0].segment,start_point,finish_point);
+
+ for(i=0;i<npoints;i++)
+   {
+    Result *prev=result;
+
+    result=InsertResult(results,CachedNode(points[i].node,start_point,finish_point),CachedSegment(points[i].segment,start_point,finish_point));
+
+    result->score=points[i].score;
+    result->prev=prev;
+   }
+
+ FixForwardRoute(results,result);
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find a route that has been added to the cache (the mutex must be held).
+
+  RouteCacheEntry *FindNewEntry Returns the route or NULL if it has not been added.
+
+  RouteCache *cache The route cache.
+
+  RouteCacheKey *key The key of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static RouteCacheEntry *FindNewEntry(RouteCache *cache,RouteCacheKey *key)
+{
+ uint32_t bin=hash_key(key)&(cache->nbins-1);
+
+ while(cache->bins[bin])
+   {
+    RouteCacheEntry *entry=&cache->newentries[cache->bins[bin]-1];
+
+    if(!memcmp(&entry->key,key,sizeof(RouteCacheKey)))
+       return(entry);
+
+    bin=(bin+1)&(cache->nbins-1);
+   }
+
+ return(NULL);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Insert a route that has been added to the cache into the hash table (the mutex must be held).
+
+  RouteCache *cache The route cache.
+
+  uint32_t index The index of the route in the array of added routes.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void InsertNewEntry(RouteCache *cache,uint32_t index)
+{
+ uint32_t bin;
+
+ /* Double the size of the hash table if it is more than half full */
+
+ if(2*(index+1)>cache->nbins)
+   {
+    uint32_t i;
+
+    cache->nbins<<=1;
+
+    cache->bins=(uint32_t*)realloc((void*)cache->bins,cache->nbins*sizeof(uint32_t));
+
+    memset(cache->bins,0,cache->nbins*sizeof(uint32_t));
+
+    for(i=0;i<index;i++)
+       InsertNewEntry(cache,i);
+   }
+
+ bin=hash_key(&cache->newentries[index].key)&(cache->nbins-1);
+
+ while(cache->bins[bin])
+    bin=(bin+1)&(cache->nbins-1);
+
+ cache->bins[bin]=index+1;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate the hash of a route key.
+
+  uint32_t hash_key Returns the hash.
+
+  RouteCacheKey *key The key of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static uint32_t hash_key(RouteCacheKey *key)
+{
+ const unsigned char *bytes=(const unsigned char*)key;
+ uint32_t hash=2166136261U;
+ size_t i;
+
+ for(i=0;i<sizeof(RouteCacheKey);i++)
+    hash=(hash^bytes[i])*16777619U;
+
+ return(hash);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Map the route cache file into memory (or read it in for the slim version).
+
+  RouteCache *cache The route cache.
+
+  off_t size The size of the file.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void MapRouteCache(RouteCache *cache,off_t size)
+{
+#if !SLIM
+
+ cache->data=MapFile(cache->filename);
+
+#else
+
+ int fd=ReOpenFile(cache->filename);
+
+ cache->data=malloc(size);
+
+ ReadFile(fd,cache->data,size);
+
+ CloseFile(fd);
+
+#endif
+
+ /* Copy the RouteCacheFile header structure from the loaded data */
+
+ cache->file=*((RouteCacheFile*)cache->data);
+
+ /* Set the pointers in the RouteCache structure. */
+
+ cache->entries=(RouteCacheEntry*)(cache->data+sizeof(RouteCacheFile));
+ cache->points =(RouteCachePoint*)(cache->data+sizeof(RouteCacheFile)+cache->file.number*sizeof(RouteCacheEntry));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Unmap the route cache file (or free the memory for the slim version).
+
+  RouteCache *cache The route cache.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void UnmapRouteCache(RouteCache *cache)
+{
+ if(!cache->data)
+    return;
+
+#if !SLIM
+
+ UnmapFile(cache->filename);
+
+#else
+
+ free(cache->data);
+
+#endif
+
+ cache->data=NULL;
+ cache->entries=NULL;
+ cache->points=NULL;
+
+ cache->file.number=0;
+ cache->file.npoints=0;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Compare the keys of two routes.
+
+  int compare_keys Returns the comparison of the keys.
+
+  const RouteCacheEntry *a The first route (or a key).
+
+  const RouteCacheEntry *b The second route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int compare_keys(const RouteCacheEntry *a,const RouteCacheEntry *b)
+{
+ return(memcmp(&a->key,&b->key,sizeof(RouteCacheKey)));
+}
@@ -0,0 +1,149 @@
+/***************************************
+ A header file for the persistent cache of calculated routes.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#ifndef ROUTECACHE_H
+#define ROUTECACHE_H    /*+ To stop multiple inclusions. +*/
+
+#include <stdint.h>
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "types.h"
+#include "results.h"
+
+
+/* Constants */
+
+/*+ The magic number at the start of a route cache file ("RTCH" when read as bytes). +*/
+#define ROUTECACHE_MAGIC 0x48435452
+
+/*+ The version of the route cache file format (changed whenever the routes in older files must not be used). +*/
+#define ROUTECACHE_VERSION 1
+
+
+/* Data structures */
+
+
+/*+ The key that identifies a cached route (compared as bytes so there must be no padding). +*/
+typedef struct _RouteCacheKey
+{
+ uint32_t   checksum;           /*+ The checksum of the profile that the route was calculated for. +*/
+ uint32_t   quickest;           /*+ Set to 1 if the route is the quickest or 0 for the shortest. +*/
+
+ index_t    start_node;         /*+ The start node (or NO_NODE if the start is within a segment). +*/
+ index_t    start_segment;      /*+ The segment that contains the start (or NO_SEGMENT if it is a node). +*/
+ distance_t start_distance;     /*+ The distance of the start along the segment from its first node. +*/
+
+ index_t    finish_node;        /*+ The finish node (or NO_NODE if the finish is within a segment). +*/
+ index_t    finish_segment;     /*+ The segment that contains the finish (or NO_SEGMENT if it is a node). +*/
+ distance_t finish_distance;    /*+ The distance of the finish along the segment from its first node. +*/
+
+ index_t    prev_segment;       /*+ The segment used to arrive at the start (or NO_SEGMENT). +*/
+}
+ RouteCacheKey;
+
+
+/*+ A cached route (the routes are sorted by key in the file). +*/
+typedef struct _RouteCacheEntry
+{
+ RouteCacheKey key;             /*+ The key of the route. +*/
+
+ uint32_t   offset;             /*+ The index of the first point of the route. +*/
+ uint32_t   npoints;            /*+ The number of points in the route. +*/
+}
+ RouteCacheEntry;
+
+
+/*+ A point on a cached route (the fake nodes and segments refer to the start as
+    waypoint 1 and the finish as waypoint 2). +*/
+typedef struct _RouteCachePoint
+{
+ index_t    node;               /*+ The node. +*/
+ index_t    segment;            /*+ The segment used to get to the node. +*/
+
+ score_t    score;              /*+ The score from the start to the node. +*/
+}
+ RouteCachePoint;
+
+
+/*+ A structure containing the header from the file. +*/
+typedef struct _RouteCacheFile
+{
+ uint32_t   magic;              /*+ The magic number that identifies a route cache file. +*/
+ uint32_t   version;            /*+ The version of the file format. +*/
+
+ uint64_t   stamp;              /*+ The stamp of the database files that the routes were calculated with. +*/
+
+ index_t    nodes;              /*+ The number of nodes in the database. +*/
+ index_t    segments;           /*+ The number of segments in the database. +*/
+
+ uint32_t   number;             /*+ The number of routes. +*/
+ uint32_t   npoints;            /*+ The total number of points in the routes. +*/
+}
+ RouteCacheFile;
+
+
+/*+ A structure containing the cached routes. +*/
+typedef struct _RouteCache
+{
+ char            *filename;     /*+ The name of the file. +*/
+
+ RouteCacheFile   file;         /*+ The header data from the file (or for a new file). +*/
+
+ void            *data;         /*+ The memory mapped data in the file (or NULL if there is no file). +*/
+
+ RouteCacheEntry *entries;      /*+ A pointer to the array of routes in the file. +*/
+ RouteCachePoint *points;       /*+ A pointer to the array of points in the file. +*/
+
+ uint32_t         nnew;         /*+ The number of routes that have been added. +*/
+ uint32_t         nnewpoints;   /*+ The total number of points in the routes that have been added. +*/
+ uint32_t         snewpoints;   /*+ The number of points that there is space for in the allocated array. +*/
+
+ RouteCacheEntry *newentries;   /*+ An allocated array of the routes that have been added. +*/
+ RouteCachePoint *newpoints;    /*+ An allocated array of the points in the routes that have been added. +*/
+
+ uint32_t         nbins;        /*+ The number of slots in the hash table of added routes (a power of 2). +*/
+ uint32_t        *bins;         /*+ The hash table of added routes (the index of the route plus one or zero if empty). +*/
+
+#if defined(USE_PTHREADS) && USE_PTHREADS
+
+ pthread_mutex_t  mutex;        /*+ The mutex that protects the routes that have been added. +*/
+
+#endif
+}
+ RouteCache;
+
+
+/* Functions in routecache.c */
+
+RouteCache *LoadRouteCache(const char *filename,uint64_t stamp,index_t nodes,index_t segments);
+int SaveRouteCache(RouteCache *cache);
+
+int MakeRouteCacheKey(RouteCacheKey *key,uint32_t checksum,int quickest,index_t start_node,index_t finish_node,int start_point,index_t prev_segment);
+
+Results *FindCachedRoute(RouteCache *cache,RouteCacheKey *key,int start_point,int finish_point);
+void AddCachedRoute(RouteCache *cache,RouteCacheKey *key,Results *results,int start_point,int finish_point);
+
+
+#endif /* ROUTECACHE_H */
@@ -0,0 +1,224 @@
+/***************************************
+ Route store data extractor.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "types.h"
+#include "routestore.h"
+
+#include "files.h"
+
+
+/* Local functions */
+
+static void print_route(RouteStore *store,RouteStoreEntry *entry);
+
+static void print_usage(int detail,const char *argerr,const char *err);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  The main program for the route store dumper.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int main(int argc,char** argv)
+{
+ RouteStore *store;
+ int         arg;
+ char       *filename=NULL;
+ int         option_statistics=0;
+ int         option_list=0;
+ int         option_dump=0;
+
+ /* Parse the command line arguments */
+
+ for(arg=1;arg<argc;arg++)
+   {
+    if(!strcmp(argv[arg],"--help"))
+       print_usage(1,NULL,NULL);
+    else if(!strncmp(argv[arg],"--store=",8))
+       filename=&argv[arg][8];
+    else if(!strcmp(argv[arg],"--statistics"))
+       option_statistics=1;
+    else if(!strcmp(argv[arg],"--list"))
+       option_list=1;
+    else if(!strcmp(argv[arg],"--dump"))
+       option_dump=1;
+    else if(!strncmp(argv[arg],"--route=",8))
+       ;
+    else
+       print_usage(0,argv[arg],NULL);
+   }
+
+ if(!filename)
+    print_usage(0,NULL,"The --store option must be used.");
+
+ if((option_statistics + option_list + option_dump)!=1)
+    print_usage(0,NULL,"Must choose --statistics, --list or --dump.");
+
+ /* Load in the data */
+
+ store=LoadRouteStore(filename);
+
+ if(!store)
+    return(1);
+
+ /* Print out statistics */
+
+ if(option_statistics)
+   {
+    struct stat buf;
+
+    stat(filename,&buf);
+
+    printf("'%s' - %9lld Bytes\n",filename,(long long)buf.st_size);
+    printf("\n");
+
+    printf("sizeof(RouteStoreEntry)=%9lu Bytes\n",(unsigned long)sizeof(RouteStoreEntry));
+    printf("sizeof(RouteStoreCoord)=%9lu Bytes\n",(unsigned long)sizeof(RouteStoreCoord));
+    printf("Number(routes)         =%9u\n",store->file.number);
+    printf("Number(points)         =%9u\n",store->file.npoints);
+    printf("Total identifiers      =%9u Bytes\n",store->file.idsize);
+   }
+
+ /* Print out the identifier and totals of each route */
+
+ if(option_list)
+   {
+    uint32_t i;
+
+    for(i=0;i<store->file.number;i++)
+      {
+       RouteStoreEntry *entry=&store->entries[i];
+
+       printf("%s\t%u\t%.3f\t%.1f\n",StoredRouteId(store,entry),entry->npoints,
+              distance_to_km(entry->distance),duration_to_minutes(entry->duration));
+      }
+   }
+
+ /* Print out selected routes (in plain text format) */
+
+ if(option_dump)
+   {
+    for(arg=1;arg<argc;arg++)
+       if(!strcmp(argv[arg],"--route=all"))
+         {
+          uint32_t i;
+
+          for(i=0;i<store->file.number;i++)
+             print_route(store,&store->entries[i]);
+         }
+       else if(!strncmp(argv[arg],"--route=",8))
+         {
+          RouteStoreEntry *entry=FindStoredRoute(store,&argv[arg][8]);
+
+          if(entry)
+             print_route(store,entry);
+          else
+             printf("Invalid route identifier '%s'.\n",&argv[arg][8]);
+         }
+   }
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print out the contents of a route from the route store (as plain text).
+
+  RouteStore *store The stored routes.
+
+  RouteStoreEntry *entry The route to print.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void print_route(RouteStore *store,RouteStoreEntry *entry)
+{
+ RouteStoreCoord *coords=StoredRouteCoords(store,entry);
+ index_t *segments=StoredRouteSegments(store,entry);
+ uint32_t i;
+
+ printf("Route %s\n",StoredRouteId(store,entry));
+ printf("  npoints=%u\n",entry->npoints);
+ printf("  distance=%u (%.3f km)\n",entry->distance,distance_to_km(entry->distance));
+ printf("  duration=%u (%.1f min)\n",entry->duration,duration_to_minutes(entry->duration));
+
+ for(i=0;i<entry->npoints;i++)
+   {
+    printf("  latitude=%.7f longitude=%.7f",coords[i].latitude/ROUTESTORE_SCALE,coords[i].longitude/ROUTESTORE_SCALE);
+
+    if(segments[i]==NO_SEGMENT)
+       printf("\n");
+    else
+       printf(" segment=%"Pindex_t"\n",segments[i]);
+   }
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print out the usage information.
+
+  int detail The level of detail to use - 0 = low, 1 = high.
+
+  const char *argerr The argument that gave the error (if there is one).
+
+  const char *err Other error message (if there is one).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void print_usage(int detail,const char *argerr,const char *err)
+{
+ fprintf(stderr,
+         "Usage: routedumper [--help]\n"
+         "                   --store=<filename>\n"
+         "                   [--statistics]\n"
+         "                   [--list]\n"
+         "                   [--dump [--route=<id> ...]]\n");
+
+ if(argerr)
+    fprintf(stderr,
+            "\n"
+            "Error with command line parameter: %s\n",argerr);
+
+ if(err)
+    fprintf(stderr,
+            "\n"
+            "Error: %s\n",err);
+
+ if(detail)
+    fprintf(stderr,
+            "\n"
+            "--help                    Prints this information.\n"
+            "\n"
+            "--store=<filename>        The route store written by 'router --batch-store'.\n"
+            "\n"
+            "--statistics              Print statistics about the route store.\n"
+            "\n"
+            "--list                    Print the identifier, number of points, distance (km)\n"
+            "                          and duration (minutes) of each route.\n"
+            "\n"
+            "--dump                    Dump selected routes from the route store.\n"
+            "  --route=<id>            * the route with the selected identifier.\n"
+            "                          Use 'all' instead of an identifier to get all of them.\n");
+
+ exit(!detail);
+}
@@ -24,12 +24,24 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "types.h"
 #include "nodes.h"
 #include "segments.h"
 #include "ways.h"
 #include "relations.h"
+#include "contraction.h"
+#include "routecache.h"
+#include "routestore.h"
+#include "flows.h"
+#include "router.h"
+#include "serve.h"
+#include "batch.h"
+#include "matrix.h"
 
 #include "files.h"
 #include "logging.h"
@@ -43,6 +55,32 @@
 #define MAXSEARCH  1
 
 
+/* Local types */
+
+/*+ A row from a file of points to be snapped. +*/
+typedef struct _SnapRow
+{
+ char    *id;                           /*+ The identifier of the point. +*/
+ double   lat;                          /*+ The latitude of the point. +*/
+ double   lon;                          /*+ The longitude of the point. +*/
+}
+ SnapRow;
+
+/*+ The header of a snapped points file. +*/
+typedef struct _SnappedPointsFile
+{
+ uint32_t   number;                     /*+ The number of points. +*/
+ uint32_t   checksum;                   /*+ The checksum of the profile that the points were snapped for. +*/
+
+ index_t    nodes;                      /*+ The number of nodes in the database. +*/
+ index_t    segments;                   /*+ The number of segments in the database. +*/
+
+ uint32_t   idsize;                     /*+ The size of the identifiers (following the points). +*/
+}
+ SnappedPointsFile;
+
+
+
 /* Global variables */
 
 /*+ The option not to print any progress information. +*/
@@ -50,13 +88,74 @@ int option_quiet=0;
 
 /*+ The options to select the format of the output. +*/
 int option_html=0,option_gpx_track=0,option_gpx_route=0,option_text=0,option_text_all=0,option_none=0;
+int option_binary=0,option_polyline=0,option_geojson=0;
+
+/*+ The options to select where the output is written (a directory and a prefix for the files or stdout). +*/
+char *option_output_dir=NULL,*option_output_prefix=NULL;
+int option_output_stdout=0;
 
 /*+ The option to calculate the quickest route insted of the shortest. +*/
 int option_quickest=0;
 
+/*+ The option to search forwards and backwards at the same time. +*/
+int option_bidirectional=0;
+
+/*+ The option to direct the search towards the finish node. +*/
+int option_astar=0;
+
+/*+ The option to print the time taken and the work done for each section of the route (1=text, 2=JSON). +*/
+int option_stats=0;
+
+/*+ The option to print the batch routes as rows for the PostgreSQL COPY command. +*/
+int option_pgcopy=0;
+
+/*+ The option to print the batch routes as binary records for a route store. +*/
+int option_store=0;
+
+/*+ The option to add the weight of the batch routes to the segment volumes instead of printing them. +*/
+int option_flow=0;
+
+/*+ The cache of routes that have been calculated before (or NULL). +*/
+RouteCache *routecache=NULL;
+
+
+/* Local variables */
+
+/*+ The contraction hierarchies that have been loaded. +*/
+static Contraction **contractions=NULL;
+
+/*+ The number of contraction hierarchies that have been loaded. +*/
+static int ncontractions=0;
+
+/*+ The header of the snapped points file that has been loaded. +*/
+static SnappedPointsFile snappedfile;
+
+/*+ The snapped points that have been loaded (or NULL). +*/
+static SnappedPoint *snappedpoints=NULL;
+
+/*+ The identifiers of the snapped points that have been loaded. +*/
+static char *snappedids=NULL;
+
+/*+ The names of the parts of the calculation of a route that are timed. +*/
+static const char *phasenames[Phase_Count]={"FindContractedRoute","FindStartRoutes","FindFinishRoutes","FindMiddleRoute","CombineRoutes"};
+
 
 /* Local functions */
 
+static int SnapWaypoints(Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,Query *query,int exactnodes);
+static int ValidSnappedWaypoints(Segments *segments,Ways *ways,Profile *profile,Query *query);
+static int RouteSnappedWaypoints(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Query *query);
+static Results *CalculateRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,
+                               index_t start_node,index_t prev_segment,index_t finish_node,LegStats *stats,const char **error);
+
+static void StartTimer(LegStats *stats,struct timespec *start);
+static void StopTimer(LegStats *stats,Phase phase,struct timespec *start);
+
+static int SnapPoints(const char *filename,FILE *output,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes);
+static int LoadSnappedPoints(const char *filename,Nodes *nodes,Segments *segments);
+static int sort_by_id(SnapRow *a,SnapRow *b);
+static int compare_snapped_id(const char *id,SnappedPoint *snappedpoint);
+
 static void print_usage(int detail,const char *argerr,const char *err);
 
 
@@ -70,20 +169,24 @@ int main(int argc,char** argv)
  Segments *OSMSegments;
  Ways     *OSMWays;
  Relations*OSMRelations;
- Results  *results[NWAYPOINTS+1]={NULL};
- int       point_used[NWAYPOINTS+1]={0};
- double    point_lon[NWAYPOINTS+1],point_lat[NWAYPOINTS+1];
- double    heading=-999;
+ uint64_t  stamp;
+ Query     query;
  int       help_profile=0,help_profile_xml=0,help_profile_json=0,help_profile_pl=0;
  char     *dirname=NULL,*prefix=NULL;
  char     *profiles=NULL,*profilename=NULL;
  char     *translations=NULL,*language=NULL;
+ char     *serve=NULL,*batch=NULL,*matrix=NULL,*batchstore=NULL,*batchflow=NULL;
+ char     *snap=NULL,*snapped=NULL;
+ char     *routecachefile=NULL;
+ int       matrix_binary=0;
+ int       nthreads=1;
  int       exactnodes=0;
+ int       usecontraction=0;
  Transport transport=Transport_None;
  Profile  *profile=NULL;
- index_t   start_node=NO_NODE,finish_node=NO_NODE;
- index_t   join_segment=NO_SEGMENT;
- int       arg,point;
+ Profile **chain=NULL;
+ int       nchain=0;
+ int       arg,point,c;
 
  /* Parse the command line arguments */
 
@@ -114,10 +217,53 @@ int main(int argc,char** argv)
        translations=&argv[arg][15];
     else if(!strcmp(argv[arg],"--exact-nodes-only"))
        exactnodes=1;
+    else if(!strcmp(argv[arg],"--bidirectional"))
+       option_bidirectional=1;
+    else if(!strcmp(argv[arg],"--contraction"))
+       usecontraction=1;
+    else if(!strcmp(argv[arg],"--astar"))
+       option_astar=1;
     else if(!strcmp(argv[arg],"--quiet"))
        option_quiet=1;
     else if(!strcmp(argv[arg],"--loggable"))
        option_loggable=1;
+    else if(!strcmp(argv[arg],"--stats"))
+       option_stats=1;
+    else if(!strcmp(argv[arg],"--stats=json"))
+       option_stats=2;
+    else if(!strcmp(argv[arg],"--serve"))
+       serve="-";
+    else if(!strncmp(argv[arg],"--serve=",8))
+       serve=&argv[arg][8];
+    else if(!strncmp(argv[arg],"--batch=",8))
+       batch=&argv[arg][8];
+    else if(!strncmp(argv[arg],"--matrix=",9))
+       matrix=&argv[arg][9];
+    else if(!strcmp(argv[arg],"--matrix-binary"))
+       matrix_binary=1;
+    else if(!strcmp(argv[arg],"--batch-pgcopy"))
+       option_pgcopy=1;
+    else if(!strncmp(argv[arg],"--batch-store=",14))
+       batchstore=&argv[arg][14];
+    else if(!strncmp(argv[arg],"--batch-flow=",13))
+       batchflow=&argv[arg][13];
+    else if(!strncmp(argv[arg],"--snap-points=",14))
+       snap=&argv[arg][14];
+    else if(!strncmp(argv[arg],"--snapped-points=",17))
+       snapped=&argv[arg][17];
+    else if(!strncmp(argv[arg],"--route-cache=",14))
+       routecachefile=&argv[arg][14];
+    else if(!strncmp(argv[arg],"--threads=",10))
+      {
+       nthreads=atoi(&argv[arg][10]);
+
+       if(nthreads<1)
+          print_usage(0,argv[arg],NULL);
+#if !defined(USE_PTHREADS) || !USE_PTHREADS
+       if(nthreads>1)
+          print_usage(0,NULL,"The '--threads' option is not available (compiled without thread support).");
+#endif
+      }
     else if(!strcmp(argv[arg],"--output-html"))
        option_html=1;
     else if(!strcmp(argv[arg],"--output-gpx-track"))
@@ -128,8 +274,20 @@ int main(int argc,char** argv)
        option_text=1;
     else if(!strcmp(argv[arg],"--output-text-all"))
        option_text_all=1;
+    else if(!strcmp(argv[arg],"--output-binary"))
+       option_binary=1;
+    else if(!strcmp(argv[arg],"--output-polyline"))
+       option_polyline=1;
+    else if(!strcmp(argv[arg],"--output-geojson"))
+       option_geojson=1;
     else if(!strcmp(argv[arg],"--output-none"))
        option_none=1;
+    else if(!strncmp(argv[arg],"--output-dir=",13))
+       option_output_dir=&argv[arg][13];
+    else if(!strncmp(argv[arg],"--output-prefix=",16))
+       option_output_prefix=&argv[arg][16];
+    else if(!strcmp(argv[arg],"--output-stdout"))
+       option_output_stdout=1;
     else if(!strncmp(argv[arg],"--profile=",10))
        profilename=&argv[arg][10];
     else if(!strncmp(argv[arg],"--language=",11))
@@ -179,17 +337,34 @@ int main(int argc,char** argv)
     return(1);
    }
 
- /* Choose the selected profile. */
+ /* Choose the selected profile (or list of profiles to try in order). */
 
  if(profilename)
    {
-    profile=GetProfile(profilename);
+    char *name=profilename;
 
-    if(!profile)
+    while(name)
       {
-       fprintf(stderr,"Error: Cannot find a profile called '%s' in '%s'.\n",profilename,profiles);
-       return(1);
+       char *comma=strchr(name,',');
+
+       if(comma)
+          *comma=0;
+
+       profile=GetProfile(name);
+
+       if(!profile)
+         {
+          fprintf(stderr,"Error: Cannot find a profile called '%s' in '%s'.\n",name,profiles);
+          return(1);
+         }
+
+       chain=(Profile**)realloc((void*)chain,(nchain+1)*sizeof(Profile*));
+       chain[nchain++]=profile;
+
+       name=comma?comma+1:NULL;
       }
+
+    profile=chain[0];
    }
  else
     profile=GetProfile(TransportName(transport));
@@ -200,158 +375,96 @@ int main(int argc,char** argv)
     profile->transport=transport;
    }
 
+ if(!chain)
+   {
+    chain=(Profile**)malloc(sizeof(Profile*));
+    chain[nchain++]=profile;
+   }
+
  /* Parse the other command line arguments */
 
+ InitQuery(&query);
+
  for(arg=1;arg<argc;arg++)
    {
     if(!argv[arg])
        continue;
-    else if(!strcmp(argv[arg],"--shortest"))
-       option_quickest=0;
-    else if(!strcmp(argv[arg],"--quickest"))
-       option_quickest=1;
-    else if(isdigit(argv[arg][0]) ||
-       ((argv[arg][0]=='-' || argv[arg][0]=='+') && isdigit(argv[arg][1])))
-      {
-       for(point=1;point<=NWAYPOINTS;point++)
-          if(point_used[point]!=3)
-            {
-             if(point_used[point]==0)
-               {
-                point_lon[point]=degrees_to_radians(atof(argv[arg]));
-                point_used[point]=1;
-               }
-             else /* if(point_used[point]==1) */
-               {
-                point_lat[point]=degrees_to_radians(atof(argv[arg]));
-                point_used[point]=3;
-               }
-             break;
-            }
-      }
-     else if(!strncmp(argv[arg],"--lon",5) && isdigit(argv[arg][5]))
-       {
-        char *p=&argv[arg][6];
-        while(isdigit(*p)) p++;
-        if(*p++!='=')
-           print_usage(0,argv[arg],NULL);
- 
-        point=atoi(&argv[arg][5]);
-        if(point>NWAYPOINTS || point_used[point]&1)
-           print_usage(0,argv[arg],NULL);
- 
-       point_lon[point]=degrees_to_radians(atof(p));
-       point_used[point]+=1;
-      }
-     else if(!strncmp(argv[arg],"--lat",5) && isdigit(argv[arg][5]))
-       {
-        char *p=&argv[arg][6];
-        while(isdigit(*p)) p++;
-        if(*p++!='=')
-           print_usage(0,argv[arg],NULL);
- 
-        point=atoi(&argv[arg][5]);
-        if(point>NWAYPOINTS || point_used[point]&2)
-           print_usage(0,argv[arg],NULL);
- 
-       point_lat[point]=degrees_to_radians(atof(p));
-       point_used[point]+=2;
-      }
-    else if(!strncmp(argv[arg],"--heading=",10))
-      {
-       double h=atof(&argv[arg][10]);
-
-       if(h>=-360 && h<=360)
+    else if(!strncmp(argv[arg],"--transport=",12))
+       ; /* Done this already */
+    else if(ParseRoutingOption(argv[arg],&query,profile))
+       print_usage(0,argv[arg],NULL);
+    else
+       for(c=1;c<nchain;c++)
          {
-          heading=h;
+          Query other;
+
+          InitQuery(&other);
 
-          if(heading<0) heading+=360;
+          ParseRoutingOption(argv[arg],&other,chain[c]);
          }
-      }
-    else if(!strncmp(argv[arg],"--transport=",12))
-       ; /* Done this already */
-    else if(!strncmp(argv[arg],"--highway-",10))
-      {
-       Highway highway;
-       char *equal=strchr(argv[arg],'=');
-       char *string;
+   }
 
-       if(!equal)
-           print_usage(0,argv[arg],NULL);
+ for(point=1;point<=NWAYPOINTS;point++)
+    if(query.point_used[point]==1 || query.point_used[point]==2)
+       print_usage(0,NULL,"All waypoints must have latitude and longitude.");
 
-       string=strcpy((char*)malloc(strlen(argv[arg])),argv[arg]+10);
-       string[equal-argv[arg]-10]=0;
+ if((!!serve+!!batch+!!matrix+!!snap)>1)
+    print_usage(0,NULL,"Only one of the '--serve', '--batch', '--matrix' and '--snap-points' options can be used.");
 
-       highway=HighwayType(string);
+ if(batch || matrix || snap)
+    for(point=1;point<=NWAYPOINTS;point++)
+       if(query.point_used[point])
+          print_usage(0,NULL,"Waypoints cannot be used with the '--batch', '--matrix' or '--snap-points' options.");
 
-       if(highway==Way_Count)
-          print_usage(0,argv[arg],NULL);
+ if(!snapped)
+    for(point=1;point<=NWAYPOINTS;point++)
+       if(query.point_id[point])
+          print_usage(0,NULL,"The '--point<n>' options can only be used with the '--snapped-points' option.");
 
-       profile->highway[highway]=atof(equal+1);
+ if(option_pgcopy && !batch)
+    print_usage(0,NULL,"The '--batch-pgcopy' option can only be used with the '--batch' option.");
 
-       free(string);
-      }
-    else if(!strncmp(argv[arg],"--speed-",8))
-      {
-       Highway highway;
-       char *equal=strchr(argv[arg],'=');
-       char *string;
+ if(batchstore && !batch)
+    print_usage(0,NULL,"The '--batch-store' option can only be used with the '--batch' option.");
 
-       if(!equal)
-          print_usage(0,argv[arg],NULL);
+ if(batchstore && option_pgcopy)
+    print_usage(0,NULL,"The '--batch-store' and '--batch-pgcopy' options cannot be used together.");
 
-       string=strcpy((char*)malloc(strlen(argv[arg])),argv[arg]+8);
-       string[equal-argv[arg]-8]=0;
+ if(batchflow && !batch)
+    print_usage(0,NULL,"The '--batch-flow' option can only be used with the '--batch' option.");
 
-       highway=HighwayType(string);
+ if(batchflow && (option_pgcopy || batchstore))
+    print_usage(0,NULL,"The '--batch-flow' option cannot be used with the '--batch-pgcopy' or '--batch-store' options.");
 
-       if(highway==Way_Count)
-          print_usage(0,argv[arg],NULL);
+ if(batchstore)
+    option_store=1;
 
-       profile->speed[highway]=kph_to_speed(atof(equal+1));
+ if(batchflow)
+    option_flow=1;
 
-       free(string);
-      }
-    else if(!strncmp(argv[arg],"--property-",11))
-      {
-       Property property;
-       char *equal=strchr(argv[arg],'=');
-       char *string;
+ if(routecachefile && (matrix || snap))
+    print_usage(0,NULL,"The '--route-cache' option cannot be used with the '--matrix' or '--snap-points' options.");
 
-       if(!equal)
-          print_usage(0,argv[arg],NULL);
+ if(option_stats && (batch || matrix || snap))
+    print_usage(0,NULL,"The '--stats' option cannot be used with the '--batch', '--matrix' or '--snap-points' options.");
 
-       string=strcpy((char*)malloc(strlen(argv[arg])),argv[arg]+11);
-       string[equal-argv[arg]-11]=0;
+ if(option_output_stdout && (option_html+option_gpx_track+option_gpx_route+option_text+option_text_all+
+                              option_binary+option_polyline+option_geojson)!=1)
+    print_usage(0,NULL,"The '--output-stdout' option needs exactly one of the '--output-<format>' options.");
 
-       property=PropertyType(string);
+ if(option_output_stdout && (serve || batch || matrix || snap))
+    print_usage(0,NULL,"The '--output-stdout' option cannot be used with the '--serve', '--batch', '--matrix' or '--snap-points' options.");
 
-       if(property==Property_Count)
-          print_usage(0,argv[arg],NULL);
+ /* Only the route is written to stdout if it is being streamed */
 
-       profile->props_yes[property]=atof(equal+1);
-
-       free(string);
-      }
-    else if(!strncmp(argv[arg],"--oneway=",9))
-       profile->oneway=!!atoi(&argv[arg][9]);
-    else if(!strncmp(argv[arg],"--turns=",8))
-       profile->turns=!!atoi(&argv[arg][8]);
-    else if(!strncmp(argv[arg],"--weight=",9))
-       profile->weight=tonnes_to_weight(atof(&argv[arg][9]));
-    else if(!strncmp(argv[arg],"--height=",9))
-       profile->height=metres_to_height(atof(&argv[arg][9]));
-    else if(!strncmp(argv[arg],"--width=",8))
-       profile->width=metres_to_width(atof(&argv[arg][8]));
-    else if(!strncmp(argv[arg],"--length=",9))
-       profile->length=metres_to_length(atof(&argv[arg][9]));
-    else
-       print_usage(0,argv[arg],NULL);
-   }
+ if(option_output_stdout)
+    option_quiet=1;
 
- for(point=1;point<=NWAYPOINTS;point++)
-    if(point_used[point]==1 || point_used[point]==2)
-       print_usage(0,NULL,"All waypoints must have latitude and longitude.");
+ if(nthreads>1 && !batch && !matrix)
+    print_usage(0,NULL,"The '--threads' option can only be used with the '--batch' or '--matrix' options.");
+
+ if(nchain>1 && (serve || batch || matrix || snap))
+    print_usage(0,NULL,"A list of profiles cannot be used with the '--serve', '--batch', '--matrix' or '--snap-points' options.");
 
  /* Print one of the profiles if requested */
 
@@ -382,9 +495,13 @@ int main(int argc,char** argv)
 
  /* Load in the translations */
 
- if(option_html==0 && option_gpx_track==0 && option_gpx_route==0 && option_text==0 && option_text_all==0 && option_none==0)
+ if(option_html==0 && option_gpx_track==0 && option_gpx_route==0 && option_text==0 && option_text_all==0 &&
+    option_binary==0 && option_polyline==0 && option_geojson==0 && option_none==0)
     option_html=option_gpx_track=option_gpx_route=option_text=option_text_all=1;
 
+ if(serve || batch || matrix || snap)
+    option_html=option_gpx_track=option_gpx_route=option_text=option_text_all=option_binary=option_polyline=option_geojson=0;
+
  if(option_html || option_gpx_route || option_gpx_track)
    {
     if(translations)
@@ -417,273 +534,1554 @@ int main(int argc,char** argv)
 
  /* Load in the data - Note: No error checking because Load*List() will call exit() in case of an error. */
 
+ stamp=DatabaseStamp(dirname,prefix);
+
  OSMNodes=LoadNodeList(FileName(dirname,prefix,"nodes.mem"));
 
+ if(ExistsFile(FileName(dirname,prefix,"components.mem")))
+    if(LoadNodeComponents(OSMNodes,FileName(dirname,prefix,"components.mem")))
+       fprintf(stderr,"Warning: The connected components file does not match the nodes file and will not be used.\n");
+
+ if(option_astar && ExistsFile(FileName(dirname,prefix,"landmarks.mem")))
+    if(LoadNodeLandmarks(OSMNodes,FileName(dirname,prefix,"landmarks.mem"),stamp))
+       fprintf(stderr,"Warning: The landmarks file does not match the database files and will not be used.\n");
+
  OSMSegments=LoadSegmentList(FileName(dirname,prefix,"segments.mem"));
 
+ if(ExistsFile(FileName(dirname,prefix,"supersegments.mem")))
+    if(LoadSuperSegmentPaths(OSMSegments,FileName(dirname,prefix,"supersegments.mem")))
+       fprintf(stderr,"Warning: The super-segment paths file does not match the segments file and will not be used.\n");
+
+ if(ExistsFile(FileName(dirname,prefix,"segmentbins.mem")))
+    if(LoadSegmentBins(OSMSegments,OSMNodes,FileName(dirname,prefix,"segmentbins.mem")))
+       fprintf(stderr,"Warning: The segment bins file does not match the segments and nodes files and will not be used.\n");
+
  OSMWays=LoadWayList(FileName(dirname,prefix,"ways.mem"));
 
  OSMRelations=LoadRelationList(FileName(dirname,prefix,"relations.mem"));
 
- if(UpdateProfile(profile,OSMWays))
-   {
-    fprintf(stderr,"Error: Profile is invalid or not compatible with database.\n");
-    return(1);
-   }
+ /* Load in the points that were snapped in advance */
 
- /* Loop through all pairs of points */
+ if(snapped)
+    if(LoadSnappedPoints(snapped,OSMNodes,OSMSegments))
+       return(1);
 
- for(point=1;point<=NWAYPOINTS;point++)
-   {
-    Results *begin,*end;
-    Result *finish_result;
-    distance_t distmax=km_to_distance(MAXSEARCH);
-    distance_t distmin;
-    index_t segment=NO_SEGMENT;
-    index_t node1,node2;
-    int     nsuper=0;
+ /* Load in the contraction hierarchies for the selected profiles (if they were created) */
 
-    if(point_used[point]!=3)
-       continue;
+ if(usecontraction)
+    for(c=0;c<nchain;c++)
+      {
+       int quickest;
 
-    /* Find the closest point */
+       for(quickest=0;quickest<=1;quickest++)
+         {
+          char *filename=(char*)malloc(strlen(chain[c]->name)+32);
+          Contraction *contraction;
 
-    start_node=finish_node;
+          sprintf(filename,"contraction-%s-%s.mem",chain[c]->name,quickest?"quickest":"shortest");
 
-    if(exactnodes)
-      {
-       finish_node=FindClosestNode(OSMNodes,OSMSegments,OSMWays,point_lat[point],point_lon[point],distmax,profile,&distmin);
+          if(ExistsFile(FileName(dirname,prefix,filename)))
+            {
+             contraction=LoadContraction(FileName(dirname,prefix,filename));
+
+             if(contraction->file.stamp!=stamp || contraction->file.number!=OSMNodes->file.number || contraction->file.segments!=OSMSegments->file.number)
+                fprintf(stderr,"Warning: The contraction hierarchy file '%s' does not match the database files and will not be used.\n",filename);
+             else
+               {
+                contractions=(Contraction**)realloc((void*)contractions,(ncontractions+1)*sizeof(Contraction*));
+                contractions[ncontractions++]=contraction;
+               }
+            }
+
+          free(filename);
+         }
       }
-    else
+
+ /* Load in the routes that were calculated before (if the database has not changed) */
+
+ if(routecachefile)
+    routecache=LoadRouteCache(routecachefile,stamp,OSMNodes->file.number,OSMSegments->file.number);
+
+ /* Answer queries until the input is closed if running as a server */
+
+ if(serve)
+   {
+    if(!strcmp(serve,"-"))
       {
-       distance_t dist1,dist2;
+       option_quiet=1;
 
-       segment=FindClosestSegment(OSMNodes,OSMSegments,OSMWays,point_lat[point],point_lon[point],distmax,profile,&distmin,&node1,&node2,&dist1,&dist2);
+       ServeQueries(stdin,stdout,OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,exactnodes);
 
-       if(segment!=NO_SEGMENT)
-          finish_node=CreateFakes(OSMNodes,OSMSegments,point,LookupSegment(OSMSegments,segment,1),node1,node2,dist1,dist2);
-       else
-          finish_node=NO_NODE;
+       if(routecache)
+          SaveRouteCache(routecache);
+
+       return(0);
       }
+    else
+       return(ServeSocket(serve,OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,exactnodes));
+   }
 
-    if(finish_node==NO_NODE)
+ for(c=0;c<nchain;c++)
+    if(UpdateProfile(chain[c],OSMWays))
       {
-       fprintf(stderr,"Error: Cannot find node close to specified point %d.\n",point);
+       fprintf(stderr,"Error: Profile is invalid or not compatible with database.\n");
        return(1);
       }
 
-    if(!option_quiet)
-      {
-       double lat,lon;
+ /* The snapped points used by the batch rows or matrix points must match the profile */
 
-       if(IsFakeNode(finish_node))
-          GetFakeLatLong(finish_node,&lat,&lon);
-       else
-          GetLatLong(OSMNodes,finish_node,&lat,&lon);
+ if(snapped && (batch || matrix) && snappedfile.checksum!=ProfileChecksum(profile))
+   {
+    fprintf(stderr,"Error: The snapped points were not created for the same profile.\n");
+    return(1);
+   }
 
-       if(IsFakeNode(finish_node))
-          printf("Point %d is segment %"Pindex_t" (node %"Pindex_t" -> %"Pindex_t"): %3.6f %4.6f = %2.3f km\n",point,segment,node1,node2,
-                 radians_to_degrees(lon),radians_to_degrees(lat),distance_to_km(distmin));
-       else
-          printf("Point %d is node %"Pindex_t": %3.6f %4.6f = %2.3f km\n",point,finish_node,
-                 radians_to_degrees(lon),radians_to_degrees(lat),distance_to_km(distmin));
-      }
+ /* Snap each of the points in the file and write them out */
 
-    if(start_node==NO_NODE)
-       continue;
+ if(snap)
+   {
+    option_quiet=1;
 
-    if(start_node==finish_node)
-       continue;
+    return(SnapPoints(snap,stdout,OSMNodes,OSMSegments,OSMWays,profile,exactnodes));
+   }
 
-    if(heading!=-999 && join_segment==NO_SEGMENT)
-       join_segment=FindClosestSegmentHeading(OSMNodes,OSMSegments,OSMWays,start_node,heading,profile);
+ /* Route each of the rows in the batch file */
 
-    /* Calculate the beginning of the route */
+ if(batch)
+   {
+    int failed;
 
-    begin=FindStartRoutes(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,start_node,join_segment,finish_node,&nsuper);
+    option_quiet=1;
 
-    if(!begin && join_segment!=NO_SEGMENT)
+    if(batchstore)
       {
-       /* Try again but allow a U-turn at the start waypoint -
-          this solves the problem of facing a dead-end that contains no super-nodes. */
+       /* The routes are written in batch order and then sorted into the store */
 
-       join_segment=NO_SEGMENT;
+       char *recordsname=(char*)malloc(strlen(batchstore)+8);
+       FILE *records;
 
-       begin=FindStartRoutes(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,start_node,join_segment,finish_node,&nsuper);
-      }
+       sprintf(recordsname,"%s.tmp",batchstore);
 
-    if(!begin)
-      {
-       fprintf(stderr,"Error: Cannot find initial section of route compatible with profile.\n");
-       return(1);
-      }
+       if(!(records=fopen(recordsname,"w")))
+         {
+          fprintf(stderr,"Error: Cannot open file '%s' for writing [%s].\n",recordsname,strerror(errno));
+          return(1);
+         }
 
-    finish_result=FindResult1(begin,finish_node);
+       failed=BatchQueries(batch,records,OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,query.heading,exactnodes,nthreads);
 
-    if(nsuper || !finish_result)
-      {
-       /* The route may include super-nodes but there may also be a route
-          without passing any super-nodes to fall back on */
+       if(fclose(records))
+         {
+          fprintf(stderr,"Error: Cannot write file '%s' [%s].\n",recordsname,strerror(errno));
+          failed=1;
+         }
 
-       Results *middle;
+       if(!failed)
+          failed=WriteRouteStore(recordsname,batchstore);
 
-       /* Calculate the end of the route */
+       unlink(recordsname);
 
-       end=FindFinishRoutes(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,finish_node);
+       free(recordsname);
+      }
+    else if(batchflow)
+      {
+       /* The weights of the routes are added to the segments and then the volumes are written */
 
-       if(!end)
+       FILE *flows;
+
+       if(!(flows=fopen(batchflow,"w")))
          {
-          fprintf(stderr,"Error: Cannot find final section of route compatible with profile.\n");
+          fprintf(stderr,"Error: Cannot open file '%s' for writing [%s].\n",batchflow,strerror(errno));
           return(1);
          }
 
-       /* Calculate the middle of the route */
+       failed=BatchQueries(batch,stdout,OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,query.heading,exactnodes,nthreads);
 
-       middle=FindMiddleRoute(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,begin,end);
+       WriteFlows(flows,OSMNodes,OSMSegments);
 
-       if(!middle && join_segment!=NO_SEGMENT && !finish_result)
+       if(fclose(flows))
          {
-          /* Try again but allow a U-turn at the start waypoint -
-             this solves the problem of facing a dead-end that contains some super-nodes. */
+          fprintf(stderr,"Error: Cannot write file '%s' [%s].\n",batchflow,strerror(errno));
+          failed=1;
+         }
+      }
+    else
+       failed=BatchQueries(batch,stdout,OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,query.heading,exactnodes,nthreads);
 
-          FreeResultsList(begin);
+    if(routecache)
+       SaveRouteCache(routecache);
 
-          begin=FindStartRoutes(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,start_node,NO_SEGMENT,finish_node,&nsuper);
+    return(failed);
+   }
 
-          middle=FindMiddleRoute(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,begin,end);
-         }
+ /* Calculate the distances and durations between all of the points */
 
-       FreeResultsList(end);
+ if(matrix)
+   {
+    option_quiet=1;
 
-       if(!middle)
-         {
-          if(!finish_result)
-            {
-             fprintf(stderr,"Error: Cannot find super-route compatible with profile.\n");
-             return(1);
-            }
-         }
-       else
-         {
-          results[point]=CombineRoutes(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,begin,middle);
+    return(MatrixQueries(matrix,matrix_binary,stdout,OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,query.heading,exactnodes,nthreads));
+   }
 
-          if(!results[point])
-            {
-             if(!finish_result)
-               {
-                fprintf(stderr,"Error: Cannot find route compatible with profile.\n");
-                return(1);
-               }
-            }
+ /* Loop through all pairs of points (with each profile in turn until a route is found) */
 
-          if(results[point] && finish_result)
-            {
-             /* If the direct route without passing super-nodes is shorter than
-                the route that does pass super-nodes then fall back to it */
+ for(c=0;c<nchain;c++)
+   {
+    int failed;
 
-             Result *last_result=FindResult(results[point],results[point]->finish_node,results[point]->last_segment);
+    profile=chain[c];
 
-             if(last_result->score>finish_result->score)
-               {
-                FreeResultsList(results[point]);
-                results[point]=NULL;
-               }
-            }
+    if(c>0)
+      {
+       if(!option_quiet)
+          printf("Cannot route using profile '%s': %s\n",chain[c-1]->name,query.error);
 
-          FreeResultsList(middle);
-         }
+       FreeQueryResults(&query);
       }
 
-    if(finish_result && !results[point])
-      {
-       /* Use the direct route without passing any super-nodes if there was no
-          other route. */
-
-       FixForwardRoute(begin,finish_result);
+    /* The waypoints found for the previous profile are kept if this profile can use them */
 
-       results[point]=begin;
-      }
+    if(c==0 || !ValidSnappedWaypoints(OSMSegments,OSMWays,profile,&query))
+       failed=SnapWaypoints(OSMNodes,OSMSegments,OSMWays,profile,&query,exactnodes);
     else
-       FreeResultsList(begin);
+       failed=0;
+
+    if(!failed)
+       failed=RouteSnappedWaypoints(OSMNodes,OSMSegments,OSMWays,OSMRelations,profile,&query);
+
+    if(!failed)
+       break;
+   }
 
-    join_segment=results[point]->last_segment;
+ if(routecache)
+    SaveRouteCache(routecache);
+
+ if(c==nchain)
+   {
+    if(option_stats)
+       PrintStats(option_output_stdout?stderr:stdout,&query,0);
+
+    fprintf(stderr,"Error: %s\n",query.error);
+    return(1);
    }
 
  if(!option_quiet)
    {
-    printf("Routed OK\n");
+    if(nchain>1)
+       printf("Routed OK using profile '%s'\n",profile->name);
+    else
+       printf("Routed OK\n");
     fflush(stdout);
    }
 
  /* Print out the combined route */
 
  if(!option_none)
-    PrintRoute(results,NWAYPOINTS,OSMNodes,OSMSegments,OSMWays,profile);
+   {
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC,&start);
+
+    PrintRoute(query.results,NWAYPOINTS,OSMNodes,OSMSegments,OSMWays,profile);
+
+    if(option_stats)
+       PrintStats(option_output_stdout?stderr:stdout,&query,ElapsedTime(&start));
+   }
+ else if(option_stats)
+    PrintStats(option_output_stdout?stderr:stdout,&query,0);
 
  return(0);
 }
 
 
 /*++++++++++++++++++++++++++++++++++++++
-  Print out the usage information.
+  Initialise a query so that it contains no waypoints and no results.
 
-  int detail The level of detail to use - 0 = low, 1 = high.
+  Query *query The query to initialise.
+  ++++++++++++++++++++++++++++++++++++++*/
 
-  const char *argerr The argument that gave the error (if there is one).
+void InitQuery(Query *query)
+{
+ int point;
 
-  const char *err Other error message (if there is one).
+ for(point=0;point<=NWAYPOINTS;point++)
+   {
+    query->point_used[point]=0;
+    query->point_segment[point]=NO_SEGMENT;
+    query->point_id[point]=NULL;
+    query->results[point]=NULL;
+   }
+
+ query->stats=NULL;
+
+ query->heading=-999;
+
+ query->error[0]=0;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Free the results that are stored in a query.
+
+  Query *query The query containing the results.
   ++++++++++++++++++++++++++++++++++++++*/
 
-static void print_usage(int detail,const char *argerr,const char *err)
+void FreeQueryResults(Query *query)
 {
- fprintf(stderr,
-         "Usage: router [--help | --help-profile | --help-profile-xml |\n"
-         "                        --help-profile-json | --help-profile-perl ]\n"
-         "              [--dir=<dirname>] [--prefix=<name>]\n"
-         "              [--profiles=<filename>] [--translations=<filename>]\n"
-         "              [--exact-nodes-only]\n"
-         "              [--loggable | --quiet]\n"
-         "              [--language=<lang>]\n"
-         "              [--output-html]\n"
-         "              [--output-gpx-track] [--output-gpx-route]\n"
-         "              [--output-text] [--output-text-all]\n"
-         "              [--output-none]\n"
-         "              [--profile=<name>]\n"
-         "              [--transport=<transport>]\n"
-         "              [--shortest | --quickest]\n"
-         "              --lon1=<longitude> --lat1=<latitude>\n"
-         "              --lon2=<longitude> --lon2=<latitude>\n"
-         "              [ ... --lon99=<longitude> --lon99=<latitude>]\n"
-         "              [--highway-<highway>=<preference> ...]\n"
-         "              [--speed-<highway>=<speed> ...]\n"
-         "              [--property-<property>=<preference> ...]\n"
-         "              [--oneway=(0|1)] [--turns=(0|1)]\n"
-         "              [--weight=<weight>]\n"
-         "              [--height=<height>] [--width=<width>] [--length=<length>]\n");
+ int point;
 
- if(argerr)
-    fprintf(stderr,
-            "\n"
-            "Error with command line parameter: %s\n",argerr);
+ for(point=0;point<=NWAYPOINTS;point++)
+    if(query->results[point])
+      {
+       FreeResultsList(query->results[point]);
+       query->results[point]=NULL;
+      }
 
- if(err)
-    fprintf(stderr,
-            "\n"
-            "Error: %s\n",err);
+ if(query->stats)
+   {
+    free(query->stats);
+    query->stats=NULL;
+   }
+}
 
- if(detail)
-    fprintf(stderr,
-            "\n"
-            "--help                  Prints this information.\n"
-            "--help-profile          Prints the information about the selected profile.\n"
-            "--help-profile-xml      Prints all loaded profiles in XML format.\n"
-            "--help-profile-json     Prints all loaded profiles in JSON format.\n"
-            "--help-profile-perl     Prints all loaded profiles in Perl format.\n"
-            "\n"
-            "--dir=<dirname>         The directory containing the routing database.\n"
-            "--prefix=<name>         The filename prefix for the routing database.\n"
-            "--profiles=<filename>   The name of the XML file containing the profiles\n"
-            "                        (defaults to 'profiles.xml' with '--dir' and\n"
+
+/*++++++++++++++++++++++++++++++++++++++
+  Parse one of the routing options (waypoints, route type and profile modifications).
+
+  int ParseRoutingOption Returns 0 if the option was understood or 1 in case of an error.
+
+  const char *arg The option to parse.
+
+  Query *query The query to store the waypoints and heading in.
+
+  Profile *profile The profile to modify.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int ParseRoutingOption(const char *arg,Query *query,Profile *profile)
+{
+ int point;
+
+ if(!strcmp(arg,"--shortest"))
+    option_quickest=0;
+ else if(!strcmp(arg,"--quickest"))
+    option_quickest=1;
+ else if(isdigit(arg[0]) ||
+    ((arg[0]=='-' || arg[0]=='+') && isdigit(arg[1])))
+   {
+    for(point=1;point<=NWAYPOINTS;point++)
+       if(query->point_used[point]!=3)
+         {
+          if(query->point_used[point]==0)
+            {
+             query->point_lon[point]=degrees_to_radians(atof(arg));
+             query->point_used[point]=1;
+            }
+          else /* if(query->point_used[point]==1) */
+            {
+             query->point_lat[point]=degrees_to_radians(atof(arg));
+             query->point_used[point]=3;
+            }
+          break;
+         }
+   }
+ else if(!strncmp(arg,"--lon",5) && isdigit(arg[5]))
+   {
+    const char *p=&arg[6];
+    while(isdigit(*p)) p++;
+    if(*p++!='=')
+       return(1);
+
+    point=atoi(&arg[5]);
+    if(point>NWAYPOINTS || query->point_used[point]&1)
+       return(1);
+
+    query->point_lon[point]=degrees_to_radians(atof(p));
+    query->point_used[point]+=1;
+   }
+ else if(!strncmp(arg,"--lat",5) && isdigit(arg[5]))
+   {
+    const char *p=&arg[6];
+    while(isdigit(*p)) p++;
+    if(*p++!='=')
+       return(1);
+
+    point=atoi(&arg[5]);
+    if(point>NWAYPOINTS || query->point_used[point]&2)
+       return(1);
+
+    query->point_lat[point]=degrees_to_radians(atof(p));
+    query->point_used[point]+=2;
+   }
+ else if(!strncmp(arg,"--point",7) && isdigit(arg[7]))
+   {
+    const char *p=&arg[8];
+    while(isdigit(*p)) p++;
+    if(*p++!='=' || !*p)
+       return(1);
+
+    point=atoi(&arg[7]);
+    if(point>NWAYPOINTS || query->point_used[point])
+       return(1);
+
+    query->point_id[point]=p;
+    query->point_used[point]=3;
+   }
+ else if(!strncmp(arg,"--heading=",10))
+   {
+    double h=atof(&arg[10]);
+
+    if(h>=-360 && h<=360)
+      {
+       query->heading=h;
+
+       if(query->heading<0) query->heading+=360;
+      }
+   }
+ else if(!strncmp(arg,"--highway-",10))
+   {
+    Highway highway;
+    char *equal=strchr(arg,'=');
+    char *string;
+
+    if(!equal)
+       return(1);
+
+    string=strcpy((char*)malloc(strlen(arg)),arg+10);
+    string[equal-arg-10]=0;
+
+    highway=HighwayType(string);
+
+    free(string);
+
+    if(highway==Way_Count)
+       return(1);
+
+    profile->highway[highway]=atof(equal+1);
+   }
+ else if(!strncmp(arg,"--speed-",8))
+   {
+    Highway highway;
+    char *equal=strchr(arg,'=');
+    char *string;
+
+    if(!equal)
+       return(1);
+
+    string=strcpy((char*)malloc(strlen(arg)),arg+8);
+    string[equal-arg-8]=0;
+
+    highway=HighwayType(string);
+
+    free(string);
+
+    if(highway==Way_Count)
+       return(1);
+
+    profile->speed[highway]=kph_to_speed(atof(equal+1));
+   }
+ else if(!strncmp(arg,"--property-",11))
+   {
+    Property property;
+    char *equal=strchr(arg,'=');
+    char *string;
+
+    if(!equal)
+       return(1);
+
+    string=strcpy((char*)malloc(strlen(arg)),arg+11);
+    string[equal-arg-11]=0;
+
+    property=PropertyType(string);
+
+    free(string);
+
+    if(property==Property_Count)
+       return(1);
+
+    profile->props_yes[property]=atof(equal+1);
+   }
+ else if(!strncmp(arg,"--oneway=",9))
+    profile->oneway=!!atoi(&arg[9]);
+ else if(!strncmp(arg,"--turns=",8))
+    profile->turns=!!atoi(&arg[8]);
+ else if(!strncmp(arg,"--weight=",9))
+    profile->weight=tonnes_to_weight(atof(&arg[9]));
+ else if(!strncmp(arg,"--height=",9))
+    profile->height=metres_to_height(atof(&arg[9]));
+ else if(!strncmp(arg,"--width=",8))
+    profile->width=metres_to_width(atof(&arg[8]));
+ else if(!strncmp(arg,"--length=",9))
+    profile->length=metres_to_length(atof(&arg[9]));
+ else
+    return(1);
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the node (or create a fake node in a segment) closest to a waypoint.
+
+  index_t SnapWaypoint Returns the node or NO_NODE if there is nothing close enough.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  int point Which of the waypoints this is.
+
+  double latitude The latitude of the waypoint.
+
+  double longitude The longitude of the waypoint.
+
+  int exactnodes Only route between nodes (don't find closest segment).
+
+  index_t *snapped Returns the segment that the waypoint was found on or NO_SEGMENT (if not NULL).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+index_t SnapWaypoint(Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int point,double latitude,double longitude,int exactnodes,index_t *snapped)
+{
+ distance_t distmax=km_to_distance(MAXSEARCH);
+ distance_t distmin;
+ index_t segment=NO_SEGMENT;
+ index_t node1,node2;
+ index_t node;
+
+ if(exactnodes)
+   {
+    node=FindClosestNode(nodes,segments,ways,latitude,longitude,distmax,profile,&distmin);
+   }
+ else
+   {
+    distance_t dist1,dist2;
+
+    segment=FindClosestSegment(nodes,segments,ways,latitude,longitude,distmax,profile,&distmin,&node1,&node2,&dist1,&dist2);
+
+    if(segment!=NO_SEGMENT)
+       node=CreateFakes(nodes,segments,point,LookupSegment(segments,segment,1),node1,node2,dist1,dist2);
+    else
+       node=NO_NODE;
+   }
+
+ if(snapped)
+    *snapped=(node==NO_NODE)?NO_SEGMENT:segment;
+
+ if(node!=NO_NODE && !option_quiet)
+   {
+    double lat,lon;
+
+    if(IsFakeNode(node))
+       GetFakeLatLong(node,&lat,&lon);
+    else
+       GetLatLong(nodes,node,&lat,&lon);
+
+    if(IsFakeNode(node))
+       printf("Point %d is segment %"Pindex_t" (node %"Pindex_t" -> %"Pindex_t"): %3.6f %4.6f = %2.3f km\n",point,segment,node1,node2,
+              radians_to_degrees(lon),radians_to_degrees(lat),distance_to_km(distmin));
+    else
+       printf("Point %d is node %"Pindex_t": %3.6f %4.6f = %2.3f km\n",point,node,
+              radians_to_degrees(lon),radians_to_degrees(lat),distance_to_km(distmin));
+   }
+
+ return(node);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Use the node (or create a fake node in a segment) that was found for a point in advance.
+
+  index_t SnappedWaypoint Returns the node or NO_NODE if nothing was close enough.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  int point Which of the waypoints this is.
+
+  SnappedPoint *snappedpoint The point from the snapped points file.
+
+  index_t *snapped Returns the segment that the waypoint was found on or NO_SEGMENT.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+index_t SnappedWaypoint(Nodes *nodes,Segments *segments,int point,SnappedPoint *snappedpoint,index_t *snapped)
+{
+ index_t node;
+
+ if(snappedpoint->segment!=NO_SEGMENT)
+    node=CreateFakes(nodes,segments,point,LookupSegment(segments,snappedpoint->segment,1),
+                     snappedpoint->node1,snappedpoint->node2,snappedpoint->dist1,snappedpoint->dist2);
+ else
+    node=snappedpoint->node1;
+
+ *snapped=(node==NO_NODE)?NO_SEGMENT:snappedpoint->segment;
+
+ if(node!=NO_NODE && !option_quiet)
+   {
+    double lat,lon;
+
+    if(IsFakeNode(node))
+       GetFakeLatLong(node,&lat,&lon);
+    else
+       GetLatLong(nodes,node,&lat,&lon);
+
+    if(IsFakeNode(node))
+       printf("Point %d is segment %"Pindex_t" (node %"Pindex_t" -> %"Pindex_t"): %3.6f %4.6f = %2.3f km\n",point,snappedpoint->segment,
+              snappedpoint->node1,snappedpoint->node2,radians_to_degrees(lon),radians_to_degrees(lat),distance_to_km(snappedpoint->dist));
+    else
+       printf("Point %d is node %"Pindex_t": %3.6f %4.6f = %2.3f km\n",point,node,
+              radians_to_degrees(lon),radians_to_degrees(lat),distance_to_km(snappedpoint->dist));
+   }
+
+ return(node);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the nodes (or create fake nodes) closest to all of the waypoints of a query.
+
+  int SnapWaypoints Returns 0 if all waypoints were found or 1 in case of an error (with the message in the query).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  Query *query The query containing the waypoints and that will store the nodes.
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int SnapWaypoints(Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,Query *query,int exactnodes)
+{
+ int point;
+
+ ResetFakes();
+
+ for(point=1;point<=NWAYPOINTS;point++)
+    query->point_segment[point]=NO_SEGMENT;
+
+ for(point=1;point<=NWAYPOINTS;point++)
+   {
+    if(query->point_used[point]!=3)
+       continue;
+
+    if(query->point_id[point])
+      {
+       SnappedPoint *snappedpoint=FindSnappedPoint(query->point_id[point]);
+
+       if(!snappedpoint)
+         {
+          sprintf(query->error,"Cannot find snapped point '%.64s' for point %d.",query->point_id[point],point);
+          return(1);
+         }
+
+       if(snappedfile.checksum!=ProfileChecksum(profile))
+         {
+          strcpy(query->error,"The snapped points were not created for the same profile.");
+          return(1);
+         }
+
+       query->point_node[point]=SnappedWaypoint(nodes,segments,point,snappedpoint,&query->point_segment[point]);
+      }
+    else
+       query->point_node[point]=SnapWaypoint(nodes,segments,ways,profile,point,query->point_lat[point],query->point_lon[point],exactnodes,
+                                             &query->point_segment[point]);
+
+    if(query->point_node[point]==NO_NODE)
+      {
+       sprintf(query->error,"Cannot find node close to specified point %d.",point);
+       return(1);
+      }
+   }
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Check if the nodes that were found for the waypoints of a query can be used with
+  another profile (all of the segments they were found on must be allowed).
+
+  int ValidSnappedWaypoints Returns 1 if they can be used or 0 if they must be found again.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile to check.
+
+  Query *query The query containing the waypoints and nodes.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int ValidSnappedWaypoints(Segments *segments,Ways *ways,Profile *profile,Query *query)
+{
+ int point;
+
+ for(point=1;point<=NWAYPOINTS;point++)
+   {
+    if(query->point_used[point]!=3)
+       continue;
+
+    if(query->point_segment[point]==NO_SEGMENT)
+       return(0);
+
+    if(!ValidSegmentForProfile(ways,LookupSegment(segments,query->point_segment[point],1),profile))
+       return(0);
+   }
+
+ return(1);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the route that passes through all of the waypoints of a query.
+
+  int RouteWaypoints Returns 0 if a route was found or 1 in case of an error (with the message in the query).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  Query *query The query containing the waypoints and that will store the results.
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int RouteWaypoints(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Query *query,int exactnodes)
+{
+ if(SnapWaypoints(nodes,segments,ways,profile,query,exactnodes))
+    return(1);
+
+ return(RouteSnappedWaypoints(nodes,segments,ways,relations,profile,query));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the route that passes through all of the waypoints of a query using the nodes that
+  have already been found for them.
+
+  int RouteSnappedWaypoints Returns 0 if a route was found or 1 in case of an error (with the message in the query).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  Query *query The query containing the waypoint nodes and that will store the results.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int RouteSnappedWaypoints(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Query *query)
+{
+ index_t start_node=NO_NODE,finish_node=NO_NODE;
+ index_t join_segment=NO_SEGMENT;
+ int     point,start_point,finish_point=0;
+ uint32_t checksum=routecache?ProfileChecksum(profile):0;
+
+ if(option_stats && !query->stats)
+    query->stats=(LegStats*)calloc(NWAYPOINTS+1,sizeof(LegStats));
+
+ for(point=1;point<=NWAYPOINTS;point++)
+   {
+    LegStats *stats=NULL;
+    const char *error=NULL;
+    RouteCacheKey key;
+    int cacheable=0;
+
+    if(query->point_used[point]!=3)
+       continue;
+
+    start_point=finish_point;
+    finish_point=point;
+
+    start_node=finish_node;
+
+    finish_node=query->point_node[point];
+
+    if(start_node==NO_NODE)
+       continue;
+
+    if(start_node==finish_node)
+       continue;
+
+    /* Give up immediately if there cannot be a route between the points */
+
+    if(!WaypointsConnected(nodes,profile,start_node,finish_node))
+      {
+       strcpy(query->error,"Cannot find route compatible with profile (the points are not connected).");
+       return(1);
+      }
+
+    if(query->heading!=-999 && join_segment==NO_SEGMENT)
+       join_segment=FindClosestSegmentHeading(nodes,segments,ways,start_node,query->heading,profile);
+
+    /* Calculate the route between the points */
+
+    if(query->stats)
+      {
+       stats=&query->stats[point];
+
+       stats->from=start_point;
+
+       ResetRoutingCounters();
+      }
+
+    /* Use the route from the cache if it was calculated before */
+
+    if(routecache)
+       cacheable=!MakeRouteCacheKey(&key,checksum,option_quickest,start_node,finish_node,start_point,join_segment);
+
+    query->results[point]=NULL;
+
+    if(cacheable)
+       query->results[point]=FindCachedRoute(routecache,&key,start_point,finish_point);
+
+    if(!query->results[point])
+      {
+       query->results[point]=CalculateRoute(nodes,segments,ways,relations,profile,start_node,join_segment,finish_node,stats,&error);
+
+       if(cacheable && query->results[point])
+          AddCachedRoute(routecache,&key,query->results[point],start_point,finish_point);
+      }
+
+    if(stats)
+      {
+       /* Only the memory needed by the results lists for this section of the route is counted */
+
+       stats->counters=routing_counters;
+
+       stats->counters.peak_memory-=stats->counters.base_memory;
+      }
+
+    if(!query->results[point])
+      {
+       strcpy(query->error,error);
+       return(1);
+      }
+
+    join_segment=query->results[point]->last_segment;
+   }
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Check if two waypoints might be connected by a route using the connected components of
+  the nodes (a fake node is in the same component as the real nodes of its segment).
+
+  int WaypointsConnected Returns 1 if there might be a route or 0 if there cannot be one.
+
+  Nodes *nodes The set of nodes to use.
+
+  Profile *profile The profile containing the transport type.
+
+  index_t node1 The first node (or fake node).
+
+  index_t node2 The second node (or fake node).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int WaypointsConnected(Nodes *nodes,Profile *profile,index_t node1,index_t node2)
+{
+ if(IsFakeNode(node1))
+    node1=OtherNode(FirstFakeSegment(node1),node1);
+
+ if(IsFakeNode(node2))
+    node2=OtherNode(FirstFakeSegment(node2),node2);
+
+ return(NodesConnected(nodes,profile->transport,node1,node2));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the contraction hierarchy that was created for a profile (it must have been created for
+  exactly the same profile and for the selected shortest or quickest route).
+
+  Contraction *ChooseContraction Returns the contraction hierarchy or NULL if there is none.
+
+  Profile *profile The profile (after it has been updated by UpdateProfile()).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Contraction *ChooseContraction(Profile *profile)
+{
+ uint32_t checksum;
+ int i;
+
+ if(!ncontractions)
+    return(NULL);
+
+ checksum=ProfileChecksum(profile);
+
+ for(i=0;i<ncontractions;i++)
+    if(contractions[i]->file.checksum==checksum && contractions[i]->file.quickest==option_quickest)
+       return(contractions[i]);
+
+ return(NULL);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the optimum route between two nodes, using the super-nodes if they help.
+
+  Results *CalculateRoute Returns a set of results or NULL in case of an error.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  index_t start_node The start node.
+
+  index_t prev_segment The previous segment before the start node.
+
+  index_t finish_node The finish node.
+
+  LegStats *stats Returns the time taken by each part of the calculation (if not NULL).
+
+  const char **error Returns the error message in case of an error.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Results *CalculateRoute(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,
+                               index_t start_node,index_t prev_segment,index_t finish_node,LegStats *stats,const char **error)
+{
+ Results *complete=NULL;
+ Results *begin,*end;
+ Result *finish_result;
+ Contraction *contraction;
+ int     nsuper=0;
+ struct timespec start;
+
+ /* Use the contraction hierarchy for the profile if there is one and the route it finds is valid */
+
+ contraction=ChooseContraction(profile);
+
+ if(contraction)
+   {
+    StartTimer(stats,&start);
+
+    complete=FindContractedRoute(nodes,segments,ways,relations,profile,contraction,start_node,prev_segment,finish_node);
+
+    StopTimer(stats,Phase_Contraction,&start);
+
+    if(complete)
+       return(complete);
+   }
+
+ /* Calculate the beginning of the route */
+
+ StartTimer(stats,&start);
+
+ begin=FindStartRoutes(nodes,segments,ways,relations,profile,start_node,prev_segment,finish_node,&nsuper);
+
+ if(!begin && prev_segment!=NO_SEGMENT)
+   {
+    /* Try again but allow a U-turn at the start waypoint -
+       this solves the problem of facing a dead-end that contains no super-nodes. */
+
+    prev_segment=NO_SEGMENT;
+
+    begin=FindStartRoutes(nodes,segments,ways,relations,profile,start_node,prev_segment,finish_node,&nsuper);
+   }
+
+ StopTimer(stats,Phase_Start,&start);
+
+ if(!begin)
+   {
+    *error="Cannot find initial section of route compatible with profile.";
+    return(NULL);
+   }
+
+ finish_result=FindResult1(begin,finish_node);
+
+ if(nsuper || !finish_result)
+   {
+    /* The route may include super-nodes but there may also be a route
+       without passing any super-nodes to fall back on */
+
+    Results *middle;
+
+    /* Calculate the end of the route */
+
+    StartTimer(stats,&start);
+
+    end=FindFinishRoutes(nodes,segments,ways,relations,profile,finish_node);
+
+    StopTimer(stats,Phase_Finish,&start);
+
+    if(!end)
+      {
+       FreeResultsList(begin);
+
+       *error="Cannot find final section of route compatible with profile.";
+       return(NULL);
+      }
+
+    /* Calculate the middle of the route */
+
+    StartTimer(stats,&start);
+
+    middle=FindMiddleRoute(nodes,segments,ways,relations,profile,begin,end);
+
+    StopTimer(stats,Phase_Middle,&start);
+
+    if(!middle && prev_segment!=NO_SEGMENT && !finish_result)
+      {
+       /* Try again but allow a U-turn at the start waypoint -
+          this solves the problem of facing a dead-end that contains some super-nodes. */
+
+       FreeResultsList(begin);
+
+       StartTimer(stats,&start);
+
+       begin=FindStartRoutes(nodes,segments,ways,relations,profile,start_node,NO_SEGMENT,finish_node,&nsuper);
+
+       StopTimer(stats,Phase_Start,&start);
+
+       StartTimer(stats,&start);
+
+       middle=FindMiddleRoute(nodes,segments,ways,relations,profile,begin,end);
+
+       StopTimer(stats,Phase_Middle,&start);
+      }
+
+    FreeResultsList(end);
+
+    if(!middle)
+      {
+       if(!finish_result)
+         {
+          FreeResultsList(begin);
+
+          *error="Cannot find super-route compatible with profile.";
+          return(NULL);
+         }
+      }
+    else
+      {
+       StartTimer(stats,&start);
+
+       complete=CombineRoutes(nodes,segments,ways,relations,profile,begin,middle);
+
+       StopTimer(stats,Phase_Combine,&start);
+
+       if(!complete)
+         {
+          if(!finish_result)
+            {
+             FreeResultsList(middle);
+             FreeResultsList(begin);
+
+             *error="Cannot find route compatible with profile.";
+             return(NULL);
+            }
+         }
+
+       if(complete && finish_result)
+         {
+          /* If the direct route without passing super-nodes is shorter than
+             the route that does pass super-nodes then fall back to it */
+
+          Result *last_result=FindResult(complete,complete->finish_node,complete->last_segment);
+
+          if(last_result->score>finish_result->score)
+            {
+             FreeResultsList(complete);
+             complete=NULL;
+            }
+         }
+
+       FreeResultsList(middle);
+      }
+   }
+
+ if(finish_result && !complete)
+   {
+    /* Use the direct route without passing any super-nodes if there was no
+       other route. */
+
+    FixForwardRoute(begin,finish_result);
+
+    complete=begin;
+   }
+ else
+    FreeResultsList(begin);
+
+ return(complete);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Start timing one part of the calculation of a route.
+
+  LegStats *stats The statistics for the section of the route (or NULL if not timing it).
+
+  struct timespec *start Returns the start time.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void StartTimer(LegStats *stats,struct timespec *start)
+{
+ if(stats)
+    clock_gettime(CLOCK_MONOTONIC,start);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Finish timing one part of the calculation of a route and add the time to the statistics.
+
+  LegStats *stats The statistics for the section of the route (or NULL if not timing it).
+
+  Phase phase The part of the calculation that has finished.
+
+  struct timespec *start The start time.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void StopTimer(LegStats *stats,Phase phase,struct timespec *start)
+{
+ if(stats)
+    stats->time[phase]+=ElapsedTime(start);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate the time that has elapsed since the start time.
+
+  double ElapsedTime Returns the elapsed time (ms).
+
+  struct timespec *start The start time.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+double ElapsedTime(struct timespec *start)
+{
+ struct timespec finish;
+
+ clock_gettime(CLOCK_MONOTONIC,&finish);
+
+ return((finish.tv_sec-start->tv_sec)*1000.0+(finish.tv_nsec-start->tv_nsec)/1000000.0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print the time taken and the work done for each section of the route as one line of text
+  per section or as a single line of JSON.
+
+  FILE *output The file to write the statistics to.
+
+  Query *query The query containing the statistics.
+
+  double printtime The time taken to print the route (ms).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void PrintStats(FILE *output,Query *query,double printtime)
+{
+ int point,phase,first=1;
+
+ if(option_stats==2)
+    fprintf(output,"{\"legs\":[");
+
+ for(point=1;point<=NWAYPOINTS;point++)
+   {
+    LegStats *stats;
+
+    if(!query->stats || !query->stats[point].from)
+       continue;
+
+    stats=&query->stats[point];
+
+    if(option_stats==2)
+      {
+       fprintf(output,"%s{\"from\":%d,\"to\":%d,\"time_ms\":{",first?"":",",stats->from,point);
+
+       for(phase=0;phase<Phase_Count;phase++)
+          fprintf(output,"%s\"%s\":%.3f",phase?",":"",phasenames[phase],stats->time[phase]);
+
+       fprintf(output,"},\"queue_pushes\":%llu,\"queue_pops\":%llu,\"results_inserted\":%llu,\"results_resized\":%llu,\"results_peak_bytes\":%llu}",
+               (unsigned long long)stats->counters.pushed,(unsigned long long)stats->counters.popped,
+               (unsigned long long)stats->counters.inserted,(unsigned long long)stats->counters.resized,(unsigned long long)stats->counters.peak_memory);
+      }
+    else
+      {
+       fprintf(output,"Stats: waypoints %d-%d:",stats->from,point);
+
+       for(phase=0;phase<Phase_Count;phase++)
+          fprintf(output," %s=%.3fms",phasenames[phase],stats->time[phase]);
+
+       fprintf(output," queue-pushes=%llu queue-pops=%llu results-inserted=%llu results-resized=%llu results-peak=%llukB\n",
+               (unsigned long long)stats->counters.pushed,(unsigned long long)stats->counters.popped,
+               (unsigned long long)stats->counters.inserted,(unsigned long long)stats->counters.resized,(unsigned long long)(stats->counters.peak_memory+1023)/1024);
+      }
+
+    first=0;
+   }
+
+ if(option_stats==2)
+    fprintf(output,"],\"PrintRoute_ms\":%.3f}\n",printtime);
+ else
+    fprintf(output,"Stats: PrintRoute=%.3fms\n",printtime);
+
+ fflush(output);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the closest node or point in a segment to each of the points in a file and write
+  them out in binary so that the router can use them later without searching again.
+
+  Each row of the file contains an identifier followed by the latitude and longitude of a
+  point (separated by spaces, tabs or commas). Empty rows and those starting with '#' are
+  ignored. The output contains a header (the number of points, the checksum of the profile
+  and the number of nodes and segments in the database), the segment, nodes and distances
+  for each point (sorted by identifier) and then the identifiers.
+
+  int SnapPoints Returns 0 if the file was processed or 1 in case of an error.
+
+  const char *filename The name of the file of points ("-" for stdin).
+
+  FILE *output The file to write the snapped points to.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Profile *profile The profile containing the transport type, speeds and allowed highways.
+
+  int exactnodes Only use nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int SnapPoints(const char *filename,FILE *output,Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int exactnodes)
+{
+ FILE         *input;
+ char         *line=NULL;
+ size_t        length=0;
+ SnapRow      *rows=NULL;
+ SnappedPoint *points;
+ SnappedPointsFile snappedpointsfile;
+ uint32_t      npoints=0,idsize=0,i;
+
+ if(!strcmp(filename,"-"))
+    input=stdin;
+ else if(!(input=fopen(filename,"r")))
+   {
+    fprintf(stderr,"Error: Cannot open points file '%s' for reading [%s].\n",filename,strerror(errno));
+    return(1);
+   }
+
+ /* Read in the points */
+
+ while(getline(&line,&length,input)!=-1)
+   {
+    char *id,*lat,*lon;
+
+    id=strtok(line," \t,\r\n");
+
+    if(!id || *id=='#')
+       continue;
+
+    lat=strtok(NULL," \t,\r\n");
+    lon=strtok(NULL," \t,\r\n");
+
+    if(!lat || !lon || strtok(NULL," \t,\r\n"))
+      {
+       fprintf(stderr,"Error: Point rows must contain an identifier and 2 coordinates (row '%s').\n",id);
+       return(1);
+      }
+
+    if((npoints%64)==0)
+       rows=(SnapRow*)realloc((void*)rows,(npoints+64)*sizeof(SnapRow));
+
+    rows[npoints].id=strcpy((char*)malloc(strlen(id)+1),id);
+    rows[npoints].lat=degrees_to_radians(atof(lat));
+    rows[npoints].lon=degrees_to_radians(atof(lon));
+
+    idsize+=strlen(id)+1;
+
+    npoints++;
+   }
+
+ if(line)
+    free(line);
+
+ if(input!=stdin)
+    fclose(input);
+
+ /* Sort the points so that they can be found by identifier */
+
+ if(npoints)
+    qsort(rows,npoints,sizeof(SnapRow),(int (*)(const void*,const void*))sort_by_id);
+
+ for(i=1;i<npoints;i++)
+    if(!strcmp(rows[i-1].id,rows[i].id))
+      {
+       fprintf(stderr,"Error: The point identifier '%s' is used more than once.\n",rows[i].id);
+       return(1);
+      }
+
+ /* Find the segment or node for each point */
+
+ points=(SnappedPoint*)malloc((npoints?npoints:1)*sizeof(SnappedPoint));
+
+ idsize=0;
+
+ for(i=0;i<npoints;i++)
+   {
+    distance_t distmax=km_to_distance(MAXSEARCH);
+
+    points[i].idoffset=idsize;
+
+    idsize+=strlen(rows[i].id)+1;
+
+    if(exactnodes)
+      {
+       points[i].segment=NO_SEGMENT;
+       points[i].node1=FindClosestNode(nodes,segments,ways,rows[i].lat,rows[i].lon,distmax,profile,&points[i].dist);
+       points[i].node2=NO_NODE;
+       points[i].dist1=0;
+       points[i].dist2=0;
+      }
+    else
+      {
+       points[i].segment=FindClosestSegment(nodes,segments,ways,rows[i].lat,rows[i].lon,distmax,profile,&points[i].dist,
+                                            &points[i].node1,&points[i].node2,&points[i].dist1,&points[i].dist2);
+
+       if(points[i].segment==NO_SEGMENT)
+          points[i].node1=NO_NODE;
+      }
+
+    if(points[i].node1==NO_NODE)
+       fprintf(stderr,"Warning: Cannot find node close to point '%s'.\n",rows[i].id);
+   }
+
+ /* Write out the header, the points and the identifiers */
+
+ snappedpointsfile.number=npoints;
+ snappedpointsfile.checksum=ProfileChecksum(profile);
+ snappedpointsfile.nodes=nodes->file.number;
+ snappedpointsfile.segments=segments->file.number;
+ snappedpointsfile.idsize=idsize;
+
+ fwrite(&snappedpointsfile,sizeof(SnappedPointsFile),1,output);
+
+ fwrite(points,sizeof(SnappedPoint),npoints,output);
+
+ for(i=0;i<npoints;i++)
+   {
+    fwrite(rows[i].id,1,strlen(rows[i].id)+1,output);
+
+    free(rows[i].id);
+   }
+
+ fflush(output);
+
+ free(points);
+
+ if(rows)
+    free(rows);
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in the points that were snapped in advance by the '--snap-points' option.
+
+  int LoadSnappedPoints Returns 0 if the points were loaded or 1 in case of an error.
+
+  const char *filename The name of the snapped points file.
+
+  Nodes *nodes The set of nodes (that the points must match).
+
+  Segments *segments The set of segments (that the points must match).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int LoadSnappedPoints(const char *filename,Nodes *nodes,Segments *segments)
+{
+ FILE *input;
+
+ if(!(input=fopen(filename,"r")))
+   {
+    fprintf(stderr,"Error: Cannot open snapped points file '%s' for reading [%s].\n",filename,strerror(errno));
+    return(1);
+   }
+
+ if(fread(&snappedfile,sizeof(SnappedPointsFile),1,input)!=1)
+   {
+    fprintf(stderr,"Error: Cannot read the snapped points file '%s'.\n",filename);
+    fclose(input);
+    return(1);
+   }
+
+ if(snappedfile.nodes!=nodes->file.number || snappedfile.segments!=segments->file.number)
+   {
+    fprintf(stderr,"Error: The snapped points file '%s' does not match the nodes and segments files.\n",filename);
+    fclose(input);
+    return(1);
+   }
+
+ snappedpoints=(SnappedPoint*)malloc((snappedfile.number?snappedfile.number:1)*sizeof(SnappedPoint));
+ snappedids=(char*)malloc(snappedfile.idsize+1);
+
+ if(fread(snappedpoints,sizeof(SnappedPoint),snappedfile.number,input)!=snappedfile.number ||
+    fread(snappedids,1,snappedfile.idsize,input)!=snappedfile.idsize)
+   {
+    fprintf(stderr,"Error: Cannot read the snapped points file '%s'.\n",filename);
+    fclose(input);
+    return(1);
+   }
+
+ snappedids[snappedfile.idsize]=0;
+
+ fclose(input);
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find one of the snapped points that have been loaded using its identifier.
+
+  SnappedPoint *FindSnappedPoint Returns the snapped point or NULL if there is none.
+
+  const char *id The identifier of the point.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+SnappedPoint *FindSnappedPoint(const char *id)
+{
+ if(!snappedpoints)
+    return(NULL);
+
+ return((SnappedPoint*)bsearch(id,snappedpoints,snappedfile.number,sizeof(SnappedPoint),(int (*)(const void*,const void*))compare_snapped_id));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Sort the points to be snapped into identifier order.
+
+  int sort_by_id Returns the comparison of the id fields.
+
+  SnapRow *a The first point.
+
+  SnapRow *b The second point.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int sort_by_id(SnapRow *a,SnapRow *b)
+{
+ return(strcmp(a->id,b->id));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Compare an identifier with the identifier of a snapped point.
+
+  int compare_snapped_id Returns the comparison of the identifiers.
+
+  const char *id The identifier to find.
+
+  SnappedPoint *snappedpoint The snapped point to compare it with.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int compare_snapped_id(const char *id,SnappedPoint *snappedpoint)
+{
+ return(strcmp(id,snappedids+snappedpoint->idoffset));
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Print out the usage information.
+
+  int detail The level of detail to use - 0 = low, 1 = high.
+
+  const char *argerr The argument that gave the error (if there is one).
+
+  const char *err Other error message (if there is one).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void print_usage(int detail,const char *argerr,const char *err)
+{
+ fprintf(stderr,
+         "Usage: router [--help | --help-profile | --help-profile-xml |\n"
+         "                        --help-profile-json | --help-profile-perl ]\n"
+         "              [--dir=<dirname>] [--prefix=<name>]\n"
+         "              [--profiles=<filename>] [--translations=<filename>]\n"
+         "              [--exact-nodes-only] [--bidirectional] [--contraction]\n"
+         "              [--astar]\n"
+         "              [--serve[=<socket>] | --batch=<filename> [--batch-pgcopy |\n"
+         "                                                         --batch-store=<filename> |\n"
+         "                                                         --batch-flow=<filename>] |\n"
+         "               --matrix=<filename> [--matrix-binary] |\n"
+         "               --snap-points=<filename>]\n"
+         "              [--snapped-points=<filename>]\n"
+         "              [--route-cache=<filename>]\n"
+         "              [--threads=<n>]\n"
+         "              [--loggable | --quiet]\n"
+         "              [--stats[=json]]\n"
+         "              [--language=<lang>]\n"
+         "              [--output-html]\n"
+         "              [--output-gpx-track] [--output-gpx-route]\n"
+         "              [--output-text] [--output-text-all]\n"
+         "              [--output-binary] [--output-polyline] [--output-geojson]\n"
+         "              [--output-none]\n"
+         "              [--output-dir=<dirname>] [--output-prefix=<name>]\n"
+         "              [--output-stdout]\n"
+         "              [--profile=<name>]\n"
+         "              [--transport=<transport>]\n"
+         "              [--shortest | --quickest]\n"
+         "              --lon1=<longitude> --lat1=<latitude>\n"
+         "              --lon2=<longitude> --lon2=<latitude>\n"
+         "              [ ... --lon99=<longitude> --lon99=<latitude>]\n"
+         "              [--point<n>=<id> ...]\n"
+         "              [--highway-<highway>=<preference> ...]\n"
+         "              [--speed-<highway>=<speed> ...]\n"
+         "              [--property-<property>=<preference> ...]\n"
+         "              [--oneway=(0|1)] [--turns=(0|1)]\n"
+         "              [--weight=<weight>]\n"
+         "              [--height=<height>] [--width=<width>] [--length=<length>]\n");
+
+ if(argerr)
+    fprintf(stderr,
+            "\n"
+            "Error with command line parameter: %s\n",argerr);
+
+ if(err)
+    fprintf(stderr,
+            "\n"
+            "Error: %s\n",err);
+
+ if(detail)
+    fprintf(stderr,
+            "\n"
+            "--help                  Prints this information.\n"
+            "--help-profile          Prints the information about the selected profile.\n"
+            "--help-profile-xml      Prints all loaded profiles in XML format.\n"
+            "--help-profile-json     Prints all loaded profiles in JSON format.\n"
+            "--help-profile-perl     Prints all loaded profiles in Perl format.\n"
+            "\n"
+            "--dir=<dirname>         The directory containing the routing database.\n"
+            "--prefix=<name>         The filename prefix for the routing database.\n"
+            "--profiles=<filename>   The name of the XML file containing the profiles\n"
+            "                        (defaults to 'profiles.xml' with '--dir' and\n"
             "                         '--prefix' options or the file installed in\n"
             "                         '" DATADIR "').\n"
             "--translations=<fname>  The name of the XML file containing the translations\n"
@@ -692,9 +2090,43 @@ static void print_usage(int detail,const char *argerr,const char *err)
             "                         '" DATADIR "').\n"
             "\n"
             "--exact-nodes-only      Only route between nodes (don't find closest segment).\n"
+            "--bidirectional         Search forwards from the start and backwards from the\n"
+            "                        finish at the same time (gives the same routes).\n"
+            "--contraction           Use the contraction hierarchies created by the\n"
+            "                        planetsplitter '--contract' option (if they match the\n"
+            "                        profile and the route obeys the turn restrictions).\n"
+            "--astar                 Direct the search towards the finish using the\n"
+            "                        straight line distance and the planetsplitter\n"
+            "                        '--landmarks' (if any) to examine fewer nodes.\n"
+            "\n"
+            "--serve                 Keep the database loaded and answer routing queries\n"
+            "                        (one per line of routing options) from stdin.\n"
+            "--serve=<socket>        Answer routing queries from a Unix domain socket.\n"
+            "--batch=<filename>      Route each row of the file ('<id> <lat1> <lon1> <lat2>\n"
+            "                        <lon2> [<lat> <lon>]') and print the route points.\n"
+            "--batch-pgcopy          Print the batch routes as PostgreSQL COPY rows (each\n"
+            "                        batch row starts with a start and an end identifier).\n"
+            "--batch-store=<fname>   Save the batch routes in a file sorted by identifier\n"
+            "                        (read by 'routedumper').\n"
+            "--batch-flow=<fname>    Add the weight at the end of each batch row to the\n"
+            "                        segments of its route and save the segment totals.\n"
+            "--matrix=<filename>     Print the distance and duration between every pair of\n"
+            "                        points in the file (rows of '<id> <lat> <lon>').\n"
+            "--matrix-binary         Print the matrix as binary floats instead of CSV.\n"
+            "--snap-points=<fname>   Find the closest segment to each point in the file (rows\n"
+            "                        of '<id> <lat> <lon>') and print them in binary.\n"
+            "--snapped-points=<fname>\n"
+            "                        Load the points printed by '--snap-points' (used by\n"
+            "                        '--point<n>=<id>', batch rows of '<id> <id1> <id2>\n"
+            "                        [<id>]' and matrix rows of '<id>').\n"
+            "--route-cache=<fname>   Use the routes saved in the file instead of searching\n"
+            "                        and save any new routes to it.\n"
+            "--threads=<n>           Use this many threads for '--batch' or '--matrix'.\n"
             "\n"
             "--loggable              Print progress messages suitable for logging to file.\n"
             "--quiet                 Don't print any screen output when running.\n"
+            "--stats[=json]          Print the time taken and the work done for each\n"
+            "                        section of the route (as text or as JSON).\n"
             "\n"
             "--language=<lang>       Use the translations for specified language.\n"
             "--output-html           Write an HTML description of the route.\n"
@@ -702,10 +2134,20 @@ static void print_usage(int detail,const char *argerr,const char *err)
             "--output-gpx-route      Write a GPX route file with interesting junctions.\n"
             "--output-text           Write a plain text file with interesting junctions.\n"
             "--output-text-all       Write a plain test file with all route points.\n"
+            "--output-binary         Write a binary file with all route points, distances\n"
+            "                        and durations.\n"
+            "--output-polyline       Write an encoded polyline with all route points.\n"
+            "--output-geojson        Write a GeoJSON LineString with all route points.\n"
             "--output-none           Don't write any output files or read any translations.\n"
-            "                        (If no output option is given then all are written.)\n"
+            "                        (If no output option is given then the HTML, GPX and\n"
+            "                        text files are written.)\n"
+            "--output-dir=<dirname>  Write the output files into this directory.\n"
+            "--output-prefix=<name>  Start the names of the output files with this prefix.\n"
+            "--output-stdout         Write the one selected output format to stdout.\n"
             "\n"
             "--profile=<name>        Select the loaded profile with this name.\n"
+            "--profile=<name>,<name>,...\n"
+            "                        Try each of the profiles in turn until a route is found.\n"
             "--transport=<transport> Select the transport to use (selects the profile\n"
             "                        named after the transport if '--profile' is not used.)\n"
             "\n"
@@ -714,6 +2156,7 @@ static void print_usage(int detail,const char *argerr,const char *err)
             "\n"
             "--lon<n>=<longitude>    Specify the longitude of the n'th waypoint.\n"
             "--lat<n>=<latitude>     Specify the latitude of the n'th waypoint.\n"
+            "--point<n>=<id>         Use the snapped point with this id as the n'th waypoint.\n"
             "\n"
             "--heading=<bearing>     Initial compass bearing at lowest numbered waypoint.\n"
             "\n"
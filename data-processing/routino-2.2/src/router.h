@@ -0,0 +1,116 @@
+/***************************************
+ Header file for the route calculations of the router that are shared by the query modes.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#ifndef ROUTER_H
+#define ROUTER_H    /*+ To stop multiple inclusions. +*/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "types.h"
+
+#include "profiles.h"
+#include "results.h"
+
+
+/* Data structures */
+
+/*+ The parts of the calculation of a route that are timed. +*/
+typedef enum _Phase
+ {
+  Phase_Contraction=0,
+  Phase_Start      =1,
+  Phase_Finish     =2,
+  Phase_Middle     =3,
+  Phase_Combine    =4,
+
+  Phase_Count      =5
+ }
+ Phase;
+
+/*+ The time taken and the work done to calculate one section of a route. +*/
+typedef struct _LegStats
+{
+ int      from;                         /*+ The waypoint at the start of the section (or 0 if not calculated). +*/
+
+ double   time[Phase_Count];            /*+ The time taken by each part of the calculation (ms). +*/
+
+ RoutingCounters counters;              /*+ The work done by the routing searches. +*/
+}
+ LegStats;
+
+/*+ A routing query, the waypoints and the results. +*/
+typedef struct _Query
+{
+ int      point_used[NWAYPOINTS+1];     /*+ Which waypoints are used (1=lon, 2=lat, 3=both). +*/
+ double   point_lon[NWAYPOINTS+1];      /*+ The longitude of each waypoint. +*/
+ double   point_lat[NWAYPOINTS+1];      /*+ The latitude of each waypoint. +*/
+ const char *point_id[NWAYPOINTS+1];    /*+ The identifier of each waypoint in the snapped points file (or NULL). +*/
+
+ index_t  point_node[NWAYPOINTS+1];     /*+ The node (or fake node) closest to each waypoint. +*/
+ index_t  point_segment[NWAYPOINTS+1];  /*+ The segment that each waypoint was found on (or NO_SEGMENT). +*/
+
+ double   heading;                      /*+ The starting heading (or -999 if none). +*/
+
+ Results *results[NWAYPOINTS+1];        /*+ The results for each section of the route. +*/
+
+ LegStats *stats;                       /*+ The time taken and work done for each section of the route (or NULL). +*/
+
+ char     error[128];                   /*+ The error message if routing failed. +*/
+}
+ Query;
+
+/*+ A point in a snapped points file (the points are sorted by identifier). +*/
+typedef struct _SnappedPoint
+{
+ uint32_t   idoffset;                   /*+ The offset of the identifier of the point. +*/
+
+ index_t    segment;                    /*+ The segment that the point is on (or NO_SEGMENT if it is a node). +*/
+ index_t    node1;                      /*+ The node at one end of the segment (or the node itself or NO_NODE if not found). +*/
+ index_t    node2;                      /*+ The node at the other end of the segment. +*/
+ distance_t dist1;                      /*+ The distance along the segment to node1. +*/
+ distance_t dist2;                      /*+ The distance along the segment to node2. +*/
+
+ distance_t dist;                       /*+ The distance from the point to the segment or node. +*/
+}
+ SnappedPoint;
+
+
+/* Functions in router.c */
+
+void InitQuery(Query *query);
+void FreeQueryResults(Query *query);
+int ParseRoutingOption(const char *arg,Query *query,Profile *profile);
+
+index_t SnapWaypoint(Nodes *nodes,Segments *segments,Ways *ways,Profile *profile,int point,double latitude,double longitude,int exactnodes,index_t *snapped);
+index_t SnappedWaypoint(Nodes *nodes,Segments *segments,int point,SnappedPoint *snappedpoint,index_t *snapped);
+SnappedPoint *FindSnappedPoint(const char *id);
+
+int RouteWaypoints(Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,Query *query,int exactnodes);
+int WaypointsConnected(Nodes *nodes,Profile *profile,index_t node1,index_t node2);
+Contraction *ChooseContraction(Profile *profile);
+
+double ElapsedTime(struct timespec *start);
+void PrintStats(FILE *output,Query *query,double printtime);
+
+
+#endif /* ROUTER_H */
@@ -0,0 +1,396 @@
+/***************************************
+ Indexed store of batch routes.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "types.h"
+#include "routestore.h"
+
+#include "files.h"
+
+
+/* Local types */
+
+/*+ A route that has been read from the records written by the router. +*/
+typedef struct _RouteRecord
+{
+ char      *id;                 /*+ The identifier of the route. +*/
+ uint32_t   order;              /*+ The position of the route in the records. +*/
+
+ off_t      position;           /*+ The position of the coordinates of the route in the records. +*/
+ uint32_t   npoints;            /*+ The number of points in the route. +*/
+
+ distance_t distance;           /*+ The length of the route. +*/
+ duration_t duration;           /*+ The time taken to follow the route. +*/
+}
+ RouteRecord;
+
+
+/* Local functions */
+
+static void FreeRecords(RouteRecord *records,uint32_t nrecords);
+
+static int sort_by_id(RouteRecord *a,RouteRecord *b);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in a set of stored routes from a file.
+
+  RouteStore *LoadRouteStore Returns the stored routes or NULL if the file is not a valid route store.
+
+  const char *filename The name of the file to load.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+RouteStore *LoadRouteStore(const char *filename)
+{
+ RouteStore *store;
+ const char *error=NULL;
+ off_t size;
+ uint32_t i;
+
+ size=SizeFile(filename);
+
+ if(size<(off_t)sizeof(RouteStoreFile))
+   {
+    fprintf(stderr,"Error: The file '%s' is not a route store (it is too short).\n",filename);
+    return(NULL);
+   }
+
+ store=(RouteStore*)malloc(sizeof(RouteStore));
+
+ store->data=MapFile(filename);
+
+ /* Copy the RouteStoreFile header structure from the loaded data */
+
+ store->file=*((RouteStoreFile*)store->data);
+
+ /* Set the pointers in the RouteStore structure. */
+
+ store->entries =(RouteStoreEntry*)(store->data+sizeof(RouteStoreFile));
+ store->coords  =(RouteStoreCoord*)(store->data+sizeof(RouteStoreFile)+store->file.number*sizeof(RouteStoreEntry));
+ store->segments=(index_t*        )(store->data+sizeof(RouteStoreFile)+store->file.number*sizeof(RouteStoreEntry)+store->file.npoints*sizeof(RouteStoreCoord));
+ store->ids     =(char*           )(store->data+sizeof(RouteStoreFile)+store->file.number*sizeof(RouteStoreEntry)+store->file.npoints*(sizeof(RouteStoreCoord)+sizeof(index_t)));
+
+ /* Check the header, the size of the file and that the routes and identifiers are all within it */
+
+ if(store->file.magic!=ROUTESTORE_MAGIC)
+    error="it does not start with the magic number";
+ else if(store->file.version!=ROUTESTORE_VERSION)
+    error="it has the wrong version";
+ else if(size!=(off_t)sizeof(RouteStoreFile)+(off_t)store->file.number*(off_t)sizeof(RouteStoreEntry)+
+               (off_t)store->file.npoints*(off_t)(sizeof(RouteStoreCoord)+sizeof(index_t))+(off_t)store->file.idsize)
+    error="it has the wrong size";
+ else if(store->file.idsize>0 && store->ids[store->file.idsize-1]!=0)
+    error="the identifiers are not terminated";
+ else
+    for(i=0;i<store->file.number;i++)
+       if(store->entries[i].idoffset>=store->file.idsize ||
+          (uint64_t)store->entries[i].offset+store->entries[i].npoints>store->file.npoints)
+         {
+          error="a route is outside of the file";
+          break;
+         }
+
+ if(error)
+   {
+    fprintf(stderr,"Error: The file '%s' is not a valid route store (%s).\n",filename,error);
+
+    UnmapFile(filename);
+
+    free(store);
+
+    return(NULL);
+   }
+
+ return(store);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find a stored route using its identifier.
+
+  RouteStoreEntry *FindStoredRoute Returns the route or NULL if there is none.
+
+  RouteStore *store The stored routes.
+
+  const char *id The identifier of the route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+RouteStoreEntry *FindStoredRoute(RouteStore *store,const char *id)
+{
+ RouteStoreEntry *start=store->entries;
+ uint32_t number=store->file.number;
+
+ /* A binary search of the routes, which are sorted by identifier */
+
+ while(number>0)
+   {
+    RouteStoreEntry *middle=start+number/2;
+    int cmp=strcmp(id,StoredRouteId(store,middle));
+
+    if(cmp==0)
+       return(middle);
+
+    if(cmp>0)
+      {
+       start=middle+1;
+       number-=number/2+1;
+      }
+    else
+       number/=2;
+   }
+
+ return(NULL);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Create a store of routes sorted by identifier from the records written by the router.
+
+  int WriteRouteStore Returns 0 if the store was written or 1 in case of an error.
+
+  const char *recordsname The name of the file containing the records.
+
+  const char *filename The name of the store file to write.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int WriteRouteStore(const char *recordsname,const char *filename)
+{
+ RouteRecord *records=NULL;
+ RouteStoreFile storefile={ROUTESTORE_MAGIC,ROUTESTORE_VERSION,0,0,0};
+ uint64_t npoints=0,idsize=0;
+ uint32_t nrecords=0,maxpoints=0,i,j;
+ off_t size,position=0;
+ void *buffer;
+ int fd,storefd,readerror=0,writeerror=0;
+
+ /* Read the header and identifier of each route (checking that the whole route is in the file) */
+
+ fd=ReOpenFile(recordsname);
+
+ size=SizeFile(recordsname);
+
+ while(position<size)
+   {
+    RouteStoreRecord record;
+
+    if((size-position)<(off_t)sizeof(RouteStoreRecord) ||
+       SeekReadFile(fd,&record,sizeof(RouteStoreRecord),position))
+      {
+       readerror=1;
+       break;
+      }
+
+    position+=sizeof(RouteStoreRecord);
+
+    if((size-position)<(off_t)record.idlength+(off_t)record.npoints*(off_t)(sizeof(RouteStoreCoord)+sizeof(index_t)))
+      {
+       readerror=1;
+       break;
+      }
+
+    if((nrecords%1024)==0)
+       records=(RouteRecord*)realloc((void*)records,(nrecords+1024)*sizeof(RouteRecord));
+
+    records[nrecords].id=(char*)malloc(record.idlength+1);
+
+    if(SeekReadFile(fd,records[nrecords].id,record.idlength,position))
+      {
+       free(records[nrecords].id);
+       readerror=1;
+       break;
+      }
+
+    records[nrecords].id[record.idlength]=0;
+
+    position+=record.idlength;
+
+    records[nrecords].order=nrecords;
+    records[nrecords].position=position;
+    records[nrecords].npoints=record.npoints;
+    records[nrecords].distance=record.distance;
+    records[nrecords].duration=record.duration;
+
+    position+=(off_t)record.npoints*(sizeof(RouteStoreCoord)+sizeof(index_t));
+
+    nrecords++;
+   }
+
+ if(readerror)
+   {
+    fprintf(stderr,"Error: Cannot read the routes from '%s'.\n",recordsname);
+    FreeRecords(records,nrecords);
+    CloseFile(fd);
+    return(1);
+   }
+
+ /* Sort the routes by identifier and keep only the first route for each one */
+
+ if(nrecords)
+    qsort(records,nrecords,sizeof(RouteRecord),(int (*)(const void*,const void*))sort_by_id);
+
+ for(i=0,j=0;i<nrecords;i++)
+   {
+    if(j>0 && !strcmp(records[j-1].id,records[i].id))
+      {
+       fprintf(stderr,"Warning: The route identifier '%s' is used more than once (only the first is stored).\n",records[i].id);
+       free(records[i].id);
+       continue;
+      }
+
+    records[j++]=records[i];
+   }
+
+ nrecords=j;
+
+ for(i=0;i<nrecords;i++)
+   {
+    npoints+=records[i].npoints;
+    idsize+=strlen(records[i].id)+1;
+
+    if(records[i].npoints>maxpoints)
+       maxpoints=records[i].npoints;
+   }
+
+ if(npoints>UINT32_MAX || idsize>UINT32_MAX)
+   {
+    fprintf(stderr,"Error: There are too many points or identifiers to store in '%s'.\n",filename);
+    FreeRecords(records,nrecords);
+    CloseFile(fd);
+    return(1);
+   }
+
+ /* Write out the header, the routes, the coordinates, the segments and the identifiers */
+
+ storefile.number=nrecords;
+ storefile.npoints=npoints;
+ storefile.idsize=idsize;
+
+ buffer=malloc(maxpoints*sizeof(RouteStoreCoord)+1);
+
+ storefd=OpenFileNew(filename);
+
+ writeerror=WriteFile(storefd,&storefile,sizeof(RouteStoreFile));
+
+ npoints=0;
+ idsize=0;
+
+ for(i=0;i<nrecords && !writeerror;i++)
+   {
+    RouteStoreEntry entry;
+
+    entry.idoffset=idsize;
+    entry.offset=npoints;
+    entry.npoints=records[i].npoints;
+    entry.distance=records[i].distance;
+    entry.duration=records[i].duration;
+
+    writeerror=WriteFile(storefd,&entry,sizeof(RouteStoreEntry));
+
+    npoints+=records[i].npoints;
+    idsize+=strlen(records[i].id)+1;
+   }
+
+ for(i=0;i<nrecords && !writeerror && !readerror;i++)
+   {
+    readerror=SeekReadFile(fd,buffer,records[i].npoints*sizeof(RouteStoreCoord),records[i].position);
+
+    if(!readerror)
+       writeerror=WriteFile(storefd,buffer,records[i].npoints*sizeof(RouteStoreCoord));
+   }
+
+ for(i=0;i<nrecords && !writeerror && !readerror;i++)
+   {
+    readerror=SeekReadFile(fd,buffer,records[i].npoints*sizeof(index_t),records[i].position+records[i].npoints*sizeof(RouteStoreCoord));
+
+    if(!readerror)
+       writeerror=WriteFile(storefd,buffer,records[i].npoints*sizeof(index_t));
+   }
+
+ for(i=0;i<nrecords && !writeerror && !readerror;i++)
+    writeerror=WriteFile(storefd,records[i].id,strlen(records[i].id)+1);
+
+ if(readerror)
+    fprintf(stderr,"Error: Cannot read the routes from '%s'.\n",recordsname);
+ else if(writeerror)
+    fprintf(stderr,"Error: Cannot write the route store '%s' [%s].\n",filename,strerror(errno));
+
+ CloseFile(storefd);
+
+ CloseFile(fd);
+
+ /* Do not leave an incomplete store behind */
+
+ if(readerror || writeerror)
+    unlink(filename);
+
+ free(buffer);
+
+ FreeRecords(records,nrecords);
+
+ return(readerror || writeerror);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Free the routes that have been read from the records.
+
+  RouteRecord *records The routes (or NULL if there are none).
+
+  uint32_t nrecords The number of routes.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void FreeRecords(RouteRecord *records,uint32_t nrecords)
+{
+ uint32_t i;
+
+ for(i=0;i<nrecords;i++)
+    free(records[i].id);
+
+ if(records)
+    free(records);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Sort the routes into identifier order (and the order they were written for the same identifier).
+
+  int sort_by_id Returns the comparison of the id fields.
+
+  RouteRecord *a The first route.
+
+  RouteRecord *b The second route.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static int sort_by_id(RouteRecord *a,RouteRecord *b)
+{
+ int cmp=strcmp(a->id,b->id);
+
+ if(cmp)
+    return(cmp);
+
+ return((a->order<b->order)?-1:(a->order>b->order)?1:0);
+}
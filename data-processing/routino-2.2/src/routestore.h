@@ -0,0 +1,132 @@
+/***************************************
+ A header file for the indexed store of batch routes.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#ifndef ROUTESTORE_H
+#define ROUTESTORE_H    /*+ To stop multiple inclusions. +*/
+
+#include <stdint.h>
+
+#include "types.h"
+
+
+/* Constants */
+
+/*+ The scale factor applied to the latitudes and longitudes in degrees to store them as integers. +*/
+#define ROUTESTORE_SCALE 1.0E7
+
+/*+ The magic number at the start of a route store file ("RTST" when read as bytes). +*/
+#define ROUTESTORE_MAGIC 0x54535452
+
+/*+ The version of the route store file format. +*/
+#define ROUTESTORE_VERSION 1
+
+
+/* Data structures */
+
+
+/*+ The coordinates of a point on a stored route. +*/
+typedef struct _RouteStoreCoord
+{
+ int32_t    latitude;           /*+ The latitude (degrees multiplied by ROUTESTORE_SCALE). +*/
+ int32_t    longitude;          /*+ The longitude (degrees multiplied by ROUTESTORE_SCALE). +*/
+}
+ RouteStoreCoord;
+
+
+/*+ A stored route (the routes are sorted by identifier in the file). +*/
+typedef struct _RouteStoreEntry
+{
+ uint32_t   idoffset;           /*+ The offset of the identifier of the route. +*/
+
+ uint32_t   offset;             /*+ The index of the first point of the route in the coordinate and segment arrays. +*/
+ uint32_t   npoints;            /*+ The number of points in the route. +*/
+
+ distance_t distance;           /*+ The length of the route. +*/
+ duration_t duration;           /*+ The time taken to follow the route. +*/
+}
+ RouteStoreEntry;
+
+
+/*+ A structure containing the header from the file. +*/
+typedef struct _RouteStoreFile
+{
+ uint32_t   magic;              /*+ The magic number that identifies a route store file. +*/
+ uint32_t   version;            /*+ The version of the file format. +*/
+
+ uint32_t   number;             /*+ The number of routes. +*/
+ uint32_t   npoints;            /*+ The total number of points in the routes. +*/
+
+ uint32_t   idsize;             /*+ The size of the identifiers (following the segments). +*/
+}
+ RouteStoreFile;
+
+
+/*+ A route as it is written by the router before the routes are sorted into a store
+    (followed by the identifier, the coordinates and the segments). +*/
+typedef struct _RouteStoreRecord
+{
+ uint32_t   idlength;           /*+ The length of the identifier (not including the terminating zero). +*/
+ uint32_t   npoints;            /*+ The number of points in the route. +*/
+
+ distance_t distance;           /*+ The length of the route. +*/
+ duration_t duration;           /*+ The time taken to follow the route. +*/
+}
+ RouteStoreRecord;
+
+
+/*+ A structure containing a set of stored routes. +*/
+typedef struct _RouteStore
+{
+ RouteStoreFile   file;         /*+ The header data from the file. +*/
+
+ void            *data;         /*+ The memory mapped data in the file. +*/
+
+ RouteStoreEntry *entries;      /*+ A pointer to the array of routes in the file. +*/
+ RouteStoreCoord *coords;       /*+ A pointer to the array of coordinates of the points in the file. +*/
+ index_t         *segments;     /*+ A pointer to the array of segments used to reach the points in the file. +*/
+ char            *ids;          /*+ A pointer to the identifiers in the file. +*/
+}
+ RouteStore;
+
+
+/* Functions in routestore.c */
+
+RouteStore *LoadRouteStore(const char *filename);
+
+RouteStoreEntry *FindStoredRoute(RouteStore *store,const char *id);
+
+int WriteRouteStore(const char *recordsname,const char *filename);
+
+
+/* Macros */
+
+/*+ Return the identifier of a stored route. +*/
+#define StoredRouteId(xxx,yyy)       ((xxx)->ids+(yyy)->idoffset)
+
+/*+ Return a pointer to the coordinates of the points of a stored route. +*/
+#define StoredRouteCoords(xxx,yyy)   (&(xxx)->coords[(yyy)->offset])
+
+/*+ Return a pointer to the segments used to reach the points of a stored route (NO_SEGMENT for the first). +*/
+#define StoredRouteSegments(xxx,yyy) (&(xxx)->segments[(yyy)->offset])
+
+
+#endif /* ROUTESTORE_H */
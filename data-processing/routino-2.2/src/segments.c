@@ -62,6 +62,12 @@ Segments *LoadSegmentList(const char *filename)
 
  segments->segments=(Segment*)(segments->data+sizeof(SegmentsFile));
 
+ segments->pathoffsets=NULL;
+ segments->paths=NULL;
+
+ segments->binoffsets=NULL;
+ segments->binned=NULL;
+
 #else
 
  segments->fd=ReOpenFile(filename);
@@ -70,6 +76,11 @@ Segments *LoadSegmentList(const char *filename)
 
  ReadFile(segments->fd,&segments->file,sizeof(SegmentsFile));
 
+ segments->pfd=-1;
+
+ segments->bfd=-1;
+ segments->binoffsets=NULL;
+
  for(i=0;i<sizeof(segments->cached)/sizeof(segments->cached[0]);i++)
     segments->incache[i]=NO_SEGMENT;
 
@@ -79,6 +90,244 @@ Segments *LoadSegmentList(const char *filename)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Create a copy of a segment list that can be used by another thread at the same time
+  (the copy has its own cache in slim mode).
+
+  Segments *CopySegmentList Returns the new segment list.
+
+  Segments *segments The segment list to copy.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Segments *CopySegmentList(Segments *segments)
+{
+ Segments *copy;
+#if SLIM
+ int i;
+#endif
+
+ copy=(Segments*)malloc(sizeof(Segments));
+
+ *copy=*segments;
+
+#if SLIM
+
+ for(i=0;i<sizeof(copy->cached)/sizeof(copy->cached[0]);i++)
+    copy->incache[i]=NO_SEGMENT;
+
+#endif
+
+ return(copy);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in the paths of normal segments that make up each super-segment from a file.
+
+  int LoadSuperSegmentPaths Returns 0 if the paths were loaded or 1 if they do not match the segments.
+
+  Segments *segments The segment list to add the paths to.
+
+  const char *filename The name of the file to load.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int LoadSuperSegmentPaths(Segments *segments,const char *filename)
+{
+ SuperPathsFile superpathsfile;
+
+#if !SLIM
+
+ void *data=MapFile(filename);
+
+ superpathsfile=*((SuperPathsFile*)data);
+
+ if(superpathsfile.number!=segments->file.number)
+   {
+    UnmapFile(filename);
+    return(1);
+   }
+
+ segments->pathoffsets=(index_t*)(data+sizeof(SuperPathsFile));
+ segments->paths      =(index_t*)(data+sizeof(SuperPathsFile)+(superpathsfile.number+1)*sizeof(index_t));
+
+#else
+
+ segments->pfd=ReOpenFile(filename);
+
+ ReadFile(segments->pfd,&superpathsfile,sizeof(SuperPathsFile));
+
+ if(superpathsfile.number!=segments->file.number)
+   {
+    segments->pfd=CloseFile(segments->pfd);
+    return(1);
+   }
+
+#endif
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the path of normal segments that make up a super-segment.
+
+  index_t LookupSuperSegmentPath Returns the number of normal segments (0 if the path is not known).
+
+  Segments *segments The set of segments to use.
+
+  index_t segment The index of the super-segment.
+
+  index_t *first Returns the offset of the first normal segment (for LookupPathSegment()).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+index_t LookupSuperSegmentPath(Segments *segments,index_t segment,index_t *first)
+{
+ index_t offsets[2];
+
+#if !SLIM
+
+ if(!segments->pathoffsets)
+    return(0);
+
+ offsets[0]=segments->pathoffsets[segment];
+ offsets[1]=segments->pathoffsets[segment+1];
+
+#else
+
+ if(segments->pfd==-1)
+    return(0);
+
+ SeekReadFile(segments->pfd,offsets,2*sizeof(index_t),sizeof(SuperPathsFile)+(off_t)segment*sizeof(index_t));
+
+#endif
+
+ *first=offsets[0];
+
+ return(offsets[1]-offsets[0]);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find one of the normal segments in the path of a super-segment.
+
+  index_t LookupPathSegment Returns the index of the normal segment.
+
+  Segments *segments The set of segments to use.
+
+  index_t offset The offset of the normal segment (from LookupSuperSegmentPath()).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+index_t LookupPathSegment(Segments *segments,index_t offset)
+{
+#if !SLIM
+
+ return(segments->paths[offset]);
+
+#else
+
+ index_t segment;
+
+ SeekReadFile(segments->pfd,&segment,sizeof(index_t),sizeof(SuperPathsFile)+(off_t)(segments->file.number+1)*sizeof(index_t)+(off_t)offset*sizeof(index_t));
+
+ return(segment);
+
+#endif
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Load in the lists of segments in each lat/long bin from a file.
+
+  int LoadSegmentBins Returns 0 if the bins were loaded or 1 if they do not match the segments and nodes.
+
+  Segments *segments The segment list to add the bins to.
+
+  Nodes *nodes The set of nodes (that the bins must match).
+
+  const char *filename The name of the file to load.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int LoadSegmentBins(Segments *segments,Nodes *nodes,const char *filename)
+{
+ SegmentBinsFile segmentbinsfile;
+ size_t sizeoffsets;
+#if !SLIM
+ void *data;
+#endif
+
+#if !SLIM
+
+ data=MapFile(filename);
+
+ segmentbinsfile=*((SegmentBinsFile*)data);
+
+#else
+
+ segments->bfd=ReOpenFile(filename);
+
+ ReadFile(segments->bfd,&segmentbinsfile,sizeof(SegmentBinsFile));
+
+#endif
+
+ if(segmentbinsfile.number!=segments->file.number ||
+    segmentbinsfile.latbins!=nodes->file.latbins || segmentbinsfile.lonbins!=nodes->file.lonbins ||
+    segmentbinsfile.latzero!=nodes->file.latzero || segmentbinsfile.lonzero!=nodes->file.lonzero)
+   {
+#if !SLIM
+    UnmapFile(filename);
+#else
+    segments->bfd=CloseFile(segments->bfd);
+#endif
+    return(1);
+   }
+
+ sizeoffsets=((size_t)segmentbinsfile.latbins*segmentbinsfile.lonbins+1)*sizeof(index_t);
+
+#if !SLIM
+
+ segments->binoffsets=(index_t*)(data+sizeof(SegmentBinsFile));
+ segments->binned    =(BinnedSegment*)(data+sizeof(SegmentBinsFile)+sizeoffsets);
+
+#else
+
+ segments->binoffsets=(index_t*)malloc(sizeoffsets);
+
+ ReadFile(segments->bfd,segments->binoffsets,sizeoffsets);
+
+ segments->binnedoffset=sizeof(SegmentBinsFile)+sizeoffsets;
+
+#endif
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find one of the binned segments.
+
+  BinnedSegment *LookupBinnedSegment Returns a pointer to the binned segment.
+
+  Segments *segments The set of segments to use.
+
+  index_t index The index of the binned segment (from the offsets of the bins).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+BinnedSegment *LookupBinnedSegment(Segments *segments,index_t index)
+{
+#if !SLIM
+
+ return(&segments->binned[index]);
+
+#else
+
+ SeekReadFile(segments->bfd,&segments->bcached,sizeof(BinnedSegment),segments->binnedoffset+(off_t)index*sizeof(BinnedSegment));
+
+ return(&segments->bcached);
+
+#endif
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Find the closest segment from a specified node heading in a particular direction and optionally profile.
 
@@ -240,6 +489,43 @@ duration_t Duration(Segment *segment,Way *way,Profile *profile)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Calculate the duration of travel on a segment without rounding it to a whole number of
+  duration_t units (so that the durations of the segments that make up a super-segment add up
+  to the duration of the super-segment when they are used to compare routes).
+
+  double ExactDuration Returns the duration of travel (in duration_t units).
+
+  Segment *segment The segment to traverse.
+
+  Way *way The way that the segment belongs to.
+
+  Profile *profile The profile of the transport being used.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+double ExactDuration(Segment *segment,Way *way,Profile *profile)
+{
+ speed_t    speed1=way->speed;
+ speed_t    speed2=profile->speed[HIGHWAY(way->type)];
+ distance_t distance=DISTANCE(segment->distance);
+
+ if(speed1==0)
+   {
+    if(speed2==0)
+       return((double)hours_to_duration(10));
+    else
+       return(((double)distance/(double)speed2)*(36000.0/1000.0));
+   }
+ else /* if(speed1!=0) */
+   {
+    if(speed2==0 || speed1<=speed2)
+       return(((double)distance/(double)speed1)*(36000.0/1000.0));
+    else
+       return(((double)distance/(double)speed2)*(36000.0/1000.0));
+   }
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Calculate the angle to turn at a junction from segment1 to segment2 at node.
 
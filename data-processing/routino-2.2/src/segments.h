@@ -26,6 +26,7 @@
 #define SEGMENTS_H    /*+ To stop multiple inclusions. +*/
 
 #include <stdint.h>
+#include <sys/types.h>
 
 #include "types.h"
 
@@ -60,6 +61,43 @@ typedef struct _SegmentsFile
  SegmentsFile;
 
 
+/*+ A structure containing the header from the super-segment paths file. +*/
+typedef struct _SuperPathsFile
+{
+ index_t   number;              /*+ The number of segments in total (followed by the offset of the path for each one). +*/
+ index_t   npaths;              /*+ The number of normal segments in all of the paths (following the offsets). +*/
+}
+ SuperPathsFile;
+
+
+/*+ A structure containing the header from the segment bins file. +*/
+typedef struct _SegmentBinsFile
+{
+ index_t   number;              /*+ The number of segments in total. +*/
+ index_t   nbinned;             /*+ The number of binned segments in all of the bins (following the offset for each bin). +*/
+
+ ll_bin_t  latbins;             /*+ The number of bins containing latitude (the same as the nodes). +*/
+ ll_bin_t  lonbins;             /*+ The number of bins containing longitude (the same as the nodes). +*/
+
+ ll_bin_t  latzero;             /*+ The bin number of the furthest south bin (the same as the nodes). +*/
+ ll_bin_t  lonzero;             /*+ The bin number of the furthest west bin (the same as the nodes). +*/
+}
+ SegmentBinsFile;
+
+
+/*+ A normal segment listed in each of the lat/long bins that its bounding box overlaps. +*/
+typedef struct _BinnedSegment
+{
+ index_t   segment;             /*+ The index of the segment. +*/
+
+ latlong_t lat1;                /*+ The latitude of the first node of the segment. +*/
+ latlong_t lon1;                /*+ The longitude of the first node of the segment. +*/
+ latlong_t lat2;                /*+ The latitude of the second node of the segment. +*/
+ latlong_t lon2;                /*+ The longitude of the second node of the segment. +*/
+}
+ BinnedSegment;
+
+
 /*+ A structure containing a set of segments (and pointers to mmap file). +*/
 struct _Segments
 {
@@ -71,10 +109,24 @@ struct _Segments
 
  Segment     *segments;         /*+ An array of segments. +*/
 
+ index_t     *pathoffsets;      /*+ The offset of the path of normal segments for each super-segment (or NULL). +*/
+ index_t     *paths;            /*+ The normal segments that make up each super-segment. +*/
+
+ index_t     *binoffsets;       /*+ The offset of the binned segments for each lat/long bin (or NULL). +*/
+ BinnedSegment *binned;         /*+ The binned segments. +*/
+
 #else
 
  int          fd;               /*+ The file descriptor for the file. +*/
 
+ int          pfd;              /*+ The file descriptor for the super-segment paths file (or -1). +*/
+
+ int          bfd;              /*+ The file descriptor for the segment bins file (or -1). +*/
+ index_t     *binoffsets;       /*+ The offset of the binned segments for each lat/long bin (or NULL). +*/
+ off_t        binnedoffset;     /*+ The offset of the binned segments in the file. +*/
+
+ BinnedSegment bcached;         /*+ A cached binned segment read from the file in slim mode. +*/
+
  Segment      cached[3];        /*+ Three cached segments read from the file in slim mode. +*/
  index_t      incache[3];       /*+ The indexes of the cached segments. +*/
 
@@ -86,11 +138,23 @@ struct _Segments
 
 Segments *LoadSegmentList(const char *filename);
 
+Segments *CopySegmentList(Segments *segments);
+
+int LoadSuperSegmentPaths(Segments *segments,const char *filename);
+
+index_t LookupSuperSegmentPath(Segments *segments,index_t segment,index_t *first);
+index_t LookupPathSegment(Segments *segments,index_t offset);
+
+int LoadSegmentBins(Segments *segments,Nodes *nodes,const char *filename);
+
+BinnedSegment *LookupBinnedSegment(Segments *segments,index_t index);
+
 index_t FindClosestSegmentHeading(Nodes *nodes,Segments *segments,Ways *ways,index_t node1,double heading,Profile *profile);
 
 distance_t Distance(double lat1,double lon1,double lat2,double lon2);
 
 duration_t Duration(Segment *segment,Way *way,Profile *profile);
+double ExactDuration(Segment *segment,Way *way,Profile *profile);
 
 double TurnAngle(Nodes *nodes,Segment *segment1,Segment *segment2,index_t node);
 double BearingAngle(Nodes *nodes,Segment *segment,index_t node);
@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include "types.h"
+#include "nodes.h"
 #include "segments.h"
 #include "ways.h"
 
@@ -934,6 +935,138 @@ void SaveSegmentList(SegmentsX *segmentsx,const char *filename)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  List each normal segment in every lat/long bin that its bounding box overlaps (using the
+  database files that have been written) so that the router can find the closest segment
+  to a point without looking up the nodes.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  const char *filename The name of the file to write.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void SaveSegmentBins(Nodes *nodes,Segments *segments,const char *filename)
+{
+ SegmentBinsFile segmentbinsfile={0};
+ index_t *offsets,*counts,i,nbinned=0;
+ ll_bin2_t nbins=(ll_bin2_t)nodes->file.latbins*nodes->file.lonbins,b;
+ BinnedSegment *binned;
+ int pass,fd;
+
+ /* Print the start message */
+
+ printf_first("Binning Segments: Segments=0 Binned=0");
+
+ offsets=(index_t*)calloc(nbins+1,sizeof(index_t));
+ counts =(index_t*)calloc(nbins,sizeof(index_t));
+
+ assert(offsets); /* Check calloc() worked */
+ assert(counts);  /* Check calloc() worked */
+
+ binned=NULL;
+
+ /* Count the segments in each bin on the first pass and fill in the bins on the second pass */
+
+ for(pass=1;pass<=2;pass++)
+   {
+    if(pass==2)
+      {
+       for(b=0;b<nbins;b++)
+          offsets[b+1]=offsets[b]+counts[b];
+
+       nbinned=offsets[nbins];
+
+       binned=(BinnedSegment*)malloc((nbinned?nbinned:1)*sizeof(BinnedSegment));
+
+       assert(binned); /* Check malloc() worked */
+
+       for(b=0;b<nbins;b++)
+          counts[b]=0;
+      }
+
+    for(i=0;i<segments->file.number;i++)
+      {
+       Segment *segment=LookupSegment(segments,i,1);
+       BinnedSegment binnedsegment;
+       double lat1,lon1,lat2,lon2;
+       ll_bin_t latb,lonb,minlatb,maxlatb,minlonb,maxlonb;
+
+       if(!IsNormalSegment(segment))
+          continue;
+
+       GetLatLong(nodes,segment->node1,&lat1,&lon1);
+       GetLatLong(nodes,segment->node2,&lat2,&lon2);
+
+       binnedsegment.segment=i;
+       binnedsegment.lat1=radians_to_latlong(lat1);
+       binnedsegment.lon1=radians_to_latlong(lon1);
+       binnedsegment.lat2=radians_to_latlong(lat2);
+       binnedsegment.lon2=radians_to_latlong(lon2);
+
+       minlatb=latlong_to_bin(binnedsegment.lat1)-nodes->file.latzero;
+       maxlatb=latlong_to_bin(binnedsegment.lat2)-nodes->file.latzero;
+       minlonb=latlong_to_bin(binnedsegment.lon1)-nodes->file.lonzero;
+       maxlonb=latlong_to_bin(binnedsegment.lon2)-nodes->file.lonzero;
+
+       if(minlatb>maxlatb) {latb=minlatb; minlatb=maxlatb; maxlatb=latb;}
+       if(minlonb>maxlonb) {lonb=minlonb; minlonb=maxlonb; maxlonb=lonb;}
+
+       if(minlatb<0) minlatb=0;
+       if(minlonb<0) minlonb=0;
+       if(maxlatb>=nodes->file.latbins) maxlatb=nodes->file.latbins-1;
+       if(maxlonb>=nodes->file.lonbins) maxlonb=nodes->file.lonbins-1;
+
+       for(latb=minlatb;latb<=maxlatb;latb++)
+          for(lonb=minlonb;lonb<=maxlonb;lonb++)
+            {
+             ll_bin2_t llbin=lonb*nodes->file.latbins+latb;
+
+             if(pass==2)
+                binned[offsets[llbin]+counts[llbin]]=binnedsegment;
+
+             counts[llbin]++;
+            }
+
+       if(pass==2 && !((i+1)%10000))
+          printf_middle("Binning Segments: Segments=%"Pindex_t" Binned=%"Pindex_t,i+1,offsets[nbins]);
+      }
+   }
+
+ /* Write out the header structure and the data */
+
+ fd=OpenFileNew(filename);
+
+ segmentbinsfile.number =segments->file.number;
+ segmentbinsfile.nbinned=nbinned;
+
+ segmentbinsfile.latbins=nodes->file.latbins;
+ segmentbinsfile.lonbins=nodes->file.lonbins;
+ segmentbinsfile.latzero=nodes->file.latzero;
+ segmentbinsfile.lonzero=nodes->file.lonzero;
+
+ WriteFile(fd,&segmentbinsfile,sizeof(SegmentBinsFile));
+
+ WriteFile(fd,offsets,(nbins+1)*sizeof(index_t));
+
+ if(nbinned)
+    WriteFile(fd,binned,nbinned*sizeof(BinnedSegment));
+
+ CloseFile(fd);
+
+ /* Free the memory */
+
+ free(offsets);
+ free(counts);
+ free(binned);
+
+ /* Print the final message */
+
+ printf_last("Binned Segments: Segments=%"Pindex_t" Binned=%"Pindex_t,segments->file.number,nbinned);
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Calculate the distance between two nodes.
 
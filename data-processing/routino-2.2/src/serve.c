@@ -0,0 +1,260 @@
+/***************************************
+ Routing queries answered by a persistent router (from stdin or a Unix domain socket).
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "types.h"
+#include "nodes.h"
+#include "segments.h"
+#include "ways.h"
+#include "relations.h"
+#include "routecache.h"
+
+#include "functions.h"
+#include "profiles.h"
+#include "router.h"
+#include "serve.h"
+
+
+/* Global variables */
+
+/*+ The option not to print any progress information. +*/
+extern int option_quiet;
+
+/*+ The option to calculate the quickest route insted of the shortest. +*/
+extern int option_quickest;
+
+/*+ The option to print the time taken and the work done for each section of the route (1=text, 2=JSON). +*/
+extern int option_stats;
+
+/*+ The cache of routes that have been calculated before (or NULL). +*/
+extern RouteCache *routecache;
+
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Read routing queries (one per line) and write a response for each one.
+
+  Each query line contains the same routing options as the command line (waypoints,
+  '--shortest' or '--quickest', '--profile', '--transport', '--heading' and the profile
+  modifications). Each response starts with a status line ("Routed OK" or an error
+  message), followed by one line of latitude and longitude for each point of the
+  route and is terminated by an empty line.
+
+  FILE *input The file to read the queries from.
+
+  FILE *output The file to write the responses to.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The default profile (before being updated to match the database).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void ServeQueries(FILE *input,FILE *output,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,int exactnodes)
+{
+ char  *line=NULL;
+ size_t length=0;
+
+ while(getline(&line,&length,input)!=-1)
+   {
+    Query   query;
+    Profile qprofile=*profile;
+    int     quickest=option_quickest;
+    char   *copy=strcpy((char*)malloc(strlen(line)+1),line);
+    char   *arg,*argerr=NULL;
+    int     point;
+
+    InitQuery(&query);
+
+    /* Select the profile first since the other options modify it */
+
+    for(arg=strtok(copy," \t\r\n");arg;arg=strtok(NULL," \t\r\n"))
+      {
+       Profile *named=NULL;
+
+       if(!strncmp(arg,"--profile=",10))
+          named=GetProfile(&arg[10]);
+       else if(!strncmp(arg,"--transport=",12))
+          named=GetProfile(TransportName(TransportType(&arg[12])));
+       else
+          continue;
+
+       if(named)
+          qprofile=*named;
+       else
+          argerr="(unknown profile)";
+
+       break;
+      }
+
+    free(copy);
+
+    /* Parse the remaining options */
+
+    if(!argerr)
+       for(arg=strtok(line," \t\r\n");arg;arg=strtok(NULL," \t\r\n"))
+          if(strncmp(arg,"--profile=",10) && strncmp(arg,"--transport=",12))
+             if(ParseRoutingOption(arg,&query,&qprofile))
+               {
+                argerr=arg;
+                break;
+               }
+
+    for(point=1;point<=NWAYPOINTS;point++)
+       if(query.point_used[point]==1 || query.point_used[point]==2)
+          argerr="(incomplete waypoint)";
+
+    /* Route it */
+
+    if(argerr)
+       fprintf(output,"Error: Invalid query parameter '%s'.\n",argerr);
+    else if(UpdateProfile(&qprofile,ways))
+       fprintf(output,"Error: Profile is invalid or not compatible with database.\n");
+    else if(RouteWaypoints(nodes,segments,ways,relations,&qprofile,&query,exactnodes))
+      {
+       fprintf(output,"Error: %s\n",query.error);
+
+       if(option_stats)
+          PrintStats(output,&query,0);
+      }
+    else
+      {
+       struct timespec start;
+
+       fprintf(output,"Routed OK\n");
+
+       clock_gettime(CLOCK_MONOTONIC,&start);
+
+       PrintRoutePoints(output,NULL,query.results,NWAYPOINTS,nodes);
+
+       if(option_stats)
+          PrintStats(output,&query,ElapsedTime(&start));
+      }
+
+    fprintf(output,"\n");
+    fflush(output);
+
+    FreeQueryResults(&query);
+
+    option_quickest=quickest;
+   }
+
+ if(line)
+    free(line);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Listen on a Unix domain socket and answer the routing queries from each connection in turn.
+
+  int ServeSocket Returns 1 in case of an error (it does not return otherwise).
+
+  const char *socketname The filename of the socket.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  Relations *relations The set of relations to use.
+
+  Profile *profile The default profile (before being updated to match the database).
+
+  int exactnodes Only route between nodes (don't find closest segment).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int ServeSocket(const char *socketname,Nodes *nodes,Segments *segments,Ways *ways,Relations *relations,Profile *profile,int exactnodes)
+{
+ struct sockaddr_un address;
+ int sock;
+
+ if(strlen(socketname)>=sizeof(address.sun_path))
+   {
+    fprintf(stderr,"Error: The socket name '%s' is too long.\n",socketname);
+    return(1);
+   }
+
+ memset(&address,0,sizeof(address));
+ address.sun_family=AF_UNIX;
+ strcpy(address.sun_path,socketname);
+
+ sock=socket(AF_UNIX,SOCK_STREAM,0);
+
+ unlink(socketname);
+
+ if(sock<0 || bind(sock,(struct sockaddr*)&address,sizeof(address)) || listen(sock,8))
+   {
+    fprintf(stderr,"Error: Cannot listen on socket '%s' [%s].\n",socketname,strerror(errno));
+    return(1);
+   }
+
+ /* A client that disconnects early must not stop the server */
+
+ signal(SIGPIPE,SIG_IGN);
+
+ if(!option_quiet)
+   {
+    printf("Listening on '%s'\n",socketname);
+    fflush(stdout);
+   }
+
+ while(1)
+   {
+    FILE *input,*output;
+    int fd=accept(sock,NULL,NULL);
+
+    if(fd<0)
+       continue;
+
+    input=fdopen(fd,"r");
+    output=fdopen(dup(fd),"w");
+
+    ServeQueries(input,output,nodes,segments,ways,relations,profile,exactnodes);
+
+    fclose(output);
+    fclose(input);
+
+    /* The server does not exit so the new routes are saved after each connection */
+
+    if(routecache)
+       SaveRouteCache(routecache);
+   }
+
+ return(0);
+}
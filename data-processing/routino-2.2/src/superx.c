@@ -24,6 +24,7 @@
 #include <stdlib.h>
 
 #include "types.h"
+#include "nodes.h"
 #include "segments.h"
 #include "ways.h"
 
@@ -41,6 +42,7 @@
 /* Local functions */
 
 static Results *FindRoutesWay(NodesX *nodesx,SegmentsX *segmentsx,WaysX *waysx,node_t start,Way *match);
+static Results *FindSuperSegmentPath(Nodes *nodes,Segments *segments,Ways *ways,index_t start,Way *match);
 
 
 /*++++++++++++++++++++++++++++++++++++++
@@ -528,3 +530,258 @@ static Results *FindRoutesWay(NodesX *nodesx,SegmentsX *segmentsx,WaysX *waysx,n
 
  return(results);
 }
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find the path of normal segments that each super-segment replaces and save them to a file
+  (using the database files that have been written so that the segment indexes are final).
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  const char *filename The name of the file to write.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+void SaveSuperSegmentPaths(Nodes *nodes,Segments *segments,Ways *ways,const char *filename)
+{
+ SuperPathsFile superpathsfile={0};
+ index_t *offsets,*paths=NULL;
+ index_t i,npaths=0,apaths=0,nsuper=0,nfound=0;
+ int fd;
+
+ /* Print the start message */
+
+ printf_first("Finding Super-Segment Paths: Segments=0 Super-Segments=0 Paths=0");
+
+ offsets=(index_t*)malloc((segments->file.number+1)*sizeof(index_t));
+
+ assert(offsets); /* Check malloc() worked */
+
+ for(i=0;i<segments->file.number;i++)
+   {
+    Segment *segment=LookupSegment(segments,i,1);
+
+    offsets[i]=npaths;
+
+    /* Only the super-segments that are not also normal segments have a path */
+
+    if(IsSuperSegment(segment) && !IsNormalSegment(segment))
+      {
+       Results *results;
+       Result *result,*best=NULL;
+       Way way=*LookupWay(ways,segment->way,1);
+       index_t node1=segment->node1,node2=segment->node2;
+       index_t start,finish,n=0,j;
+       distance_t distance=DISTANCE(segment->distance),error=0;
+
+       nsuper++;
+
+       /* Follow the same type of way from the end that the super-segment can be used from */
+
+       if(IsOnewayTo(segment,node1))
+         {
+          start=node2;
+          finish=node1;
+         }
+       else
+         {
+          start=node1;
+          finish=node2;
+         }
+
+       results=FindSuperSegmentPath(nodes,segments,ways,start,&way);
+
+       result=FirstResult(results);
+
+       while(result)
+         {
+          if(result->node==finish && result->segment!=NO_SEGMENT)
+            {
+             distance_t thiserror=(distance_t)result->score>distance?(distance_t)result->score-distance:distance-(distance_t)result->score;
+
+             if(!best || thiserror<error)
+               {
+                best=result;
+                error=thiserror;
+               }
+            }
+
+          result=NextResult(results,result);
+         }
+
+       /* Store the path from node1 to node2 */
+
+       if(best)
+         {
+          for(result=best;result->prev;result=result->prev)
+             n++;
+
+          if((npaths+n)>apaths)
+            {
+             apaths=npaths+n+1024;
+             paths=(index_t*)realloc((void*)paths,apaths*sizeof(index_t));
+
+             assert(paths); /* Check realloc() worked */
+            }
+
+          for(result=best,j=0;result->prev;result=result->prev,j++)
+            {
+             if(start==node1)
+                paths[npaths+n-1-j]=result->segment;
+             else
+                paths[npaths+j]=result->segment;
+            }
+
+          npaths+=n;
+          nfound++;
+         }
+
+       FreeResultsList(results);
+      }
+
+    if(!((i+1)%10000))
+       printf_middle("Finding Super-Segment Paths: Segments=%"Pindex_t" Super-Segments=%"Pindex_t" Paths=%"Pindex_t,i+1,nsuper,nfound);
+   }
+
+ offsets[segments->file.number]=npaths;
+
+ /* Write out the header structure and the data */
+
+ fd=OpenFileNew(filename);
+
+ superpathsfile.number=segments->file.number;
+ superpathsfile.npaths=npaths;
+
+ WriteFile(fd,&superpathsfile,sizeof(SuperPathsFile));
+
+ WriteFile(fd,offsets,(segments->file.number+1)*sizeof(index_t));
+
+ if(npaths)
+    WriteFile(fd,paths,npaths*sizeof(index_t));
+
+ CloseFile(fd);
+
+ /* Free the memory */
+
+ free(offsets);
+
+ if(paths)
+    free(paths);
+
+ /* Print the final message */
+
+ printf_last("Found Super-Segment Paths: Segments=%"Pindex_t" Super-Segments=%"Pindex_t" Paths=%"Pindex_t,segments->file.number,nsuper,nfound);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Find all routes from a specified super-node to any other super-node that follows a certain
+  type of way (the same as FindRoutesWay() but using the database that has been written).
+
+  Results *FindSuperSegmentPath Returns a set of results.
+
+  Nodes *nodes The set of nodes to use.
+
+  Segments *segments The set of segments to use.
+
+  Ways *ways The set of ways to use.
+
+  index_t start The start node.
+
+  Way *match A template for the type of way that the route must follow.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Results *FindSuperSegmentPath(Nodes *nodes,Segments *segments,Ways *ways,index_t start,Way *match)
+{
+ Results *results;
+ Queue *queue;
+ Result *result1,*result2;
+
+ /* Insert the first node into the queue */
+
+ results=NewResultsList(4);
+
+ queue=NewQueueList();
+
+ result1=InsertResult(results,start,NO_SEGMENT);
+
+ InsertInQueue(queue,result1);
+
+ /* Loop across all nodes in the queue */
+
+ while((result1=PopFromQueue(queue)))
+   {
+    index_t node1;
+    Segment *segment;
+
+    node1=result1->node;
+
+    segment=FirstSegment(segments,LookupNode(nodes,node1,1),2); /* position 1 is already used */
+
+    while(segment)
+      {
+       index_t node2,seg2;
+       distance_t cumulative_distance;
+       Way *way;
+
+       node2=OtherNode(segment,node1);
+
+       /* must be a normal segment */
+       if(!IsNormalSegment(segment))
+          goto endloop;
+
+       /* must not be one-way against the direction of travel */
+       if(IsOnewayTo(segment,node1))
+          goto endloop;
+
+       seg2=IndexSegment(segments,segment);
+
+       /* must not be a u-turn */
+       if(result1->segment==seg2)
+          goto endloop;
+
+       way=LookupWay(ways,segment->way,2); /* position 1 is already used */
+
+       /* must be the right type of way */
+       if(WaysCompare(way,match))
+          goto endloop;
+
+       cumulative_distance=(distance_t)result1->score+DISTANCE(segment->distance);
+
+       result2=FindResult(results,node2,seg2);
+
+       if(!result2)                         /* New end node */
+         {
+          result2=InsertResult(results,node2,seg2);
+          result2->prev=result1;
+          result2->score=cumulative_distance;
+          result2->sortby=cumulative_distance;
+
+          /* don't route beyond a super-node. */
+          if(!IsSuperNode(LookupNode(nodes,node2,2)))
+             InsertInQueue(queue,result2);
+         }
+       else if(cumulative_distance<result2->score)
+         {
+          result2->prev=result1;
+          result2->score=cumulative_distance;
+          result2->sortby=cumulative_distance;
+
+          /* don't route beyond a super-node. */
+          if(!IsSuperNode(LookupNode(nodes,node2,2)))
+             InsertInQueue(queue,result2);
+         }
+
+      endloop:
+
+       segment=NextSegment(segments,segment,node1);
+      }
+   }
+
+ FreeQueueList(queue);
+
+ return(results);
+}
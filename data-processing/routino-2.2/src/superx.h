@@ -23,6 +23,7 @@
 #ifndef SUPERX_H
 #define SUPERX_H    /*+ To stop multiple inclusions. +*/
 
+#include "types.h"
 #include "typesx.h"
 
 
@@ -34,5 +35,7 @@ SegmentsX *CreateSuperSegments(NodesX *nodesx,SegmentsX *segmentsx,WaysX *waysx)
 
 SegmentsX *MergeSuperSegments(SegmentsX *segmentsx,SegmentsX *supersegmentsx);
 
+void SaveSuperSegmentPaths(Nodes *nodes,Segments *segments,Ways *ways,const char *filename);
+
 
 #endif /* SUPERX_H */
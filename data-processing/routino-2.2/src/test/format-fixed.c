@@ -0,0 +1,145 @@
+/***************************************
+ Test program for the fixed point number formatting.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "types.h"
+#include "formatting.h"
+
+
+/* Local variables */
+
+/*+ The number of values that have been compared. +*/
+static long ncompared=0;
+
+/*+ The number of values that were formatted differently. +*/
+static long nfailed=0;
+
+
+/* Local functions */
+
+static void CompareFormats(double value,int decimals);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  The main program for the formatting test (compares FormatFixed() with printf "%.<decimals>f").
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int main(int argc,char** argv)
+{
+ static const double special[]={0.0,-0.0,1.0E-9,-1.0E-9,0.5,-0.5,1.5,2.5,0.05,0.15,0.25,0.35,
+                                0.0000005,-0.0000005,0.0000015,12.3456785,179.9999995,-180.0,
+                                999.9995,99999999.5,999999999.5,1.0E9,1.0E12,-1.0E15,1.0E20};
+ int decimals;
+ long i;
+
+ for(decimals=0;decimals<=6;decimals++)
+   {
+    double scale=pow(10.0,decimals);
+
+    /* Special values */
+
+    for(i=0;i<sizeof(special)/sizeof(special[0]);i++)
+       CompareFormats(special[i],decimals);
+
+    /* Values half-way between two results (and the closest values either side of them) */
+
+    for(i=0;i<200000;i++)
+      {
+       double value=(i+0.5)/scale;
+
+       CompareFormats(value,decimals);
+       CompareFormats(nextafter(value,0),decimals);
+       CompareFormats(nextafter(value,INFINITY),decimals);
+       CompareFormats(-value,decimals);
+      }
+
+    /* Half-way values with large integer parts */
+
+    for(i=0;i<200000;i++)
+      {
+       double value=((i%2)?1.0E14:1.0E8)/scale*(1+i%10)+(i+0.5)/scale;
+
+       CompareFormats(value,decimals);
+       CompareFormats(nextafter(value,0),decimals);
+       CompareFormats(nextafter(value,INFINITY),decimals);
+      }
+   }
+
+ /* The latitudes and longitudes of the database (degrees to 6 decimal places) */
+
+ srand(1);
+
+ for(i=0;i<10000000;i++)
+   {
+    latlong_t latlong=(latlong_t)((rand()-RAND_MAX/2)*2);
+    double degrees=radians_to_degrees(latlong_to_radians(latlong));
+
+    if(degrees>=-180 && degrees<=180)
+       CompareFormats(degrees,6);
+   }
+
+ /* The distances and durations of the text output (with 1, 2 and 3 decimal places) */
+
+ for(i=0;i<1000000;i++)
+   {
+    CompareFormats(distance_to_km(i),3);
+    CompareFormats(distance_to_km(i),2);
+    CompareFormats(duration_to_minutes(i),2);
+    CompareFormats(duration_to_minutes(i),1);
+   }
+
+ printf("Compared %ld values: %ld different\n",ncompared,nfailed);
+
+ return(nfailed>0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Format a value with FormatFixed() and printf and report if they are different.
+
+  double value The value to format.
+
+  int decimals The number of decimal places.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void CompareFormats(double value,int decimals)
+{
+ char string1[64],string2[64];
+ int length1,length2;
+
+ length1=FormatFixed(string1,value,decimals);
+ length2=sprintf(string2,"%.*f",decimals,value);
+
+ ncompared++;
+
+ if(length1!=length2 || strcmp(string1,string2))
+   {
+    if(nfailed<10)
+       printf("FormatFixed(%.17g,%d) = '%s' but printf gives '%s'\n",value,decimals,string1,string2);
+
+    nfailed++;
+   }
+}
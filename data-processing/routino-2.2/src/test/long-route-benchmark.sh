@@ -0,0 +1,89 @@
+#!/bin/sh
+
+# Exit on error
+
+set -e
+
+# Benchmark name
+
+name=`basename $0 .sh`
+
+# The number of nodes along the route (two parallel roads with a link every 10 nodes)
+
+npoints=${NPOINTS:-60000}
+
+# The routers to compare (default is the one in the parent directory)
+
+routers="$*"
+
+[ ! "$routers" = "" ] || routers="../router"
+
+# Create the output directory
+
+dir="benchmark"
+
+[ -d $dir ] || mkdir $dir
+
+# Name related options
+
+osm=$dir/$name.osm
+log=$name.log
+
+option_prefix="--prefix=$name"
+option_dir="--dir=$dir"
+
+# Generic program options
+
+option_planetsplitter="--loggable --tagging=../../xml/routino-tagging.xml --prune-none"
+option_router="--quiet --transport=motorcar --profiles=../../xml/routino-profiles.xml --translations=../../xml/routino-translations.xml --stats"
+
+# Create the network (0.0002 degrees between the nodes of each road)
+
+echo "Creating network : $npoints points"
+
+awk -v n=$npoints \
+    'BEGIN {print "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"; print "<osm version=\"0.6\">";
+            for(road=0;road<2;road++)
+               for(i=0;i<n;i++)
+                  printf "  <node id=\"%d\" lat=\"%.7f\" lon=\"%.7f\" />\n",road*n+i+1,51.0+road*0.0003,-1.0+i*0.0002;
+            way=1;
+            for(road=0;road<2;road++)
+               for(i=0;i<n-1;i+=100)
+                 {
+                  printf "  <way id=\"%d\">\n",way++;
+                  for(j=i;j<=i+100 && j<n;j++)
+                     printf "    <nd ref=\"%d\" />\n",road*n+j+1;
+                  printf "    <tag k=\"highway\" v=\"primary\" />\n    <tag k=\"name\" v=\"Road %d\" />\n  </way>\n",road;
+                 }
+            for(i=9;i<n;i+=10)
+               printf "  <way id=\"%d\">\n    <nd ref=\"%d\" />\n    <nd ref=\"%d\" />\n    <tag k=\"highway\" v=\"residential\" />\n  </way>\n",way++,i+1,n+i+1;
+            print "</osm>"}' > $osm
+
+# Run planetsplitter
+
+echo "Running planetsplitter"
+
+echo ../planetsplitter $option_dir $option_prefix $option_planetsplitter $osm > $log
+../planetsplitter $option_dir $option_prefix $option_planetsplitter $osm >> $log
+
+# Time the output of the route from one end of the network to the other (median of 5 runs)
+
+waypoints="--lat1=51.0 --lon1=-1.0 --lat2=51.0 --lon2=`echo $npoints | awk '{printf "%.4f", -1.0+($1-1)*0.0002}'`"
+
+for router in $routers; do
+
+    echo ""
+    echo "Router : $router"
+
+    for output in default --output-html --output-gpx-track --output-gpx-route --output-text --output-text-all --output-geojson; do
+
+        [ "$output" = "default" ] && option_output="" || option_output=$output
+
+        for run in 1 2 3 4 5; do
+            echo $router $option_dir $option_prefix $option_router --output-dir=$dir $option_output $waypoints >> $log
+            $router $option_dir $option_prefix $option_router --output-dir=$dir $option_output $waypoints 2>&1 | sed -n -e 's%^Stats: PrintRoute=\(.*\)ms%\1%p'
+        done | sort -n | sed -n -e '3s%.*%'"$output"': PrintRoute=&ms%p'
+
+    done
+
+done
@@ -0,0 +1,403 @@
+#!/bin/sh
+
+# Exit on error
+
+set -e
+
+# Test name (the network that is used)
+
+name=$2
+
+# Slim or non-slim
+
+if [ "$1" = "slim" ]; then
+    slim="-slim"
+    dir="slim"
+else
+    slim=""
+    dir="fat"
+fi
+
+# Create the output directory
+
+dir="$dir-many"
+
+[ -d $dir ] || mkdir $dir
+
+# Run the programs under a run-time debugger
+
+debugger=valgrind
+debugger=
+
+# Name related options
+
+osm=$name.osm
+log=many-routes-$name$slim.log
+
+option_prefix="--prefix=$name"
+option_dir="--dir=$dir"
+
+# Generic program options
+
+option_planetsplitter="--loggable --tagging=../../xml/routino-tagging.xml --errorlog --prune-none"
+option_router="--loggable --transport=motorcar --profiles=../../xml/routino-profiles.xml --translations=copyright.xml"
+
+# Points (the first few waypoints of the network)
+
+waypoints=`perl waypoints.pl $osm list | tr ' ' '\n' | sed -e '/^$/d' | head -6`
+
+rm -f $log
+
+[ ! "$waypoints" = "" ] || exit 0
+
+# Run planetsplitter
+
+echo "Running planetsplitter"
+
+echo ../planetsplitter$slim $option_dir $option_prefix $option_planetsplitter $osm > $log
+$debugger ../planetsplitter$slim $option_dir $option_prefix $option_planetsplitter $osm >> $log
+
+# A batch file row for every pair of points (the rows with the same start are together)
+
+for waypoint in $waypoints; do
+    echo $waypoint `perl waypoints.pl $osm $waypoint 1 | sed -e 's%--l[a-z]*[0-9]*=%%g'`
+done > $dir/$name.points
+
+awk 'BEGIN {n=0} {id[n]=$1; lat[n]=$2; lon[n]=$3; n++}
+     END {for(i=0;i<n;i++) for(j=0;j<n;j++) if(i!=j) print id[i] "-" id[j], lat[i], lon[i], lat[j], lon[j]}' $dir/$name.points > $dir/$name.rows
+
+# Run the router for each row on its own
+
+while read route lat1 lon1 lat2 lon2; do
+
+    echo "Running router : $route"
+
+    [ -d $dir/$name-$route ] || mkdir $dir/$name-$route
+
+    echo ../router$slim $option_dir $option_prefix $option_router --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log
+
+    if $debugger ../router$slim $option_dir $option_prefix $option_router --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log 2>&1; then
+
+        mv shortest* $dir/$name-$route
+
+        (echo "Routed OK" ; sed -n -e 's%.*<trkpt lat="\([^"]*\)" lon="\([^"]*\)".*%\1 \2%p' $dir/$name-$route/shortest-track.gpx | uniq) > $dir/$name-$route/points.txt
+
+    else
+
+        rm -f shortest*
+
+        echo "No route" > $dir/$name-$route/points.txt
+
+    fi
+
+done < $dir/$name.rows
+
+# Compare the output of a batch of routes with the routes on their own
+
+compare_batch()
+{
+    awk '{route=$1; $1=""; sub(/^ /,""); print > (dir "/" name "-" route "/" file)}' dir=$dir name=$name file=$2 $1
+
+    for route in `awk '{print $1}' $dir/$name.rows`; do
+
+        echo cmp $dir/$name-$route/$2 $dir/$name-$route/points.txt "(points)" >> $log
+
+        if [ "`cat $dir/$name-$route/points.txt`" = "No route" ]; then
+            ! head -1 $dir/$name-$route/$2 | grep -q "Routed OK"
+        else
+            cmp $dir/$name-$route/$2 $dir/$name-$route/points.txt >> $log
+        fi
+
+    done
+}
+
+# Route the rows in a batch with one thread (the rows with the same start use one search)
+
+echo "Running router : --batch --threads=1"
+
+echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --threads=1 >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --threads=1 > $dir/$name.batch1
+
+compare_batch $dir/$name.batch1 batch1.txt
+
+# Calculate the matrix of distances and durations between the points and compare it with each route
+
+echo "Running router : --matrix"
+
+echo ../router$slim $option_dir $option_prefix $option_router --matrix=$dir/$name.points >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --matrix=$dir/$name.points > $dir/$name.matrix
+
+for route in `awk '{print $1}' $dir/$name.rows`; do
+
+    from=`echo $route | sed -e 's%-.*%%'`
+    to=`echo $route | sed -e 's%.*-%%'`
+
+    # The distance is exact in both but the durations are rounded differently
+
+    if [ -f $dir/$name-$route/shortest-all.txt ]; then
+        awk '/^#/ {next} {distance+=$5; duration=$8} END {printf "%.3f %.1f\n", distance, duration}' $dir/$name-$route/shortest-all.txt > $dir/$name-$route/length.txt
+    else
+        echo "" > $dir/$name-$route/length.txt
+    fi
+
+    echo cmp $dir/$name.matrix $dir/$name-$route/length.txt "($from,$to)" >> $log
+
+    awk -F, -v from=$from -v to=$to -v expected="`cat $dir/$name-$route/length.txt`" \
+        'BEGIN {found=0; split(expected,total," ")}
+         $1==from && $2==to {found=1; if($3!=total[1] || ($4-total[2])>0.0551 || (total[2]-$4)>0.0551) exit 1}
+         END {if(!found) exit 1}' $dir/$name.matrix
+
+done
+
+# Route the rows in a batch and calculate the matrix with several threads (the output must not change)
+
+echo "Running router : --batch --threads=4"
+
+echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --threads=4 >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --threads=4 > $dir/$name.batch4
+
+compare_batch $dir/$name.batch4 batch4.txt
+
+echo cmp $dir/$name.batch4 $dir/$name.batch1 >> $log
+cmp $dir/$name.batch4 $dir/$name.batch1 >> $log
+
+echo "Running router : --matrix --threads=4"
+
+echo ../router$slim $option_dir $option_prefix $option_router --matrix=$dir/$name.points --threads=4 >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --matrix=$dir/$name.points --threads=4 > $dir/$name.matrix4
+
+echo cmp $dir/$name.matrix4 $dir/$name.matrix >> $log
+cmp $dir/$name.matrix4 $dir/$name.matrix >> $log
+
+# Snap the points in advance and use their identifiers in the batch and matrix rows (the output must not change)
+
+echo "Running router : --snap-points"
+
+echo ../router$slim $option_dir $option_prefix $option_router --snap-points=$dir/$name.points >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --snap-points=$dir/$name.points > $dir/$name.snapped
+
+awk '{split($1,id,"-"); print $1, id[1], id[2]}' $dir/$name.rows > $dir/$name.snaprows
+
+awk '{print $1}' $dir/$name.points > $dir/$name.snappoints
+
+echo "Running router : --batch --snapped-points"
+
+echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.snaprows --snapped-points=$dir/$name.snapped >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.snaprows --snapped-points=$dir/$name.snapped > $dir/$name.snapbatch
+
+echo cmp $dir/$name.snapbatch $dir/$name.batch1 >> $log
+cmp $dir/$name.snapbatch $dir/$name.batch1 >> $log
+
+echo "Running router : --matrix --snapped-points"
+
+echo ../router$slim $option_dir $option_prefix $option_router --matrix=$dir/$name.snappoints --snapped-points=$dir/$name.snapped >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --matrix=$dir/$name.snappoints --snapped-points=$dir/$name.snapped > $dir/$name.snapmatrix
+
+echo cmp $dir/$name.snapmatrix $dir/$name.matrix >> $log
+cmp $dir/$name.snapmatrix $dir/$name.matrix >> $log
+
+# Route the rows in a batch for the PostgreSQL COPY command and compare the rows with each route
+
+echo "Running router : --batch --batch-pgcopy"
+
+awk '{split($1,id,"-"); $1=id[1] " " id[2]; print}' $dir/$name.rows > $dir/$name.pgrows
+
+echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.pgrows --batch-pgcopy >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.pgrows --batch-pgcopy > $dir/$name.pgcopy 2>> $log
+
+# The geometry is a hex encoded EWKB linestring of longitude and latitude (in degrees)
+
+prefix=$dir/$name perl -ne 'chomp;
+          ($start,$end,$distance,$duration,$geometry)=split("\t");
+          $route="$start-$end";
+          ($order,$type,$srid,$npoints,@lonlat)=unpack("CVVVd<*",pack("H*",$geometry));
+          open(FILE,">$ENV{prefix}-$route/pgcopy.txt");
+          print FILE "$distance $duration\nRouted OK\n";
+          printf FILE "%.6f %.6f\n",$lonlat[2*$_+1],$lonlat[2*$_] foreach (0..$npoints-1);
+          close(FILE);' $dir/$name.pgcopy
+
+for route in `awk '{print $1}' $dir/$name.rows`; do
+
+    echo cmp $dir/$name-$route/pgcopy.txt $dir/$name-$route/points.txt "(length and points)" >> $log
+
+    if [ "`cat $dir/$name-$route/points.txt`" = "No route" ]; then
+        [ ! -f $dir/$name-$route/pgcopy.txt ]
+    else
+        cat $dir/$name-$route/length.txt $dir/$name-$route/points.txt | cmp $dir/$name-$route/pgcopy.txt - >> $log
+    fi
+
+done
+
+# Route the rows in a batch twice with a route cache (the second time uses the cached routes)
+
+rm -f $dir/$name.cache
+
+echo "Running router : --batch --route-cache"
+
+echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --route-cache=$dir/$name.cache >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --route-cache=$dir/$name.cache > $dir/$name.cache1
+
+echo cmp $dir/$name.cache1 $dir/$name.batch1 >> $log
+cmp $dir/$name.cache1 $dir/$name.batch1 >> $log
+
+echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --route-cache=$dir/$name.cache --threads=4 >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --route-cache=$dir/$name.cache --threads=4 > $dir/$name.cache2
+
+echo cmp $dir/$name.cache2 $dir/$name.batch1 >> $log
+cmp $dir/$name.cache2 $dir/$name.batch1 >> $log
+
+# Route each row on its own using the cached routes (no search is needed)
+
+while read route lat1 lon1 lat2 lon2; do
+
+    [ ! "`cat $dir/$name-$route/points.txt`" = "No route" ] || continue
+
+    echo "Running router : $route (cached)"
+
+    echo ../router$slim $option_dir $option_prefix $option_router --route-cache=$dir/$name.cache --stats --output-gpx-track --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log
+    $debugger ../router$slim $option_dir $option_prefix $option_router --route-cache=$dir/$name.cache --stats --output-gpx-track --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 > $dir/$name-$route/cache-stats.txt 2>&1
+
+    mv shortest-track.gpx $dir/$name-$route/cache-track.gpx
+
+    # Routes between two points on the same segment are not cached
+
+    if [ `sed -n -e 's%^Point [12] is segment \([0-9]*\) .*%\1%p' $dir/$name-$route/cache-stats.txt | uniq -d | wc -l` = 0 ]; then
+        echo grep queue-pushes=0 $dir/$name-$route/cache-stats.txt >> $log
+        grep -q queue-pushes=0 $dir/$name-$route/cache-stats.txt
+    fi
+
+    echo cmp $dir/$name-$route/cache-track.gpx $dir/$name-$route/shortest-track.gpx >> $log
+    cmp $dir/$name-$route/cache-track.gpx $dir/$name-$route/shortest-track.gpx >> $log
+
+done < $dir/$name.rows
+
+# Route each row without the turn restrictions, the routes in the cache must not be used
+
+while read route lat1 lon1 lat2 lon2; do
+
+    [ ! "`cat $dir/$name-$route/points.txt`" = "No route" ] || continue
+
+    echo "Running router : $route (--turns=0)"
+
+    echo ../router$slim $option_dir $option_prefix $option_router --turns=0 --output-gpx-track --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log
+    $debugger ../router$slim $option_dir $option_prefix $option_router --turns=0 --output-gpx-track --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log 2>&1
+
+    mv shortest-track.gpx $dir/$name-$route/turns-track.gpx
+
+    echo ../router$slim $option_dir $option_prefix $option_router --route-cache=$dir/$name.cache --turns=0 --output-gpx-track --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log
+    $debugger ../router$slim $option_dir $option_prefix $option_router --route-cache=$dir/$name.cache --turns=0 --output-gpx-track --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log 2>&1
+
+    mv shortest-track.gpx $dir/$name-$route/turns-cache-track.gpx
+
+    echo cmp $dir/$name-$route/turns-cache-track.gpx $dir/$name-$route/turns-track.gpx >> $log
+    cmp $dir/$name-$route/turns-cache-track.gpx $dir/$name-$route/turns-track.gpx >> $log
+
+done < $dir/$name.rows
+
+# Route the rows in a batch into a route store and compare the stored routes with each route
+
+echo "Running router : --batch --batch-store"
+
+rm -f $dir/$name.store
+
+echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --batch-store=$dir/$name.store >> $log
+$debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.rows --batch-store=$dir/$name.store > $dir/$name.store.log 2>&1
+
+echo "Running routedumper : --list"
+
+echo ../routedumper --store=$dir/$name.store --list >> $log
+$debugger ../routedumper --store=$dir/$name.store --list > $dir/$name.store.list
+
+for route in `awk '{print $1}' $dir/$name.rows`; do
+
+    echo "Running routedumper : --dump --route=$route"
+
+    echo ../routedumper --store=$dir/$name.store --dump --route=$route >> $log
+    $debugger ../routedumper --store=$dir/$name.store --dump --route=$route > $dir/$name-$route/store-dump.txt
+
+    if [ "`cat $dir/$name-$route/points.txt`" = "No route" ]; then
+
+        echo grep "Invalid route" $dir/$name-$route/store-dump.txt >> $log
+        grep -q "Invalid route identifier '$route'" $dir/$name-$route/store-dump.txt
+
+        continue
+
+    fi
+
+    # The number of points and the totals
+
+    echo $route `tail -n +2 $dir/$name-$route/points.txt | wc -l` `cat $dir/$name-$route/length.txt` > $dir/$name-$route/store-list.txt
+
+    echo cmp $dir/$name-$route/store-list.txt $dir/$name.store.list "(totals)" >> $log
+    grep "^$route	" $dir/$name.store.list | tr '\t' ' ' | cmp $dir/$name-$route/store-list.txt - >> $log
+
+    # The points (which are stored with a resolution of 1e-7 degrees)
+
+    sed -n -e 's%.*latitude=\([^ ]*\) longitude=\([^ ]*\).*%\1 \2%p' $dir/$name-$route/store-dump.txt > $dir/$name-$route/store-points.txt
+
+    echo cmp $dir/$name-$route/store-points.txt $dir/$name-$route/points.txt "(points)" >> $log
+    tail -n +2 $dir/$name-$route/points.txt | paste -d ' ' - $dir/$name-$route/store-points.txt | \
+        awk 'function abs(x) {return x<0?-x:x}
+             {if(NF!=4 || abs($1-$3)>0.0000011 || abs($2-$4)>0.0000011) exit 1}' >> $log
+
+done
+
+# All of the routes and no others are in the route store
+
+echo cmp $dir/$name.store.list $dir/$name.rows "(identifiers)" >> $log
+[ `wc -l < $dir/$name.store.list` = `grep -c "Routed OK" $dir/$name.batch1` ]
+
+# Add the weights of the rows in a batch to the segments and compare the volumes with the route store
+
+awk '{print $0, NR}' $dir/$name.rows > $dir/$name.weighted
+
+for threads in 1 4; do
+
+    echo "Running router : --batch --batch-flow --threads=$threads"
+
+    echo ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.weighted --batch-flow=$dir/$name.flow$threads --threads=$threads >> $log
+    $debugger ../router$slim $option_dir $option_prefix $option_router --batch=$dir/$name.weighted --batch-flow=$dir/$name.flow$threads --threads=$threads > $dir/$name.flow.log 2>&1
+
+done
+
+echo cmp $dir/$name.flow4 $dir/$name.flow1 >> $log
+cmp $dir/$name.flow4 $dir/$name.flow1 >> $log
+
+echo ../routedumper --store=$dir/$name.store --dump --route=all >> $log
+$debugger ../routedumper --store=$dir/$name.store --dump --route=all > $dir/$name.store.dump
+
+awk 'BEGIN {n=0}
+     NR==FNR {weight[$1]=$6; next}
+     /^Route / {route=$2; next}
+     /segment=/ {segment=$NF; sub(/segment=/,"",segment); if(!(segment in volume)) segments[n++]=segment; volume[segment]+=weight[route]}
+     END {for(i=0;i<n;i++) print segments[i] "\t" volume[segments[i]]}' $dir/$name.weighted $dir/$name.store.dump | sort -n > $dir/$name.volumes
+
+echo cmp $dir/$name.volumes $dir/$name.flow1 "(volumes)" >> $log
+cut -f 1,6 $dir/$name.flow1 | cmp $dir/$name.volumes - >> $log
+
+# Write the database again with landmarks and contraction hierarchies and then without them (the old ones must not be used)
+
+read route lat1 lon1 lat2 lon2 < $dir/$name.rows
+
+for extras in with without; do
+
+    if [ $extras = with ]; then
+        option_extras="--landmarks=4 --contract=motorcar --profiles=../../xml/routino-profiles.xml"
+    else
+        option_extras=""
+    fi
+
+    echo "Running planetsplitter : $extras landmarks and contraction hierarchies"
+
+    echo ../planetsplitter$slim $option_dir $option_prefix $option_planetsplitter $option_extras $osm >> $log
+    $debugger ../planetsplitter$slim $option_dir $option_prefix $option_planetsplitter $option_extras $osm >> $log
+
+    echo ../router$slim $option_dir $option_prefix $option_router --astar --contraction --output-none --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 >> $log
+    $debugger ../router$slim $option_dir $option_prefix $option_router --astar --contraction --output-none --lat1=$lat1 --lon1=$lon1 --lat2=$lat2 --lon2=$lon2 > $dir/$name.extras-$extras 2>&1 || true
+
+done
+
+echo grep "does not match" $dir/$name.extras-with $dir/$name.extras-without >> $log
+! grep -q "does not match" $dir/$name.extras-with
+grep -q "landmarks file does not match" $dir/$name.extras-without
+grep -q "contraction hierarchy file 'contraction-motorcar-shortest.mem' does not match" $dir/$name.extras-without
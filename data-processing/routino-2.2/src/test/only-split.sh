@@ -28,9 +28,34 @@ else
     pruned=""
 fi
 
+# Routing algorithm variant
+
+case "$3" in
+    bidirectional)
+        variant="-bidirectional"
+        option_variant_planetsplitter=""
+        option_variant_router="--bidirectional"
+        ;;
+    contraction)
+        variant="-contraction"
+        option_variant_planetsplitter="--contract=motorcar --profiles=../../xml/routino-profiles.xml"
+        option_variant_router="--contraction"
+        ;;
+    astar)
+        variant="-astar"
+        option_variant_planetsplitter="--landmarks=4"
+        option_variant_router="--astar"
+        ;;
+    *)
+        variant=""
+        option_variant_planetsplitter=""
+        option_variant_router=""
+        ;;
+esac
+
 # Create the output directory
 
-dir="$dir$pruned"
+dir="$dir$pruned$variant"
 
 [ -d $dir ] || mkdir $dir
 
@@ -42,14 +67,14 @@ debugger=
 # Name related options
 
 osm=$name.osm
-log=$name$slim$pruned.log
+log=$name$slim$pruned$variant.log
 
 option_prefix="--prefix=$name"
 option_dir="--dir=$dir"
 
 # Generic program options
 
-option_planetsplitter="--loggable --tagging=../../xml/routino-tagging.xml --errorlog $prune"
+option_planetsplitter="--loggable --tagging=../../xml/routino-tagging.xml --errorlog $prune $option_variant_planetsplitter"
 option_filedumper="--dump-osm"
 
 # Run planetsplitter
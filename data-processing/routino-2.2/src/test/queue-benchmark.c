@@ -0,0 +1,263 @@
+/***************************************
+ Microbenchmark for the router's priority queue.
+
+ Part of the Routino routing software.
+ ******************/ /******************
+ This file Copyright 2026 MinnPost
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Affero General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Affero General Public License for more details.
+
+ You should have received a copy of the GNU Affero General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ***************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "types.h"
+#include "results.h"
+
+
+/*+ The name of the queue that is measured (the baseline binary heap of pointers to results or the d-ary heap). +*/
+#if defined(QUEUE_BASELINE)
+#define QUEUE_NAME "baseline"
+#else
+#ifndef QUEUE_ARITY
+#define QUEUE_ARITY 4
+#endif
+#define QUEUE_NAME_(arity) #arity "-ary"
+#define QUEUE_NAME_ARITY(arity) QUEUE_NAME_(arity)
+#define QUEUE_NAME QUEUE_NAME_ARITY(QUEUE_ARITY)
+#endif
+
+
+/* Local variables */
+
+/*+ The queue operations recorded during the search (NULL for taking a result from the queue). +*/
+static Result **operations=NULL;
+
+/*+ The sort keys of the results that are put into the queue. +*/
+static score_t *sortbys=NULL;
+
+/*+ The number of recorded queue operations. +*/
+static uint64_t noperations=0;
+
+
+/* Local functions */
+
+static Results *GridSearch(int size,uint64_t *popped);
+static void RecordOperation(Result *result);
+static double ReplayOperations(int nreplays);
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  The main program for the queue benchmark.
+
+  A search like the router's (with the queue sorted by score) is performed on square grids
+  of different sizes so that the number of results taken from the queue covers the range
+  seen with the --stats option of the router.  There is one result for each node so that a
+  node can be reached from several neighbours while it is queued and its score reduced
+  (moving it up the heap like the router does when it finds a better route).  The queue
+  operations of the search are recorded and replayed so that only the time spent in the
+  queue is measured.  The program is compiled with the d-ary heap from queue.c (with
+  QUEUE_ARITY set) or with the baseline binary heap from queue-baseline.c (with
+  QUEUE_BASELINE set).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+int main(int argc,char** argv)
+{
+ int default_sizes[3]={32,100,320};
+ int *sizes=default_sizes,nsizes=3;
+ int i;
+
+ if(argc>1)
+   {
+    sizes=(int*)malloc((argc-1)*sizeof(int));
+    nsizes=argc-1;
+
+    for(i=1;i<argc;i++)
+       if((sizes[i-1]=atoi(argv[i]))<2)
+         {
+          fprintf(stderr,"Usage: queue-benchmark [<grid size> ...]\n");
+          return(1);
+         }
+   }
+
+ for(i=0;i<nsizes;i++)
+   {
+    Results *results;
+    uint64_t popped=0;
+    int nreplays;
+    double elapsed;
+
+    noperations=0;
+
+    results=GridSearch(sizes[i],&popped);
+
+    nreplays=1+20000000/popped;
+
+    elapsed=ReplayOperations(nreplays);
+
+    printf("queue=%s grid=%dx%d queue-pushes=%llu queue-pops=%llu replays=%d time/pop=%.1fns\n",
+           QUEUE_NAME,sizes[i],sizes[i],(unsigned long long)(noperations-popped),(unsigned long long)popped,
+           nreplays,elapsed*1.0E9/(popped*nreplays));
+
+    FreeResultsList(results);
+   }
+
+ return(0);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Perform a search across a grid of nodes with random segment scores and record the queue
+  operations (a result that is already queued is put into the queue again if its score is reduced).
+
+  Results *GridSearch Returns the results of the search (which the recorded operations refer to).
+
+  int size The number of nodes along each side of the grid.
+
+  uint64_t *popped Returns the number of results taken from the queue.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static Results *GridSearch(int size,uint64_t *popped)
+{
+ index_t nnodes=size*size,i;
+ score_t *scores=(score_t*)malloc(4*nnodes*sizeof(score_t));
+ Results *results=NewResultsList(nnodes>65536?65536:256);
+ Queue *queue=NewQueueList();
+ Result *result1;
+
+ /* The same random segment scores are used for each queue */
+
+ srand(1);
+
+ for(i=0;i<4*nnodes;i++)
+    scores[i]=1+rand()%100;
+
+ result1=InsertResult(results,0,NO_SEGMENT);
+ result1->score=0;
+ result1->sortby=0;
+
+ RecordOperation(result1);
+ InsertInQueue(queue,result1);
+
+ while((result1=PopFromQueue(queue)))
+   {
+    int x=result1->node%size,y=result1->node/size,direction;
+
+    RecordOperation(NULL);
+    (*popped)++;
+
+    for(direction=0;direction<4;direction++)
+      {
+       int x2=x+(direction==0)-(direction==1),y2=y+(direction==2)-(direction==3);
+       index_t node2;
+       score_t cumulative_score;
+       Result *result2;
+
+       if(x2<0 || y2<0 || x2>=size || y2>=size)
+          continue;
+
+       node2=y2*size+x2;
+
+       cumulative_score=result1->score+scores[4*result1->node+direction];
+
+       result2=FindResult(results,node2,NO_SEGMENT);
+
+       if(!result2)
+         {
+          result2=InsertResult(results,node2,NO_SEGMENT);
+          result2->score=cumulative_score;
+          result2->sortby=cumulative_score;
+
+          RecordOperation(result2);
+          InsertInQueue(queue,result2);
+         }
+       else if(cumulative_score<result2->score)
+         {
+          result2->score=cumulative_score;
+          result2->sortby=cumulative_score;
+
+          RecordOperation(result2);
+          InsertInQueue(queue,result2);
+         }
+      }
+   }
+
+ FreeQueueList(queue);
+
+ free(scores);
+
+ return(results);
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Record an operation on the queue.
+
+  Result *result The result that is put into the queue (or NULL if one is taken from the queue).
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static void RecordOperation(Result *result)
+{
+ if((noperations%65536)==0)
+   {
+    operations=(Result**)realloc((void*)operations,(noperations+65536)*sizeof(Result*));
+    sortbys=(score_t*)realloc((void*)sortbys,(noperations+65536)*sizeof(score_t));
+   }
+
+ operations[noperations]=result;
+ sortbys[noperations]=result?result->sortby:0;
+
+ noperations++;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++
+  Replay the recorded queue operations (the queue is empty at the end of each replay).
+
+  double ReplayOperations Returns the elapsed time in seconds.
+
+  int nreplays The number of times to replay the operations.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+static double ReplayOperations(int nreplays)
+{
+ struct timespec start,finish;
+ int replay;
+
+ clock_gettime(CLOCK_MONOTONIC,&start);
+
+ for(replay=0;replay<nreplays;replay++)
+   {
+    Queue *queue=NewQueueList();
+    uint64_t i;
+
+    for(i=0;i<noperations;i++)
+       if(operations[i])
+         {
+          operations[i]->sortby=sortbys[i];
+
+          InsertInQueue(queue,operations[i]);
+         }
+       else
+          PopFromQueue(queue);
+
+    FreeQueueList(queue);
+   }
+
+ clock_gettime(CLOCK_MONOTONIC,&finish);
+
+ return((finish.tv_sec-start.tv_sec)+1.0E-9*(finish.tv_nsec-start.tv_nsec));
+}
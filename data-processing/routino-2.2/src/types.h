@@ -39,6 +39,14 @@
 #define NWAYPOINTS 99
 
 
+/*+ The storage class for variables that are private to each thread when routing in parallel. +*/
+#if defined(USE_PTHREADS) && USE_PTHREADS
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
+
 /*+ An undefined node index. +*/
 #define NO_NODE        (~(index_t)0)
 
@@ -403,6 +411,8 @@ typedef struct _TurnRelation TurnRelation;
 
 typedef struct _Relations Relations;
 
+typedef struct _Contraction Contraction;
+
 
 /* Functions in types.c */
 
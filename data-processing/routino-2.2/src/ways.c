@@ -79,6 +79,40 @@ Ways *LoadWayList(const char *filename)
 }
 
 
+/*++++++++++++++++++++++++++++++++++++++
+  Create a copy of a way list that can be used by another thread at the same time
+  (the copy has its own cache in slim mode).
+
+  Ways *CopyWayList Returns the new way list.
+
+  Ways *ways The way list to copy.
+  ++++++++++++++++++++++++++++++++++++++*/
+
+Ways *CopyWayList(Ways *ways)
+{
+ Ways *copy;
+#if SLIM
+ int i;
+#endif
+
+ copy=(Ways*)malloc(sizeof(Ways));
+
+ *copy=*ways;
+
+#if SLIM
+
+ for(i=0;i<sizeof(copy->cached)/sizeof(copy->cached[0]);i++)
+    copy->incache[i]=NO_WAY;
+
+ for(i=0;i<sizeof(copy->cached)/sizeof(copy->cached[0]);i++)
+    copy->ncached[i]=NULL;
+
+#endif
+
+ return(copy);
+}
+
+
 /*++++++++++++++++++++++++++++++++++++++
   Return 0 if the two ways are the same (in respect of their types and limits),
            otherwise return positive or negative to allow sorting.
@@ -97,6 +97,8 @@ struct _Ways
 
 Ways *LoadWayList(const char *filename);
 
+Ways *CopyWayList(Ways *ways);
+
 int WaysCompare(Way *way1,Way *way2);
 
 